@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "async_io.hpp"
+
+namespace
+{
+    /**
+     * Socket pair with a thread discarding everything the writer sends
+     */
+    class drained_pair
+    {
+    public:
+        drained_pair()
+        {
+            ::socketpair(AF_UNIX, SOCK_STREAM, 0, m_fds);
+            m_reader = std::thread([this] {
+                char buf[65536];
+                while (::read(m_fds[1], buf, sizeof(buf)) > 0) { }
+            });
+        }
+        ~drained_pair()
+        {
+            ::shutdown(m_fds[0], SHUT_RDWR);
+            m_reader.join();
+            ::close(m_fds[0]);
+            ::close(m_fds[1]);
+        }
+        int writer() const noexcept
+        {
+            return m_fds[0];
+        }
+
+    private:
+        int m_fds[2]{-1, -1};
+        std::thread m_reader{};
+    };
+
+    void BM_write(benchmark::State& state, VrsTunnel::Ntrip::io_engine engine)
+    {
+        using namespace VrsTunnel::Ntrip;
+        drained_pair pair{};
+        async_io aio{pair.writer(), engine};
+        auto block = std::string(static_cast<std::size_t>(state.range(0)), 'x');
+        auto data = shared_buffer::make(block.data(), block.size());
+        for (auto _ : state) {
+            if (aio.write(data) != io_status::Success) {
+                state.SkipWithError("write failed");
+                break;
+            }
+            while (aio.check() == io_status::InProgress) { }
+            benchmark::DoNotOptimize(aio.end());
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+        state.counters["syscalls/op"] = benchmark::Counter(
+            static_cast<double>(aio.syscalls()), benchmark::Counter::kAvgIterations);
+        if (aio.engine() != engine) {
+            state.SetLabel("fallback to epoll");
+        }
+    }
+
+    /**
+     * One epoch of small RTCM messages queued by reference and flushed together
+     */
+    void BM_epoch(benchmark::State& state, VrsTunnel::Ntrip::io_engine engine)
+    {
+        using namespace VrsTunnel::Ntrip;
+        drained_pair pair{};
+        async_io aio{pair.writer(), engine};
+        auto setup = aio.syscalls();
+        std::string message(60, 'r');
+        auto messages = state.range(0);
+        for (auto _ : state) {
+            for (int64_t i = 0; i < messages; ++i) {
+                aio.enqueue(message.data(), message.size());
+            }
+            if (aio.flush() != io_status::Success) {
+                state.SkipWithError("write failed");
+                break;
+            }
+            while (aio.check() == io_status::InProgress) { }
+            benchmark::DoNotOptimize(aio.end());
+        }
+        state.SetBytesProcessed(state.iterations() * messages * message.size());
+        state.counters["syscalls/op"] = benchmark::Counter(
+            static_cast<double>(aio.syscalls() - setup), benchmark::Counter::kAvgIterations);
+    }
+}
+
+BENCHMARK_CAPTURE(BM_epoch, epoll, VrsTunnel::Ntrip::io_engine::epoll)->Arg(8)->Arg(32);
+BENCHMARK_CAPTURE(BM_epoch, io_uring, VrsTunnel::Ntrip::io_engine::io_uring)->Arg(8)->Arg(32);
+BENCHMARK_CAPTURE(BM_write, posix_aio, VrsTunnel::Ntrip::io_engine::posix_aio)->Range(64, 64 << 10);
+BENCHMARK_CAPTURE(BM_write, epoll, VrsTunnel::Ntrip::io_engine::epoll)->Range(64, 64 << 10);
+BENCHMARK_CAPTURE(BM_write, io_uring, VrsTunnel::Ntrip::io_engine::io_uring)->Range(64, 64 << 10);
@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "epoch_monitor.hpp"
+
+namespace
+{
+    using bytes = std::vector<std::uint8_t>;
+
+    void setbitu(bytes& data, std::size_t pos, unsigned len, std::uint64_t value)
+    {
+        for (unsigned i = 0; i < len; ++i, ++pos) {
+            if ((value >> (len - 1 - i)) & 1) {
+                data[pos >> 3] |= static_cast<std::uint8_t>(0x80 >> (pos & 7));
+            }
+        }
+    }
+
+    /**
+     * MSM7 frame sized as a receiver sends it, about 14 bytes per satellite and 10 per cell
+     */
+    bytes msm_frame(std::uint16_t type, std::uint32_t epoch, bool multiple, unsigned satellites, unsigned signals)
+    {
+        using VrsTunnel::Ntrip::rtcm3_framer;
+        unsigned cells = satellites * signals;
+        std::size_t size = (169 + cells + satellites * 36 + cells * 80) / 8 + 1;
+        bytes f(rtcm3_framer::header_size + size + rtcm3_framer::crc_size, 0);
+        f[0] = rtcm3_framer::preamble;
+        f[1] = static_cast<std::uint8_t>(size >> 8);
+        f[2] = static_cast<std::uint8_t>(size & 0xFF);
+        std::size_t p = rtcm3_framer::header_size * 8;
+        setbitu(f, p, 12, type);
+        setbitu(f, p + 24, 30, epoch);
+        setbitu(f, p + 54, 1, multiple ? 1 : 0);
+        setbitu(f, p + 73, 64, satellites == 64 ? ~0ULL : (1ULL << satellites) - 1);
+        setbitu(f, p + 137, 32, (1U << signals) - 1);
+        setbitu(f, p + 169, cells, cells == 64 ? ~0ULL : (1ULL << cells) - 1);
+        return f;
+    }
+
+    /**
+     * One epoch of a GPS, GLONASS, Galileo and BeiDou station
+     */
+    std::vector<bytes> epoch(std::uint32_t tow)
+    {
+        std::uint32_t glonass = tow + 3 * 3'600'000 - 18'000;  // Moscow time of the first day
+        return {msm_frame(1077, tow, true, 11, 3), msm_frame(1087, glonass, true, 8, 2),
+            msm_frame(1097, tow, true, 9, 3), msm_frame(1127, tow - 14'000, false, 14, 3)};
+    }
+}
+
+/**
+ * MSM header decoding and epoch grouping of many stations fed round robin,
+ * arg is the number of stations. Epochs per second tell how many 1 Hz stations one core follows.
+ */
+static void BM_epoch_monitor(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    std::size_t stations = static_cast<std::size_t>(state.range(0));
+    std::vector<std::vector<bytes>> epochs{};
+    for (std::uint32_t i = 0; i < 16; ++i) {
+        epochs.push_back(epoch(100'000 + i * 1000));
+    }
+    std::vector<std::unique_ptr<epoch_monitor>> monitors{};
+    for (std::size_t i = 0; i < stations; ++i) {
+        monitors.push_back(std::make_unique<epoch_monitor>());
+    }
+    std::size_t processed = 0;
+    std::size_t n = 0;
+    for (auto _ : state) {
+        const auto& messages = epochs[n++ % epochs.size()];
+        auto arrival = epoch_monitor::clock::now();
+        for (auto& monitor : monitors) {
+            for (const auto& m : messages) {
+                msm_header header{};
+                if (rtcm3::decode_msm(rtcm3_frame{m.data(), m.size()}, header)) {
+                    monitor->add(header, arrival);
+                }
+                processed += m.size();
+            }
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(processed));
+    state.counters["epochs"] = benchmark::Counter(static_cast<double>(state.iterations() * stations),
+        benchmark::Counter::kIsRate);
+    if (monitors.front()->metrics().signals != 33 + 16 + 27 + 42) {
+        state.SkipWithError("unexpected signal count");
+    }
+}
+BENCHMARK(BM_epoch_monitor)->Arg(1)->Arg(300)->Arg(3000);
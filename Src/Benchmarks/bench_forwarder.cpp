@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "forwarder.hpp"
+
+/**
+ * Socket to /dev/null, arg 0 is chunk size, arg 1 selects splice
+ */
+static void BM_forward(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        state.SkipWithError("socketpair failed");
+        return;
+    }
+    int sink = ::open("/dev/null", O_WRONLY);
+    std::string chunk(static_cast<std::size_t>(state.range(0)), '\xD3');
+    {
+        forwarder fw{sink, state.range(1) != 0};
+        for (auto _ : state) {
+            if (::write(fds[0], chunk.data(), chunk.size()) != static_cast<ssize_t>(chunk.size())) {
+                state.SkipWithError("write failed");
+                break;
+            }
+            std::size_t moved = 0;
+            if (fw.forward(fds[1], moved) != io_status::Success) {
+                state.SkipWithError("forward failed");
+                break;
+            }
+        }
+        state.counters["spliced"] = fw.spliced() ? 1 : 0;
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    ::close(sink);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+BENCHMARK(BM_forward)->ArgNames({"size", "splice"})
+    ->ArgsProduct({{256, 4096, 32768}, {0, 1}});
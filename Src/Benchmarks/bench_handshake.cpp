@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "accept_listener.hpp"
+#include "ntrip_client.hpp"
+#include "ntrip_server.hpp"
+#include "tcp_server.hpp"
+
+namespace
+{
+    constexpr int caster_port = 18023;
+
+    /**
+     * Caster on loopback with one source, so rovers get "ICY 200 OK"
+     */
+    class loopback_caster
+    {
+    public:
+        loopback_caster()
+        {
+            m_ready = m_server.start(caster_port, m_listener);
+            m_login.address = "127.0.0.1";
+            m_login.port = caster_port;
+            m_login.mountpoint = "BENCH";
+            m_login.username = "bench";
+            m_login.password = "bench";
+            m_ready = m_ready && m_source.connect(m_login) == VrsTunnel::Ntrip::status::ready;
+        }
+        ~loopback_caster()
+        {
+            if (m_ready) {
+                m_source.disconnect();
+            }
+            m_server.stop();
+        }
+
+        bool ready() const noexcept
+        {
+            return m_ready;
+        }
+
+        VrsTunnel::Ntrip::ntrip_login login() const
+        {
+            return m_login;
+        }
+
+    private:
+        VrsTunnel::Ntrip::accept_listener m_listener{};
+        VrsTunnel::Ntrip::tcp_server m_server{};
+        VrsTunnel::Ntrip::ntrip_server m_source{};
+        VrsTunnel::Ntrip::ntrip_login m_login{};
+        bool m_ready{false};
+    };
+
+    loopback_caster& caster()
+    {
+        static loopback_caster instance{};
+        return instance;
+    }
+}
+
+/**
+ * TCP connection alone, the lower bound of the handshake
+ */
+static void BM_tcp_connect(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    if (!caster().ready()) {
+        state.SkipWithError("caster is not available");
+        return;
+    }
+    ntrip_login login = caster().login();
+    for (auto _ : state) {
+        tcp_client tcp{};
+        if (tcp.connect(login.address, login.port, login.timeouts.connect) != io_status::Success) {
+            state.SkipWithError("connect failed");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_tcp_connect)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+/**
+ * Rover connection: TCP connect, GET request and "ICY 200 OK" response
+ */
+static void BM_rover_handshake(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    if (!caster().ready()) {
+        state.SkipWithError("caster is not available");
+        return;
+    }
+    ntrip_login login = caster().login();
+    for (auto _ : state) {
+        ntrip_client rover{};
+        if (rover.connect(login) != status::ready) {
+            state.SkipWithError("handshake failed");
+            break;
+        }
+        rover.disconnect();
+    }
+}
+BENCHMARK(BM_rover_handshake)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,131 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "nmea.hpp"
+#include "nmea_framer.hpp"
+
+namespace
+{
+    /**
+     * GGA sentences of rovers spread around, as a caster receives them
+     */
+    std::vector<std::string> make_sentences()
+    {
+        using namespace VrsTunnel::Ntrip;
+        std::vector<std::string> sentences{};
+        std::chrono::system_clock::time_point time{};
+        for (int i = 0; i < 1024; ++i) {
+            time += std::chrono::milliseconds(1000 + i);
+            location loc{-60.0 + i * 0.117, -170.0 + i * 0.331, 100.0 + i};
+            sentences.push_back(std::get<std::string>(nmea::getGGA(loc, time)));
+        }
+        return sentences;
+    }
+
+    const std::vector<std::string>& sentences()
+    {
+        static const std::vector<std::string> s = make_sentences();
+        return s;
+    }
+}
+
+static void BM_nmea_checksum(benchmark::State& state)
+{
+    using VrsTunnel::Ntrip::nmea;
+    const std::string& s = sentences().front();
+    std::string_view body{s.data() + 1, s.size() - 6};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nmea::checksum(body));
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_nmea_checksum);
+
+static void BM_parseGGA(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    const auto& s = sentences();
+    std::size_t i = 0;
+    gga_fix fix{};
+    for (auto _ : state) {
+        if (!nmea::parseGGA(s[i++ & (s.size() - 1)], fix)) {
+            state.SkipWithError("sentence rejected");
+            break;
+        }
+        benchmark::DoNotOptimize(fix);
+    }
+    state.counters["sentences"] = benchmark::Counter(static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_parseGGA);
+
+/**
+ * Framing and parsing of rover input read in chunks, arg is the chunk size
+ */
+static void BM_nmea_framer(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    std::string stream{};
+    for (const auto& s : sentences()) {
+        stream += s;
+    }
+    std::size_t chunk = static_cast<std::size_t>(state.range(0));
+    nmea_framer framer{};
+    std::size_t parsed = 0;
+    for (auto _ : state) {
+        for (std::size_t pos = 0; pos < stream.size(); pos += chunk) {
+            framer.feed(stream.data() + pos, std::min(chunk, stream.size() - pos));
+            std::string_view sentence{};
+            while (framer.next(sentence) == io_status::Success) {
+                gga_fix fix{};
+                parsed += nmea::parseGGA(sentence, fix) ? 1 : 0;
+            }
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * stream.size());
+    state.counters["sentences"] = benchmark::Counter(static_cast<double>(parsed), benchmark::Counter::kIsRate);
+    if (parsed != state.iterations() * sentences().size()) {
+        state.SkipWithError("sentence lost");
+    }
+}
+BENCHMARK(BM_nmea_framer)->Arg(100)->Arg(4096);
+
+/**
+ * GGA of simulated rovers written into a reused buffer
+ */
+static void BM_formatGGA(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    char buffer[nmea::max_gga];
+    std::chrono::system_clock::time_point time{};
+    std::size_t i = 0;
+    for (auto _ : state) {
+        ++i;
+        location loc{-60.0 + (i & 1023) * 0.117, -170.0 + (i & 1023) * 0.331, 100.0 + (i & 1023)};
+        benchmark::DoNotOptimize(nmea::formatGGA(loc, time + std::chrono::milliseconds(i), buffer, sizeof(buffer)));
+        benchmark::ClobberMemory();
+    }
+    state.counters["sentences"] = benchmark::Counter(static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_formatGGA);
+
+/**
+ * The former snprintf path through std::string, for comparison
+ */
+static void BM_getGGA(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    std::chrono::system_clock::time_point time{};
+    std::size_t i = 0;
+    for (auto _ : state) {
+        ++i;
+        location loc{-60.0 + (i & 1023) * 0.117, -170.0 + (i & 1023) * 0.331, 100.0 + (i & 1023)};
+        benchmark::DoNotOptimize(nmea::getGGA(loc, time + std::chrono::milliseconds(i)));
+    }
+    state.counters["sentences"] = benchmark::Counter(static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_getGGA);
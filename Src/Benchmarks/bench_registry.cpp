@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "registry.hpp.cpp"
+
+namespace VrsTunnel::Ntrip
+{
+    template class registry<std::shared_ptr<int>>;
+}
+
+namespace
+{
+    constexpr int registrations = 100000;   /**< Registrations per iteration shared by all threads */
+    constexpr int snapshot_period = 1000;   /**< Registrations between snapshots of one thread */
+
+    /**
+     * Former accept_listener layout: one map behind one mutex, snapshot copies into a list
+     */
+    class locked_map
+    {
+    public:
+        bool insert(int id, std::shared_ptr<int> value)
+        {
+            std::scoped_lock sl(m_mutex);
+            return m_items.emplace(id, std::move(value)).second;
+        }
+
+        bool erase(int id)
+        {
+            std::scoped_lock sl(m_mutex);
+            return m_items.erase(id) > 0;
+        }
+
+        std::size_t snapshot() const
+        {
+            std::list<std::weak_ptr<int>> list{};
+            std::scoped_lock sl(m_mutex);
+            for (const auto& el : m_items) {
+                list.emplace_back(el.second);
+            }
+            return list.size();
+        }
+
+    private:
+        mutable std::mutex m_mutex{};
+        std::map<int, std::shared_ptr<int>> m_items{};
+    };
+
+    class sharded_registry
+    {
+    public:
+        bool insert(int id, std::shared_ptr<int> value)
+        {
+            return m_items.insert(id, std::move(value));
+        }
+
+        bool erase(int id)
+        {
+            return m_items.erase(id);
+        }
+
+        std::size_t snapshot() const
+        {
+            return m_items.snapshot().size();
+        }
+
+    private:
+        VrsTunnel::Ntrip::registry<std::shared_ptr<int>> m_items{};
+    };
+
+    template<typename registry_type>
+    void BM_register(benchmark::State& state)
+    {
+        static registry_type reg{};
+        int slice = registrations / state.threads();
+        int first = slice * state.thread_index();
+        auto value = std::make_shared<int>(0);
+        for (auto _ : state) {
+            for (int i = first; i < first + slice; ++i) {
+                benchmark::DoNotOptimize(reg.insert(i, value));
+                if ((i - first) % snapshot_period == 0) {
+                    benchmark::DoNotOptimize(reg.snapshot());
+                }
+            }
+            for (int i = first; i < first + slice; ++i) {
+                benchmark::DoNotOptimize(reg.erase(i));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * slice);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_register, locked_map)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_register, sharded_registry)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
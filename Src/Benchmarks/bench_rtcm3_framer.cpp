@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "rtcm3_framer.hpp"
+
+namespace
+{
+    /**
+     * About 1 MiB of MSM sized frames, payloads of 20 to 1023 bytes
+     */
+    std::vector<std::uint8_t> make_stream()
+    {
+        using VrsTunnel::Ntrip::rtcm3_framer;
+        std::vector<std::uint8_t> stream{};
+        std::uint32_t seed = 12345;
+        while (stream.size() < (1U << 20)) {
+            seed = seed * 1103515245U + 12345U;
+            std::size_t size = 20 + (seed >> 8) % 1004;
+            std::size_t start = stream.size();
+            stream.push_back(rtcm3_framer::preamble);
+            stream.push_back(static_cast<std::uint8_t>(size >> 8));
+            stream.push_back(static_cast<std::uint8_t>(size & 0xFF));
+            for (std::size_t i = 0; i < size; ++i) {
+                seed = seed * 1103515245U + 12345U;
+                stream.push_back(static_cast<std::uint8_t>(seed >> 16));
+            }
+            std::uint32_t crc = rtcm3_framer::crc24q(stream.data() + start, stream.size() - start);
+            stream.push_back(static_cast<std::uint8_t>(crc >> 16));
+            stream.push_back(static_cast<std::uint8_t>(crc >> 8));
+            stream.push_back(static_cast<std::uint8_t>(crc));
+        }
+        return stream;
+    }
+
+    const std::vector<std::uint8_t>& stream()
+    {
+        static const std::vector<std::uint8_t> s = make_stream();
+        return s;
+    }
+}
+
+static void BM_crc24q(benchmark::State& state)
+{
+    using VrsTunnel::Ntrip::rtcm3_framer;
+    const auto& s = stream();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rtcm3_framer::crc24q(s.data(), s.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_crc24q);
+
+/**
+ * Framing of the stream fed in chunks, arg is the chunk size (a TCP segment, a socket read)
+ */
+static void BM_rtcm3_framer(benchmark::State& state)
+{
+    using namespace VrsTunnel::Ntrip;
+    const auto& s = stream();
+    std::size_t chunk = static_cast<std::size_t>(state.range(0));
+    rtcm3_framer framer{};
+    for (auto _ : state) {
+        for (std::size_t pos = 0; pos < s.size(); pos += chunk) {
+            framer.feed(s.data() + pos, std::min(chunk, s.size() - pos));
+            rtcm3_frame frame{};
+            while (framer.next(frame) == io_status::Success) {
+                benchmark::DoNotOptimize(frame.data);
+            }
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+    state.counters["frames"] = benchmark::Counter(static_cast<double>(framer.stats().frames),
+        benchmark::Counter::kIsRate);
+    if (framer.stats().crc_errors > 0) {
+        state.SkipWithError("unexpected CRC error");
+    }
+}
+BENCHMARK(BM_rtcm3_framer)->Arg(1460)->Arg(16 * 1024)->Arg(1 << 20);
@@ -1,30 +1,270 @@
 #ifndef VRS_TUNNEL_ACCEPT_LISTENER_
 #define VRS_TUNNEL_ACCEPT_LISTENER_
 
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <map>
-#include <mutex>
 #include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include "tcp_client.hpp"
+#include "connection.hpp"
+#include "epoch_assembler.hpp"
+#include "epoch_monitor.hpp"
+#include "fan_out.hpp"
+#include "message_filter.hpp"
+#include "mount_registry.hpp"
+#include "nmea.hpp"
+#include "nmea_framer.hpp"
+#include "registry.hpp"
+#include "request_parser.hpp"
+#include "spmc_ring.hpp"
 
 namespace VrsTunnel::Ntrip
 {
+    /**
+     * NTRIP Caster logic of one reactor: parses requests, registers
+     * base stations by mount point and forwards their streams to rovers.
+     * Shards of a caster share mount points and sourcetable through a mount registry:
+     * a rover may be accepted by another shard than its base station, which
+     * hands the stream over through the ring of the mount point.
+     * Requests and streams are handled by the reactor thread only, every client
+     * is published to a concurrent registry as an immutable record, replaced
+     * when its role is assigned, so clients can be inspected from any thread.
+     * Base station streams are split into RTCM3 frames and counted per message type,
+     * rovers get whole frames and a buffer which begins an epoch is marked, so the
+     * overflow policy of a slow rover never cuts a frame; a stream without RTCM3
+     * frames is forwarded as received.
+     * the sourcetable position of a mount point follows its 1005/1006 messages,
+     * MSM headers give per-epoch satellite and signal counts of every station.
+     * A rover may ask for some message types only: GET /MOUNT?msg=1005,1074-1077
+     * With epoch bundling enabled, MSM messages of an epoch reach rovers in one write.
+     * GGA sentences of rovers are parsed in place and their last fix is kept.
+     */
     class accept_listener
     {
     public:
-        struct element
+        /**
+         * What the client turned out to be after its request
+         */
+        enum class client_role { pending, rover, source };
+
+        /**
+         * Last fix of a rover, written by the reactor thread and read from any
+         */
+        class rover_fix
+        {
+        public:
+            void set(const gga_fix& fix);
+
+            /**
+             * @return copy of the fix, quality 0 until the first GGA
+             */
+            gga_fix get() const;
+
+        private:
+            mutable std::mutex m_mutex{};
+            gga_fix m_fix{};
+        };
+
+        /**
+         * Published state of a client, never changed after publication
+         */
+        struct client
         {
-            std::shared_ptr<tcp_client> tcp_client{};
-            std::shared_ptr<async_io> asy_io{};
+            std::weak_ptr<connection> conn{};
+            client_role role{client_role::pending};
+            std::string mount{};
+            std::shared_ptr<const message_stats> messages{};    /**< Message counters of a base station, atomic */
+            std::shared_ptr<const rover_fix> position{};        /**< Last fix of a rover */
         };
-        void OnClientConnected(std::unique_ptr<tcp_client> client);
-        std::list<std::weak_ptr<async_io>> get_asyncs() const;
+        accept_listener() = default;
+
+        /**
+         * @param limits output queue bounds of every rover connection
+         */
+        explicit accept_listener(const queue_limits& limits);
+
+        /**
+         * Listener of one shard of a caster
+         * @param mounts mount points shared by the shards
+         * @param shard index of the shard, less than mounts->shards()
+         * @param limits output queue bounds of every rover connection
+         */
+        accept_listener(std::shared_ptr<mount_registry> mounts, std::size_t shard, const queue_limits& limits = {});
+
+        /**
+         * Attaches the reactor of the shard, other shards wake it up when they publish
+         */
+        void OnStart(reactor& loop);
+
+        void OnClientConnected(const std::shared_ptr<connection>& client);
+        void OnDataReceived(connection& client);
+        void OnClientDisconnected(connection& client);
+
+        /**
+         * Forwards the streams other shards have published, sends incomplete epochs
+         * whose deadline has passed, closes rovers stalled for the stall timeout
+         * of the disconnect policy
+         * @return the nearest deadline of the remaining epochs or of the next stall check
+         */
+        std::chrono::steady_clock::time_point OnTimer(std::chrono::steady_clock::time_point now);
+        std::list<std::weak_ptr<connection>> get_connections() const;
+
+        /**
+         * @return lock free snapshot of connected clients, safe from any thread
+         */
+        registry<std::shared_ptr<const client>>::view clients() const;
+
+        /**
+         * Restricts message types sent to every rover of the mount point
+         * @param filter nullptr removes the restriction
+         */
+        void set_filter(const std::string& mount, std::shared_ptr<const message_filter> filter);
+
+        /**
+         * Bundles every epoch of base stations registered later into one write per rover.
+         * Frames are forwarded, bytes of other formats are dropped.
+         * @param wait the longest time an incomplete epoch is held, zero disables bundling
+         */
+        void set_epoch_wait(std::chrono::milliseconds wait) noexcept;
+
+        /**
+         * @return epoch metrics of every base station by mount point, safe from any thread
+         */
+        std::vector<std::pair<std::string, epoch_metrics>> station_metrics() const;
 
     private:
-    mutable std::mutex the_mutex{};
-    std::map<int, element> m_clients{};
+    /**
+     * State of a client owned by the reactor thread
+     */
+    struct session
+    {
+        std::weak_ptr<connection> conn{};
+        request_parser parser{};
+        client_role role{client_role::pending};
+        std::string mount{};
+        std::unique_ptr<rtcm3_framer> framer{};     /**< Frames of a base station stream */
+        std::shared_ptr<mount_registry::feed> feed{};   /**< Stream of a base station for the other shards */
+        std::shared_ptr<message_stats> messages{};  /**< Message counters of a base station, shared with its record */
+        std::shared_ptr<epoch_monitor> epochs{};    /**< Observation epochs of a base station */
+        std::unique_ptr<epoch_assembler> bundle{};  /**< Epoch being collected, if bundling is enabled */
+        std::unique_ptr<nmea_framer> sentences{};   /**< NMEA sentences of a rover */
+        std::shared_ptr<rover_fix> position{};      /**< Last fix of a rover, shared with its record */
+        std::uint32_t epoch_time{std::numeric_limits<std::uint32_t>::max()}; /**< Last MSM epoch of a base station */
+        bool raw{false};                            /**< Base station stream is not RTCM3 */
+    };
+
+    /**
+     * Stream of a mount point of another shard, read for the rovers of this one
+     */
+    struct remote_feed
+    {
+        std::shared_ptr<mount_registry::feed> feed{};   /**< nullptr while there is no base station */
+        spmc_ring::cursor cursor{};
+        bool epochs{false};     /**< Epoch starts are marked in the stream */
+        bool resync{false};     /**< Lapped, chunks are skipped until the next epoch */
+    };
+
+    std::unordered_map<int, session> m_sessions{};  /**< Reactor thread only */
+    registry<std::shared_ptr<const client>> m_clients{};
+    std::shared_ptr<mount_registry> m_mounts{std::make_shared<mount_registry>(1)}; /**< Mount points and sourcetable of all the shards */
+    std::size_t m_shard{0};
+    std::map<std::string, int, std::less<>> m_sources{};    /**< Socket of base station of each mount point of this shard */
+    std::map<std::string, remote_feed, std::less<>> m_remote{}; /**< Mount points of rovers of this shard fed by other shards */
+    fan_out m_fan_out{};    /**< Base station streams to rovers */
+    queue_limits m_limits{};
+    frame_batch m_batch{};  /**< Frames of the chunk being published */
+    std::array<char, spmc_ring::slot_size> m_chunk{};  /**< Chunk read from the ring of another shard */
+    std::chrono::milliseconds m_epoch_wait{0};  /**< Zero if epochs are not bundled */
+    std::chrono::steady_clock::time_point m_next_deadline{std::chrono::steady_clock::time_point::max()};
+    std::chrono::steady_clock::time_point m_next_stall_check{std::chrono::steady_clock::time_point::max()};
+    std::map<std::string, std::weak_ptr<const message_filter>, std::less<>> m_rover_filters{}; /**< Filters shared by rovers with the same request */
+    mutable std::mutex m_epochs_mutex{};
+    std::map<std::string, std::shared_ptr<const epoch_monitor>, std::less<>> m_epochs{}; /**< Read by metrics, changed on base station (dis)connection */
+
+    /**
+     * Counts frames of the base station stream and publishes it to rovers
+     */
+    void on_stream(session& elem, std::string_view data);
+
+    /**
+     * Takes the position of a rover from its GGA sentences
+     */
+    void on_rover(session& elem, std::string_view data);
+
+    /**
+     * Sends collected frames of the base station and starts a new epoch
+     * @param epoch the frames are an observation epoch, not the messages between epochs
+     */
+    void send_epoch(session& elem, bool epoch);
+
+    /**
+     * Sends the frames to rovers of the base station, filtered if any of them asks,
+     * and hands them over to the other shards
+     * @param epoch the frames begin an observation epoch
+     */
+    void publish_frames(session& elem, const frame_batch& frames, bool epoch);
+
+    /**
+     * Publishes the bytes to the ring of the base station if other shards read it,
+     * a chunk of frames is split between slots on frame boundaries
+     * @param tag epoch and raw marks of the bytes
+     */
+    void hand_over(session& elem, std::string_view bytes, std::uint32_t tag);
+
+    /**
+     * Reads the rings of other shards and sends the chunks to rovers of this one
+     */
+    void receive_remote();
+
+    /**
+     * Starts reading the ring of the mount point, if another shard has its base station
+     */
+    void join(const std::string& mount, remote_feed& remote);
+
+    /**
+     * Stops reading the ring
+     */
+    void leave(remote_feed& remote);
+
+    /**
+     * Sends the chunk read into m_chunk to rovers of the mount point
+     */
+    void deliver(const std::string& mount, std::size_t size, std::uint32_t tag);
+
+    /**
+     * Closes rovers whose output queue has been stalled for the stall timeout
+     */
+    void check_stalls(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @param query part of the request target after '?'
+     * @return filter of the msg parameter, shared with rovers which asked the same,
+     * nullptr if there is no msg parameter
+     */
+    std::shared_ptr<const message_filter> rover_filter(std::string_view query, bool& valid);
+
+    /**
+     * Answers complete request and assigns the client role
+     */
+    void on_request(session& elem, connection& client);
+
+    /**
+     * Replaces the registry record of the client with its current role
+     */
+    void publish(int fd, const session& elem);
+
+    /**
+     * Sends the sourcetable response with one vectored write and closes the connection
+     */
+    void send_table(connection& client, bool v2);
     };
 }
 
-#endif /* VRS_TUNNEL_ACCEPT_LISTENER_ */
\ No newline at end of file
+#endif /* VRS_TUNNEL_ACCEPT_LISTENER_ */
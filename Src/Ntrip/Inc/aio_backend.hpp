@@ -0,0 +1,47 @@
+#ifndef VRS_TUNNEL_AIO_BACKEND_
+#define VRS_TUNNEL_AIO_BACKEND_
+
+#include <aio.h>
+#include <array>
+
+#include "io_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * glibc POSIX AIO backend. The library performs the write in a helper
+     * thread, so the socket gains no kernel support for asynchronous I/O.
+     * POSIX AIO has no gather write, buffers are written one after another.
+     */
+    class aio_backend final : public io_backend
+    {
+        struct aiocb m_cb{};    /**< control block of asyncronous operation */
+        bool m_started{false};  /**< Write was requested */
+        bool m_failed{false};   /**< Write failed */
+        std::array<struct iovec, max_iov> m_iov{}; /**< Buffers being transmitted */
+        std::size_t m_count{0}; /**< Number of buffers */
+        std::size_t m_first{0}; /**< Buffer being written */
+        std::size_t m_sent{0};  /**< Bytes already written */
+
+        /**
+         * Requests write of the current buffer
+         */
+        void submit() noexcept;
+
+        /**
+         * Takes the result of completed request, requests the next buffer
+         */
+        void complete() noexcept;
+
+    public:
+        explicit aio_backend(int sockfd) noexcept;
+        ~aio_backend() override;
+
+        [[nodiscard]] io_status write(const struct iovec* iov, std::size_t count) override;
+        [[nodiscard]] io_status check() noexcept override;
+        [[nodiscard]] ssize_t end() noexcept override;
+        io_engine engine() const noexcept override;
+    };
+}
+
+#endif /* VRS_TUNNEL_AIO_BACKEND_ */
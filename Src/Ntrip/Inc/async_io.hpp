@@ -1,22 +1,23 @@
 #ifndef ASYNCHRONOUS_INPUT_OUTPUT_
 #define ASYNCHRONOUS_INPUT_OUTPUT_
 
-#include <aio.h>
+#include <deque>
 #include <memory>
 #include <cstring>
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#include "io_backend.hpp"
+#include "shared_buffer.hpp"
+
 
 namespace VrsTunnel::Ntrip
 {
     /**
-     * Input/output operation status
-     */
-    enum class io_status { InProgress, Error, Success };
-
-    /**
-     *  Asyncronous input/output operations based on file descriptor. Copy and move operations are disabled.
+     *  Asyncronous input/output operations based on file descriptor.
+     *  Writes are performed by io_backend selected at runtime. Written
+     *  buffers are queued, up to io_backend::max_iov of them are handed
+     *  to the kernel as one gather write. Copy and move operations are disabled.
      */
     class async_io
     {
@@ -25,14 +26,51 @@ namespace VrsTunnel::Ntrip
         async_io(async_io&&)                    = delete;
         async_io& operator=(async_io&&)         = delete;
 
-        struct aiocb m_read_cb; /**< control block of asyncronous operation */
-        std::unique_ptr<char[]> m_data; /**< Buffer for transmission */
+        /**
+         * Queued buffer, owner is empty for borrowed buffers
+         */
+        struct chunk
+        {
+            const char* data;
+            std::size_t size;
+            std::shared_ptr<const shared_buffer> owner;
+        };
+
+        int m_sockfd; /**< File descriptor */
+        std::unique_ptr<io_backend> m_backend; /**< Kernel interface of write operations */
+        std::deque<chunk> m_queue{}; /**< Buffers for transmission, the first m_batch ones are in flight */
+        std::size_t m_batch{0}; /**< Number of buffers handed to the backend */
+        std::size_t m_pending{0}; /**< Queued bytes */
+        ssize_t m_written{0}; /**< Bytes written since the last end() */
+        bool m_failed{false}; /**< Write error occurred */
+        bool m_eof{false}; /**< Peer closed the connection */
+
+        /**
+         * Hands the next batch of queued buffers to the backend
+         */
+        void submit() noexcept;
 
         public:
+        /**
+         * Init asyncronous operation fields with default io_backend engine
+         */
+        async_io(int sockfd);
+
         /**
          * Init asyncronous operation fields
+         * @param engine kernel interface used for writing
+         */
+        async_io(int sockfd, io_engine engine);
+
+        /**
+         * @return kernel interface actually used, io_uring may fall back to epoll
          */
-        async_io(int sockfd) noexcept;
+        io_engine engine() const noexcept;
+
+        /**
+         * @return number of system calls made by write operations
+         */
+        std::uint64_t syscalls() const noexcept;
 
         /**
          * @return current status of the transmission
@@ -40,7 +78,7 @@ namespace VrsTunnel::Ntrip
         [[nodiscard]] io_status check() noexcept;
 
         /**
-         * Assyncronous write operation
+         * Assyncronous write operation, the data is copied and queued
          * @param data buffer to be transmitted
          * @param size buffer size
          * @return status of async request
@@ -48,22 +86,71 @@ namespace VrsTunnel::Ntrip
         [[nodiscard]] io_status write(const char* data, int size);
 
         /**
-         * @return amount of received bytes
+         * Assyncronous write operation without copying,
+         * the buffer is referenced until it is written
+         * @param data shared buffer to be transmitted
+         * @return status of async request
+         */
+        [[nodiscard]] io_status write(std::shared_ptr<const shared_buffer> data);
+
+        /**
+         * Queues borrowed buffer without starting transmission
+         * @param data buffer which must stay valid until it is written or end() is called
+         * @param size buffer size
+         */
+        void enqueue(const char* data, std::size_t size);
+
+        /**
+         * Queues shared buffer without starting transmission
+         */
+        void enqueue(std::shared_ptr<const shared_buffer> data);
+
+        /**
+         * Starts transmission of queued buffers unless a write is in flight
+         * @return Error if the connection is broken
+         */
+        [[nodiscard]] io_status flush() noexcept;
+
+        /**
+         * @return amount of queued bytes which are not written yet
+         */
+        std::size_t pending() const noexcept;
+
+        /**
+         * Single non-blocking read into the caller buffer
+         * @param buffer destination, can be reused between calls
+         * @param capacity size of the buffer
+         * @param received number of bytes stored into the buffer
+         * @return Success if bytes arrived, InProgress if nothing is available,
+         * Error on end of stream (eof() is true) or socket error
+         */
+        [[nodiscard]] io_status receive(char* buffer, std::size_t capacity, std::size_t& received) noexcept;
+
+        /**
+         * @return true if the peer closed the connection
+         */
+        bool eof() const noexcept;
+
+        /**
+         * @return amount of received bytes.
+         * It costs one more system call than receive().
          */
         int available() noexcept;
 
         /**
-         * Method to read available bytes
+         * Method to read available bytes, throws std::runtime_error
+         * if less bytes arrived. receive() does not allocate nor throw.
          * @param size number of bytes to read
          * @return buffer of received bytes
          */
         std::unique_ptr<char[]> read(int size);
 
         /**
-         * Completes asyncronous operation
-         * @return status associated with AIOCBP.
-         * It should be called after status is not
-         * 'InProgress' any more.
+         * Completes asyncronous operation, buffers which
+         * are not handed to the kernel yet are discarded
+         * @return number of bytes written since the previous
+         * call, -1 on error. It should be called after status
+         * is not 'InProgress' any more.
          */
         [[nodiscard]] ssize_t end() noexcept;
     };
@@ -0,0 +1,240 @@
+#ifndef VRS_TUNNEL_CONNECTION_
+#define VRS_TUNNEL_CONNECTION_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string_view>
+
+#include "tcp_client.hpp"
+#include "shared_buffer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * What to do with a slow consumer when its output queue is over the high watermark
+     */
+    enum class overflow_policy
+    {
+        drop_oldest,    /**< Queued chunks are dropped, oldest first, until the new one fits */
+        skip_epoch,     /**< All queued chunks are dropped, delivery resumes with the next epoch */
+        disconnect      /**< New chunks are dropped, connection is closed after stall timeout */
+    };
+
+    /**
+     * Output queue watermarks. Queue is stalled from the moment it goes over
+     * any of high watermarks until it drains below both low watermarks.
+     */
+    struct queue_limits
+    {
+        std::size_t high_bytes{64 * 1024};
+        std::size_t high_frames{256};
+        std::size_t low_bytes{16 * 1024};
+        std::size_t low_frames{64};
+        overflow_policy policy{overflow_policy::drop_oldest};
+        std::chrono::milliseconds stall_timeout{std::chrono::seconds(30)}; /**< Used by disconnect policy, see connection::disconnect_stalled */
+    };
+
+    /**
+     * Slow consumer counters of one connection
+     */
+    struct queue_stats
+    {
+        std::uint64_t dropped_frames{0};    /**< Chunks discarded by overflow policy */
+        std::uint64_t dropped_bytes{0};     /**< Bytes discarded by overflow policy */
+        std::uint64_t stalls{0};            /**< Times the queue went over high watermark */
+    };
+
+    /**
+     * Non-blocking TCP connection owned by the reactor.
+     * Incoming bytes are collected in a fixed buffer, outgoing
+     * bytes which could not be written at once are queued until
+     * the socket becomes writable. The queue is bounded by queue_limits.
+     * Overflow policies drop whole queued buffers, only the first one may be
+     * partially sent, so the sender decides the boundaries: the caster queues
+     * whole RTCM3 frames and marks the buffers which begin an observation epoch.
+     * Copy and move operations are disabled.
+     */
+    class connection
+    {
+    public:
+        static constexpr std::size_t input_capacity = 4096; /**< Size of the fixed input buffer */
+        static constexpr std::size_t max_vector = 16;       /**< Buffers written by one vectored write */
+
+        /**
+         * Takes ownership of non-blocking TCP socket
+         */
+        explicit connection(std::unique_ptr<tcp_client> client) noexcept;
+        ~connection() = default;
+        connection(const connection&)               = delete;
+        connection& operator=(const connection&)    = delete;
+        connection(connection&&)                    = delete;
+        connection& operator=(connection&&)         = delete;
+
+        /**
+         * @return file descriptor of TCP connection
+         */
+        int get_sockfd() noexcept;
+
+        /**
+         * @return received bytes which are not consumed yet
+         */
+        std::string_view input() const noexcept;
+
+        /**
+         * Removes bytes from the beginning of input buffer
+         * @param size number of bytes processed by the caller
+         */
+        void consume(std::size_t size) noexcept;
+
+        /**
+         * Single non-blocking read into free space of input buffer
+         * @return Success if bytes arrived, InProgress if the socket
+         * would block, Error on end of stream, socket error or full buffer
+         */
+        [[nodiscard]] io_status receive() noexcept;
+
+        /**
+         * Writes as much as possible immediately, the rest is copied to the queue
+         * @param data buffer to be transmitted
+         * @param size buffer size
+         * @return Success if everything is written, InProgress if
+         * data is queued, Error if the connection is broken
+         */
+        [[nodiscard]] io_status send(const char* data, std::size_t size);
+
+        /**
+         * Writes as much as possible immediately, the queue keeps
+         * a reference to the buffer instead of a copy
+         * @param data shared buffer to be transmitted
+         * @param epoch the buffer begins an observation epoch, skip_epoch policy resumes there
+         * @return Success if everything is written, InProgress if
+         * data is queued or skipped, Error if the connection is broken
+         */
+        [[nodiscard]] io_status send(std::shared_ptr<const shared_buffer> data, bool epoch = false);
+
+        /**
+         * Writes the buffers with one vectored write, the unsent
+         * part is queued by reference like a single shared buffer
+         * @param chunks shared buffers to be transmitted in order
+         * @param count number of buffers
+         * @return Success if everything is written, InProgress if
+         * data is queued, Error if the connection is broken
+         */
+        [[nodiscard]] io_status send(const std::shared_ptr<const shared_buffer>* chunks, std::size_t count);
+
+        /**
+         * Writes queued output until the socket would block
+         * @return Success if the queue is empty, InProgress if data
+         * is still pending, Error if the connection is broken
+         */
+        [[nodiscard]] io_status flush() noexcept;
+
+        /**
+         * @return amount of queued output bytes
+         */
+        std::size_t pending() const noexcept;
+
+        /**
+         * Sets output queue watermarks and overflow policy
+         */
+        void set_limits(const queue_limits& limits) noexcept;
+
+        /**
+         * @return slow consumer counters
+         */
+        queue_stats stats() const noexcept;
+
+        /**
+         * @return true if output queue is over the high watermark
+         */
+        bool is_stalled() const noexcept;
+
+        /**
+         * Applies the disconnect policy: the queue stalled for stall_timeout
+         * is discarded and the connection is closed. Called from the reactor
+         * timer, so a rover is dropped even if its base station goes silent.
+         * @return true if the connection has been closed
+         */
+        bool disconnect_stalled(std::chrono::steady_clock::time_point now) noexcept;
+
+        /**
+         * Requests the connection to be closed once pending output is flushed.
+         * Receiving is shut down, so the reactor is notified about the request.
+         */
+        void close() noexcept;
+
+        /**
+         * @return true if close was requested or the connection is broken
+         */
+        bool is_closing() const noexcept;
+
+        /**
+         * @return time of the last successful read or write
+         */
+        std::chrono::steady_clock::time_point last_activity() const noexcept;
+
+    private:
+        /**
+         * Queued output buffer
+         */
+        struct chunk
+        {
+            std::shared_ptr<const shared_buffer> data{};
+            bool epoch{false};  /**< Begins an observation epoch */
+        };
+
+        std::unique_ptr<tcp_client> m_tcp;                  /**< Socket owner */
+        std::array<char, input_capacity> m_input{};         /**< Received bytes */
+        std::size_t m_input_size{0};                        /**< Amount of received bytes */
+        std::deque<chunk> m_output{};                       /**< Queued output chunks */
+        std::size_t m_output_offset{0};                     /**< Bytes of the first chunk already sent */
+        std::size_t m_output_size{0};                       /**< Total amount of queued bytes */
+        bool m_closing{false};                              /**< Close requested */
+        std::chrono::steady_clock::time_point m_activity;   /**< Last successful read or write */
+        queue_limits m_limits{};                            /**< Output queue bounds */
+        queue_stats m_stats{};                              /**< Slow consumer counters */
+        std::chrono::steady_clock::time_point m_stall_since{}; /**< Epoch zero if not stalled */
+        bool m_epochs{false};                               /**< Epoch starts are marked in the output */
+        bool m_skipping{false};                             /**< Buffers are dropped until the next epoch */
+
+        /**
+         * Queues the unsent part of the buffer applying overflow policy
+         * @param data buffer to be queued
+         * @param offset bytes of the buffer already sent
+         * @param epoch the buffer begins an observation epoch
+         */
+        [[nodiscard]] io_status enqueue(std::shared_ptr<const shared_buffer> data, std::size_t offset, bool epoch);
+
+        /**
+         * @return true if adding the amount of bytes as one more chunk exceeds high watermark
+         */
+        bool over_limits(std::size_t size) const noexcept;
+
+        /**
+         * Discards queued chunk, the first one is never dropped as it may be partially sent
+         */
+        void drop(std::deque<chunk>::iterator queued) noexcept;
+
+        /**
+         * Counts the buffer discarded before it was queued
+         */
+        void discard(std::size_t size) noexcept;
+
+        /**
+         * Writes until the socket would block
+         * @return number of bytes written, negative if the connection is broken
+         */
+        ssize_t write_some(const char* data, std::size_t size) noexcept;
+
+        /**
+         * Writes up to max_vector buffers with sendmsg until the socket would block
+         * @return number of bytes written, negative if the connection is broken
+         */
+        ssize_t write_some(const std::shared_ptr<const shared_buffer>* chunks, std::size_t count) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_CONNECTION_ */
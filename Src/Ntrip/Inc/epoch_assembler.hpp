@@ -0,0 +1,79 @@
+#ifndef VRS_TUNNEL_EPOCH_ASSEMBLER_
+#define VRS_TUNNEL_EPOCH_ASSEMBLER_
+
+#include <chrono>
+
+#include "io_backend.hpp"
+#include "message_filter.hpp"
+#include "rtcm3.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Collects RTCM3 frames of one observation epoch, so the epoch leaves
+     * with a single write instead of following the read chunks.
+     * The epoch starts with its first MSM and is complete with the MSM
+     * which has the multiple message bit cleared. If that message is lost,
+     * the epoch is sent at its deadline or when the next epoch begins.
+     * Frames between epochs (station, ephemeris) are sent with the read chunk.
+     * Copy and move operations are disabled.
+     */
+    class epoch_assembler
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /**
+         * @param wait the longest time an incomplete epoch is held
+         */
+        explicit epoch_assembler(std::chrono::milliseconds wait) noexcept;
+        epoch_assembler(const epoch_assembler&)             = delete;
+        epoch_assembler& operator=(const epoch_assembler&)  = delete;
+        epoch_assembler(epoch_assembler&&)                  = delete;
+        epoch_assembler& operator=(epoch_assembler&&)       = delete;
+
+        /**
+         * @return true if the MSM belongs to another epoch than the collected one,
+         * the collected frames are to be sent before it is added
+         */
+        bool other_epoch(const msm_header& msm) const noexcept;
+
+        /**
+         * Appends the frame to the batch
+         * @param msm decoded header of MSM frame, nullptr for other messages
+         * @param now arrival time, starts the deadline of a new epoch
+         * @return Success if the epoch is complete and the batch is to be sent,
+         * InProgress otherwise
+         */
+        [[nodiscard]] io_status add(const rtcm3_frame& frame, const msm_header* msm, clock::time_point now);
+
+        /**
+         * @return true while the epoch waits for its last message
+         */
+        bool is_open() const noexcept;
+
+        /**
+         * @return when the open epoch has to be sent, time_point::max() if none is open
+         */
+        clock::time_point deadline() const noexcept;
+
+        /**
+         * @return frames collected since the last clear()
+         */
+        const frame_batch& batch() const noexcept;
+
+        /**
+         * Forgets the sent frames and closes the epoch
+         */
+        void clear() noexcept;
+
+    private:
+        std::chrono::milliseconds m_wait;
+        frame_batch m_batch{};
+        bool m_open{false};
+        std::uint32_t m_time{0};            /**< Epoch time, ms of the GPS day */
+        clock::time_point m_deadline{clock::time_point::max()};
+    };
+}
+
+#endif /* VRS_TUNNEL_EPOCH_ASSEMBLER_ */
@@ -0,0 +1,80 @@
+#ifndef VRS_TUNNEL_EPOCH_MONITOR_
+#define VRS_TUNNEL_EPOCH_MONITOR_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rtcm3.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Observation quality of a base station, the last complete epoch
+     */
+    struct epoch_metrics
+    {
+        std::uint64_t epochs{0};        /**< Complete epochs seen */
+        std::uint32_t satellites{0};    /**< Satellites of all GNSS */
+        std::uint32_t signals{0};       /**< Observed satellite/signal pairs */
+        std::uint32_t interval_ms{0};   /**< Epoch time since the previous epoch */
+        std::uint32_t jitter_us{0};     /**< Smoothed deviation of the arrival interval from the epoch interval */
+        std::uint64_t gaps{0};          /**< Epochs which came after a missed one */
+    };
+
+    /**
+     * Groups MSM headers of a base station stream into epochs.
+     * An epoch ends with the message which has the multiple message bit cleared,
+     * or when a message of another epoch time arrives.
+     * One reactor thread adds messages, metrics may be read from any thread.
+     */
+    class epoch_monitor
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /**
+         * @param header decoded MSM header
+         * @param arrival when the chunk holding the message was read
+         */
+        void add(const msm_header& header, clock::time_point arrival) noexcept;
+
+        /**
+         * @return metrics of the last complete epoch, fields are read one by one
+         * and may belong to adjacent epochs
+         */
+        epoch_metrics metrics() const noexcept;
+
+        /**
+         * Epoch time as milliseconds of the GPS day, leap seconds of 2017 for GLONASS
+         */
+        static std::uint32_t day_time(const msm_header& header) noexcept;
+
+    private:
+        /** Epoch being assembled */
+        bool m_open{false};
+        bool m_reopened{false};     /**< Continues the epoch closed before */
+        std::uint32_t m_time{0};
+        clock::time_point m_arrival{};
+        std::uint32_t m_satellites{0};
+        std::uint32_t m_signals{0};
+
+        /** Previous complete epoch */
+        bool m_has_previous{false};
+        std::uint32_t m_previous_time{0};
+        clock::time_point m_previous_arrival{};
+        std::uint32_t m_nominal_ms{0};      /**< Shortest interval seen */
+        std::int64_t m_jitter_us{0};        /**< RFC 3550 estimator scaled by 16 */
+
+        std::atomic<std::uint64_t> m_epochs{0};
+        std::atomic<std::uint32_t> m_last_satellites{0};
+        std::atomic<std::uint32_t> m_last_signals{0};
+        std::atomic<std::uint32_t> m_interval_ms{0};
+        std::atomic<std::uint32_t> m_last_jitter_us{0};
+        std::atomic<std::uint64_t> m_gaps{0};
+
+        void close() noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_EPOCH_MONITOR_ */
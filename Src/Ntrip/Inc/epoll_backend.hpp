@@ -0,0 +1,42 @@
+#ifndef VRS_TUNNEL_EPOLL_BACKEND_
+#define VRS_TUNNEL_EPOLL_BACKEND_
+
+#include <array>
+
+#include "io_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Non-blocking backend: buffers are sent at once with one sendmsg call,
+     * the rest is sent when epoll reports the socket writable. The epoll instance is created
+     * on the first would-block, so short writes cost one system call.
+     */
+    class epoll_backend final : public io_backend
+    {
+        int m_sockfd;                   /**< Socket to write to */
+        int m_epollfd{-1};              /**< Writability of the socket */
+        std::array<struct iovec, max_iov> m_iov{}; /**< Buffers being transmitted */
+        std::size_t m_count{0};         /**< Number of buffers */
+        std::size_t m_first{0};         /**< First buffer not written completely */
+        std::size_t m_sent{0};          /**< Bytes already written */
+        bool m_waiting{false};          /**< Socket would block */
+        bool m_failed{false};           /**< Socket error */
+
+        /**
+         * Sends until the socket would block
+         */
+        void send_some() noexcept;
+
+    public:
+        explicit epoll_backend(int sockfd) noexcept;
+        ~epoll_backend() override;
+
+        [[nodiscard]] io_status write(const struct iovec* iov, std::size_t count) override;
+        [[nodiscard]] io_status check() noexcept override;
+        [[nodiscard]] ssize_t end() noexcept override;
+        io_engine engine() const noexcept override;
+    };
+}
+
+#endif /* VRS_TUNNEL_EPOLL_BACKEND_ */
@@ -0,0 +1,103 @@
+#ifndef VRS_TUNNEL_FAN_OUT_
+#define VRS_TUNNEL_FAN_OUT_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "connection.hpp"
+#include "message_filter.hpp"
+#include "shared_buffer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Broadcasts base station stream to rovers subscribed to its mount point.
+     * Each chunk is stored once in a shared buffer and every rover send queue
+     * holds a reference to it. A mount point or a rover may restrict the
+     * message types; filtered output is built once per distinct filter.
+     * Not thread safe, it belongs to one reactor.
+     */
+    class fan_out
+    {
+    public:
+        /**
+         * Adds rover to the mount point subscribers
+         * @param filter message types the rover wants, nullptr for all
+         */
+        void subscribe(const std::string& mount, const std::shared_ptr<connection>& rover,
+            std::shared_ptr<const message_filter> filter = nullptr);
+
+        /**
+         * Restricts message types forwarded from the mount point to every rover
+         * @param filter nullptr removes the restriction
+         */
+        void set_filter(const std::string& mount, std::shared_ptr<const message_filter> filter);
+
+        /**
+         * @return true if the mount point or any of its rovers filters messages,
+         * then the stream has to be published by frames
+         */
+        bool filtered(const std::string& mount) const;
+
+        /**
+         * Removes rover from its mount point
+         */
+        void unsubscribe(connection& rover);
+
+        /**
+         * Copies the data once and sends it to every subscriber
+         * @param epoch the data begins an observation epoch
+         * @return number of rovers the data was delivered or queued to
+         */
+        std::size_t publish(const std::string& mount, const char* data, std::size_t size, bool epoch = false);
+
+        /**
+         * Sends the shared buffer to every subscriber
+         * @param epoch the data begins an observation epoch
+         * @return number of rovers the data was delivered or queued to
+         */
+        std::size_t publish(const std::string& mount, const std::shared_ptr<const shared_buffer>& data,
+            bool epoch = false);
+
+        /**
+         * Sends the data to rovers without filter and the frames
+         * accepted by its filters to the others
+         * @param data RTCM3 frames in a row
+         * @param frames the same frames one by one
+         * @param epoch the frames begin an observation epoch
+         * @return number of rovers the data was delivered or queued to
+         */
+        std::size_t publish(const std::string& mount, const char* data, std::size_t size,
+            const frame_batch& frames, bool epoch = false);
+
+        /**
+         * @return number of rovers subscribed to the mount point
+         */
+        std::size_t subscribers(const std::string& mount) const;
+
+    private:
+        struct subscriber
+        {
+            std::weak_ptr<connection> conn;
+            std::shared_ptr<const message_filter> filter;
+        };
+        struct mount_subscribers
+        {
+            std::vector<subscriber> list{};
+            std::size_t filtered{0};    /**< Subscribers with a filter */
+        };
+        std::unordered_map<std::string, mount_subscribers> m_mounts{};   /**< Subscribers of each mount point */
+        std::unordered_map<int, std::string> m_rovers{};   /**< Mount point of each rover socket */
+        std::unordered_map<std::string, std::shared_ptr<const message_filter>> m_filters{}; /**< Filter of each mount point */
+        std::vector<std::pair<const message_filter*, std::shared_ptr<const shared_buffer>>> m_selected{}; /**< Output of each filter during publish */
+
+        /**
+         * Removes subscriber at the index by swapping with the last one
+         */
+        static void remove(mount_subscribers& subs, std::size_t index);
+    };
+}
+
+#endif /* VRS_TUNNEL_FAN_OUT_ */
@@ -0,0 +1,107 @@
+#ifndef VRS_TUNNEL_FORWARDER_
+#define VRS_TUNNEL_FORWARDER_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "io_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Moves received bytes from a socket to an output descriptor.
+     * Bytes are spliced through an intermediate pipe and never copied
+     * to user space. If the output does not support splice (a file in
+     * append mode, a tty of an old kernel) the forwarder falls back to
+     * one reusable buffer.
+     * The forwarder never waits for a non-blocking output: bytes it does
+     * not take stay in the pipe or are queued, the socket is not read
+     * until flush() hands them over once the output is writable.
+     * The socket is switched to non-blocking mode, as splice() honours
+     * SPLICE_F_NONBLOCK on the pipe side only and would wait on a TCP socket.
+     * Copy and move operations are disabled.
+     */
+    class forwarder
+    {
+    public:
+        static constexpr std::size_t pipe_capacity = 64 * 1024;    /**< Bytes moved by one splice */
+        static constexpr std::size_t buffer_capacity = 16 * 1024;  /**< Fallback buffer size */
+
+        /**
+         * @param outfd output descriptor, it is not closed
+         * @param use_splice false forces the buffer mode
+         */
+        explicit forwarder(int outfd, bool use_splice = true) noexcept;
+        ~forwarder();
+        forwarder(const forwarder&)             = delete;
+        forwarder& operator=(const forwarder&)  = delete;
+        forwarder(forwarder&&)                  = delete;
+        forwarder& operator=(forwarder&&)       = delete;
+
+        /**
+         * Moves everything the socket has received until it or the output would block
+         * @param sockfd socket to read from, made non-blocking if it is not
+         * @param moved number of bytes taken from the socket
+         * @return Success if bytes were moved, InProgress if nothing is
+         * available or the output is blocked, Error on end of stream, socket or output error
+         */
+        [[nodiscard]] io_status forward(int sockfd, std::size_t& moved) noexcept;
+
+        /**
+         * Writes bytes which were already read by the caller,
+         * the part the output does not take is queued
+         * @return Success if the bytes are written or queued, Error
+         */
+        [[nodiscard]] io_status write(const char* data, std::size_t size) noexcept;
+
+        /**
+         * Writes bytes left by the blocked output, called when it becomes writable
+         * @return Success if nothing is left, InProgress if the output would still block, Error
+         */
+        [[nodiscard]] io_status flush() noexcept;
+
+        /**
+         * @return true while bytes wait for the output to become writable
+         */
+        bool blocked() const noexcept;
+
+        /**
+         * @return true while bytes bypass user space
+         */
+        bool spliced() const noexcept;
+
+    private:
+        int m_outfd;
+        int m_pipe[2]{-1, -1};                          /**< Kernel buffer between socket and output */
+        bool m_splice{false};
+        std::size_t m_piped{0};                         /**< Bytes in the pipe not taken by the output yet */
+        std::array<char, buffer_capacity> m_buffer{};   /**< Used without splice */
+        std::vector<char> m_pending{};                  /**< Bytes the blocked output did not take */
+
+        [[nodiscard]] io_status forward_spliced(int sockfd, std::size_t& moved) noexcept;
+        [[nodiscard]] io_status forward_buffered(int sockfd, std::size_t& moved) noexcept;
+
+        /**
+         * Moves pipe content to the output, falls back to the buffer if the output refuses splice
+         * @return Success if the pipe is empty, InProgress if the output would block, Error
+         */
+        [[nodiscard]] io_status drain_pipe() noexcept;
+
+        /**
+         * Writes the queued bytes
+         * @return Success if the queue is empty, InProgress if the output would block, Error
+         */
+        [[nodiscard]] io_status drain_pending() noexcept;
+
+        /**
+         * Writes until the output would block, data and size are advanced past the written bytes
+         * @return Success if everything is written, InProgress if the output would block, Error
+         */
+        [[nodiscard]] io_status write_some(const char*& data, std::size_t& size) noexcept;
+
+        void close_pipe() noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_FORWARDER_ */
@@ -0,0 +1,69 @@
+#ifndef VRS_TUNNEL_HANDSHAKE_
+#define VRS_TUNNEL_HANDSHAKE_
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "async_io.hpp"
+#include "ntrip_login.hpp"
+#include "response_parser.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Request/response exchange with NTRIP Caster on a connected socket.
+     * The thread sleeps in ppoll until the socket is readable or a deadline
+     * expires, every arrived chunk is fed to response_parser at once.
+     * Copy and move operations are disabled.
+     */
+    class handshake
+    {
+    public:
+        /**
+         * @param timeouts send and response deadlines, connect one is not used here
+         */
+        explicit handshake(const handshake_timeouts& timeouts) noexcept;
+        ~handshake() = default;
+        handshake(const handshake&)             = delete;
+        handshake& operator=(const handshake&)  = delete;
+        handshake(handshake&&)                  = delete;
+        handshake& operator=(handshake&&)       = delete;
+
+        /**
+         * Sends the request and waits for the response header
+         * @param aio operations on the connected socket
+         * @param sockfd the socket to wait on
+         * @param request request buffer, it is copied
+         * @param size request size
+         * @return Success when the response is classified, Error if the
+         * connection is broken, the response is malformed or a deadline expired
+         */
+        [[nodiscard]] io_status run(async_io& aio, int sockfd, const char* request, std::size_t size);
+
+        /**
+         * @return parser of the response, it holds the status code
+         */
+        const response_parser& response() const noexcept;
+
+        /**
+         * @return body bytes received together with the response header
+         */
+        std::string_view body() const noexcept;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        handshake_timeouts m_timeouts;
+        response_parser m_parser{};
+        std::string m_response{};   /**< Bytes received so far */
+
+        /**
+         * Sleeps until the socket is readable or the deadline expires
+         * @return false on poll error
+         */
+        static bool wait(int sockfd, clock::time_point deadline) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_HANDSHAKE_ */
@@ -0,0 +1,110 @@
+#ifndef VRS_TUNNEL_IO_BACKEND_
+#define VRS_TUNNEL_IO_BACKEND_
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Input/output operation status
+     */
+    enum class io_status { InProgress, Error, Success };
+
+    /**
+     * Kernel interface used to transmit data
+     */
+    enum class io_engine
+    {
+        posix_aio,  /**< glibc POSIX AIO, emulated with helper threads */
+        epoll,      /**< Non-blocking send, readiness is polled with epoll */
+        io_uring    /**< Send is queued to io_uring, completion is read from shared memory */
+    };
+
+    /**
+     * Abstract asynchronous gather write to a socket, partial writes are
+     * continued by the backend until all the buffers are transmitted.
+     * Copy and move operations are disabled.
+     */
+    class io_backend
+    {
+    public:
+        static constexpr std::size_t max_iov = 64; /**< Buffers written by one request */
+
+        io_backend() = default;
+        virtual ~io_backend() = default;
+        io_backend(const io_backend&)               = delete;
+        io_backend& operator=(const io_backend&)    = delete;
+        io_backend(io_backend&&)                    = delete;
+        io_backend& operator=(io_backend&&)         = delete;
+
+        /**
+         * Starts transmission. The buffers must stay valid until end() is called,
+         * the vector itself is copied.
+         * @param iov buffers to be written in order
+         * @param count number of buffers, at most max_iov
+         * @return Success if the transmission is started
+         */
+        [[nodiscard]] virtual io_status write(const struct iovec* iov, std::size_t count) = 0;
+
+        /**
+         * @return current status of the transmission
+         */
+        [[nodiscard]] virtual io_status check() noexcept = 0;
+
+        /**
+         * Completes the transmission, waits for the kernel to release the buffer if necessary
+         * @return number of bytes written, -1 on error
+         */
+        [[nodiscard]] virtual ssize_t end() noexcept = 0;
+
+        /**
+         * @return kernel interface of the backend
+         */
+        virtual io_engine engine() const noexcept = 0;
+
+        /**
+         * @return number of system calls made by the backend
+         */
+        std::uint64_t syscalls() const noexcept;
+
+        /**
+         * Factory method to obtain the backend, io_uring falls back
+         * to epoll if the kernel does not provide it
+         * @param engine kernel interface
+         * @param sockfd socket to write to
+         */
+        static std::unique_ptr<io_backend> make_instance(io_engine engine, int sockfd);
+
+        /**
+         * Engine used by async_io when it is not given explicitly, epoll by default
+         */
+        static void set_default(io_engine engine) noexcept;
+        static io_engine get_default() noexcept;
+
+        /**
+         * Parses engine name: "aio", "epoll" or "uring"
+         * @return false if the name is unknown
+         */
+        static bool parse(std::string_view name, io_engine& engine) noexcept;
+
+    protected:
+        std::uint64_t m_syscalls{0};    /**< System calls made so far */
+
+        /**
+         * Skips written bytes of the vector, the first partially written buffer is adjusted
+         * @param iov buffers being written
+         * @param first index of the first buffer not written completely
+         * @param count number of buffers
+         * @param written bytes written from the first buffer on
+         * @return index of the first buffer which is not written completely
+         */
+        static std::size_t advance(struct iovec* iov, std::size_t first, std::size_t count,
+            std::size_t written) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_IO_BACKEND_ */
@@ -0,0 +1,115 @@
+#ifndef VRS_TUNNEL_MESSAGE_FILTER_
+#define VRS_TUNNEL_MESSAGE_FILTER_
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "rtcm3_framer.hpp"
+#include "shared_buffer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Set of RTCM3 message numbers which are let through.
+     * The decision is one bit test on the 12 bit message number.
+     */
+    class message_filter
+    {
+    public:
+        static constexpr std::size_t message_types = 4096;
+
+        /**
+         * Creates filter which accepts every message
+         */
+        message_filter() noexcept;
+
+        /**
+         * Parses comma separated message numbers and ranges.
+         * "1005,1033,1074-1077" accepts the listed messages only,
+         * "!1019,1020" accepts everything except the listed ones.
+         * @return false if the specification is malformed
+         */
+        [[nodiscard]] static bool parse(std::string_view spec, message_filter& filter) noexcept;
+
+        void allow(std::uint16_t first, std::uint16_t last) noexcept;
+        void deny(std::uint16_t first, std::uint16_t last) noexcept;
+
+        /**
+         * @return true if the message passes the filter
+         */
+        bool accepts(std::uint16_t type) const noexcept;
+
+        /**
+         * @return true if no message is filtered out
+         */
+        bool accepts_all() const noexcept;
+
+    private:
+        std::bitset<message_types> m_allowed{};
+    };
+
+    /**
+     * Frame and byte counters of every message number.
+     * Written by one thread, may be read from any thread.
+     */
+    class message_stats
+    {
+    public:
+        void count(std::uint16_t type, std::size_t size) noexcept;
+        std::uint64_t frames(std::uint16_t type) const noexcept;
+        std::uint64_t bytes(std::uint16_t type) const noexcept;
+
+    private:
+        struct counter
+        {
+            std::atomic<std::uint64_t> frames{0};
+            std::atomic<std::uint64_t> bytes{0};
+        };
+        std::array<counter, message_filter::message_types> m_counters{};
+    };
+
+    /**
+     * Frames of one received chunk copied back to back, so that
+     * the part accepted by a filter can be selected after the framer
+     * has moved on. Buffers are reused, clear() keeps the capacity.
+     */
+    class frame_batch
+    {
+    public:
+        void clear() noexcept;
+        void add(const rtcm3_frame& frame);
+        bool empty() const noexcept;
+
+        /**
+         * @return all the frames back to back
+         */
+        std::string_view bytes() const noexcept;
+
+        /**
+         * Copies frames which pass both filters into a shared buffer
+         * @param first filter, nullptr accepts everything
+         * @param second filter, nullptr accepts everything
+         * @return selected frames, nullptr if no frame passed
+         */
+        std::shared_ptr<const shared_buffer> select(const message_filter* first,
+            const message_filter* second) const;
+
+    private:
+        struct entry
+        {
+            std::uint32_t offset;
+            std::uint16_t size;
+            std::uint16_t type;
+        };
+        std::vector<char> m_bytes{};
+        std::vector<entry> m_entries{};
+        mutable std::vector<char> m_selected{};  /**< Scratch of select */
+    };
+}
+
+#endif /* VRS_TUNNEL_MESSAGE_FILTER_ */
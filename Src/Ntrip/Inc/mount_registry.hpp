@@ -0,0 +1,123 @@
+#ifndef VRS_TUNNEL_MOUNT_REGISTRY_
+#define VRS_TUNNEL_MOUNT_REGISTRY_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "sourcetable.hpp"
+#include "spmc_ring.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    class reactor;
+
+    /**
+     * Mount points of all the shards of a caster. A base station is registered
+     * by the shard which accepted it, rovers of every shard find it here and
+     * the sourcetable lists the mount points of all the shards.
+     * The stream of a mount point reaches the other shards through its ring:
+     * the base station shard publishes, each shard with rovers of the mount point
+     * reads with its own cursor and is woken up through its reactor.
+     * Registration takes a mutex, the stream handoff is lock free.
+     * Thread safe. Copy and move operations are disabled.
+     */
+    class mount_registry
+    {
+    public:
+        static constexpr std::size_t max_shards = 64;       /**< Readers of a feed are one bit per shard */
+        static constexpr std::size_t ring_capacity = 128;   /**< Slots of the ring of a mount point */
+
+        /**
+         * Stream of one mount point for the shards without its base station
+         */
+        struct feed
+        {
+            feed(std::size_t owner, bool shared);
+
+            const std::size_t shard;                /**< Shard of the base station */
+            const std::unique_ptr<spmc_ring> ring;  /**< Published by the base station shard, nullptr with one shard */
+            std::atomic<std::uint64_t> readers{0};  /**< Bit of every shard reading the ring */
+            std::atomic<bool> closed{false};        /**< Base station is gone, nothing is published any more */
+        };
+
+        /**
+         * @param shards number of reactors sharing the mount points, 1 to max_shards,
+         * throws std::runtime_error otherwise
+         */
+        explicit mount_registry(std::size_t shards);
+        ~mount_registry() = default;
+        mount_registry(const mount_registry&)               = delete;
+        mount_registry& operator=(const mount_registry&)    = delete;
+        mount_registry(mount_registry&&)                    = delete;
+        mount_registry& operator=(mount_registry&&)         = delete;
+
+        std::size_t shards() const noexcept;
+
+        /**
+         * Registers the base station of the mount point and its sourcetable entry,
+         * every shard is woken up, its rovers may wait for the mount point
+         * @param shard shard which accepted the base station
+         * @param str STR line of the base station, see sourcetable::add
+         * @return feed of the stream, nullptr if the mount point is taken
+         */
+        std::shared_ptr<feed> add(std::string_view mount, std::size_t shard, std::string_view str);
+
+        /**
+         * Closes the feed of the mount point and removes its sourcetable entry
+         */
+        void remove(std::string_view mount);
+
+        /**
+         * @return feed of the mount point, nullptr if there is no base station
+         */
+        std::shared_ptr<feed> find(std::string_view mount) const;
+
+        /**
+         * @return sourcetable of the mount points of all the shards
+         */
+        sourcetable& table() noexcept;
+
+        /**
+         * Sets the reactor woken up by notifications of the shard,
+         * the reactor must outlive the threads of the other shards
+         */
+        void attach(std::size_t shard, reactor& loop) noexcept;
+
+        /**
+         * Wakes up every shard reading the feed, a shard is woken up
+         * once until it takes the notification
+         */
+        void notify(const feed& stream) noexcept;
+
+        /**
+         * Takes the notification of the shard, called by the shard before reading its feeds
+         * @return true if the shard has been notified since the last call
+         */
+        bool notified(std::size_t shard) noexcept;
+
+    private:
+        struct alignas(64) shard_state
+        {
+            std::atomic<reactor*> loop{nullptr};
+            std::atomic<bool> pending{false};   /**< Notified and not woken up again until taken */
+        };
+
+        const std::size_t m_shards;
+        std::unique_ptr<shard_state[]> m_state;
+        mutable std::mutex m_mutex{};
+        std::map<std::string, std::shared_ptr<feed>, std::less<>> m_mounts{};   /**< Feed of each mount point */
+        sourcetable m_table{};
+
+        /**
+         * Wakes up the shard unless it has a notification to take already
+         */
+        void wake(std::size_t shard) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_MOUNT_REGISTRY_ */
@@ -4,12 +4,26 @@
 #include <string>
 #include <charconv>
 #include <chrono>
+#include <cstdint>
+#include <string_view>
 #include <variant>
 
 #include "location.hpp"
 
 namespace VrsTunnel::Ntrip
 {
+    /**
+     * Position fix of NMEA GGA sentence
+     */
+    struct gga_fix
+    {
+        location position{};                /**< Elevation is the altitude above mean sea level */
+        std::uint8_t quality{0};            /**< 1 GPS, 2 DGPS, 4 RTK fixed, 5 RTK float... 0 no fix */
+        std::uint8_t satellites{0};
+        double hdop{0};
+        std::chrono::milliseconds time{0};  /**< UTC time of day */
+    };
+
     /**
      * NMEA helper class with static methods
      */
@@ -40,6 +54,22 @@ namespace VrsTunnel::Ntrip
     [[nodiscard]] static std::variant<std::string, ErrorCode>
     getGGA(location location, std::chrono::system_clock::time_point time);
 
+    /**
+     * Largest sentence formatGGA writes
+     */
+    static constexpr std::size_t max_gga = 128;
+
+    /**
+     * Writes the GGA sentence of getGGA into the caller's buffer, nothing is allocated.
+     * Numbers are written with to_chars and fixed-point arithmetic,
+     * the checksum is computed while the sentence is written.
+     * @param buffer output, not null terminated
+     * @param size buffer size, max_gga is always enough
+     * @return length of the sentence, 0 if the buffer is too small or the elevation is out of range
+     */
+    [[nodiscard]] static std::size_t formatGGA(location location, std::chrono::system_clock::time_point time,
+        char* buffer, std::size_t size) noexcept;
+
     /**
      * Compute checksum of NMEA sentence
      * @param data byte stream
@@ -47,6 +77,16 @@ namespace VrsTunnel::Ntrip
      */
     static uint8_t checksum(std::string_view data);
 
+    /**
+     * Parses and validates NMEA GGA sentence of any talker ($GPGGA, $GNGGA...),
+     * the talker is two upper case letters.
+     * Fields are read in place, nothing is allocated.
+     * @param sentence from '$' to the checksum, line end is optional
+     * @param fix position, quality and time of the sentence
+     * @return false if the sentence is malformed, its checksum is wrong or it has no fix
+     */
+    [[nodiscard]] static bool parseGGA(std::string_view sentence, gga_fix& fix) noexcept;
+
     };    
 }
 #endif
\ No newline at end of file
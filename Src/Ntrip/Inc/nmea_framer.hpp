@@ -0,0 +1,74 @@
+#ifndef VRS_TUNNEL_NMEA_FRAMER_
+#define VRS_TUNNEL_NMEA_FRAMER_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "io_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * NMEA framer counters
+     */
+    struct nmea_stats
+    {
+        std::uint64_t sentences{0};         /**< Sentences returned */
+        std::uint64_t discarded_bytes{0};   /**< Bytes outside sentences and overlong lines */
+    };
+
+    /**
+     * Incremental NMEA 0183 framer: a sentence runs from '$' to the line end.
+     * Sentences which lie entirely in the fed buffer are returned in place;
+     * only a sentence split between two buffers is assembled in the framer's
+     * own fixed storage. Nothing is allocated.
+     * Copy and move operations are disabled.
+     */
+    class nmea_framer
+    {
+    public:
+        static constexpr std::size_t max_sentence = 256;   /**< Longer lines are dropped, the standard allows 82 */
+
+        nmea_framer() = default;
+        nmea_framer(const nmea_framer&)             = delete;
+        nmea_framer& operator=(const nmea_framer&)  = delete;
+        nmea_framer(nmea_framer&&)                  = delete;
+        nmea_framer& operator=(nmea_framer&&)       = delete;
+
+        /**
+         * Hands received bytes to the framer, the buffer must stay
+         * unchanged until next() returns InProgress
+         */
+        void feed(const char* data, std::size_t size) noexcept;
+
+        /**
+         * Finds the next sentence
+         * @param sentence from '$' to the checksum without the line end, valid until the next call
+         * @return Success or InProgress when the fed bytes are used up,
+         * an incomplete sentence is kept for the next feed
+         */
+        [[nodiscard]] io_status next(std::string_view& sentence) noexcept;
+
+        /**
+         * Drops the incomplete sentence and the rest of the fed buffer
+         */
+        void reset() noexcept;
+
+        /**
+         * @return framer counters
+         */
+        nmea_stats stats() const noexcept;
+
+    private:
+        const char* m_input{nullptr};               /**< Unprocessed part of the fed buffer */
+        std::size_t m_input_size{0};
+        std::array<char, max_sentence> m_partial{}; /**< Sentence split between buffers */
+        std::size_t m_partial_size{0};
+        bool m_overlong{false};                     /**< Skipping the rest of a too long line */
+        nmea_stats m_stats{};
+    };
+}
+
+#endif /* VRS_TUNNEL_NMEA_FRAMER_ */
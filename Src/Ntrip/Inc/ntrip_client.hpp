@@ -31,6 +31,7 @@ namespace VrsTunnel::Ntrip
         std::unique_ptr<async_io> m_aio {nullptr};      /**< Asyncronous operations */
         std::unique_ptr<tcp_client> m_tcp {nullptr};    /**< TCP connection */
         status m_status {status::uninitialized};        /**< Current status of the client */
+        std::string m_body{};                           /**< Correction received together with the response header */
 
         /**
          * Build HTTP GET request
@@ -48,6 +49,8 @@ namespace VrsTunnel::Ntrip
         ntrip_client& operator=(ntrip_client&&) = delete;         /**< No move operator */
 
     public:
+        static constexpr std::size_t receive_chunk = 4096; /**< Size of reusable receive buffers */
+
         ntrip_client() = default;
         ~ntrip_client() = default;
 
@@ -64,7 +67,8 @@ namespace VrsTunnel::Ntrip
         bool hasTableEnding(std::string_view data);
 
         /**
-         * Create connection with NTRIP Caster
+         * Create connection with NTRIP Caster. The response is parsed
+         * as soon as it arrives, nlogin.timeouts limit every step.
          * @param nlogin login information
          * @return result of the connection
          */
@@ -75,6 +79,11 @@ namespace VrsTunnel::Ntrip
          */
         void disconnect();
 
+        /**
+         * @return socket of the connection to wait for correction on, -1 if not connected
+         */
+        int get_sockfd() const noexcept;
+
         /**
          * @return amount of available RTK correction
          */
@@ -87,6 +96,18 @@ namespace VrsTunnel::Ntrip
          */
         std::unique_ptr<char[]> receive(int size);
 
+        /**
+         * Get available RTK correction with one non-blocking read, without allocation.
+         * Correction which came with the response header is returned first,
+         * so it should be called once after connect before waiting on the socket.
+         * @param buffer destination provided by the caller
+         * @param capacity size of the buffer
+         * @param received number of bytes stored into the buffer
+         * @return Success if correction arrived, InProgress if nothing
+         * is available, Error if the connection is closed or broken
+         */
+        [[nodiscard]] io_status receive(char* buffer, std::size_t capacity, std::size_t& received) noexcept;
+
         /**
          * Provides NMEA GGA message to NTRIP Caster.
          * @param location coordinates of NTRIP Client position
@@ -1,12 +1,24 @@
 #ifndef VRSTUNNEL_NTRIP_NTRIP_LOGIN_
 #define VRSTUNNEL_NTRIP_NTRIP_LOGIN_
 
+#include <chrono>
 #include <string>
 
 #include "location.hpp"
 
 namespace VrsTunnel::Ntrip
 {
+    /**
+     * Deadlines of the connection handshake with NTRIP Caster
+     */
+    struct handshake_timeouts
+    {
+        std::chrono::milliseconds connect{std::chrono::seconds(5)};    /**< TCP connection establishment */
+        std::chrono::milliseconds attempt_delay{250};                   /**< Stagger of parallel attempts to server addresses */
+        std::chrono::milliseconds send{std::chrono::seconds(5)};       /**< Transmission of the request */
+        std::chrono::milliseconds response{std::chrono::seconds(5)};   /**< Response header after the request is sent */
+    };
+
     /**
      * Here we can have NTRIP login information
      */
@@ -18,6 +30,8 @@ namespace VrsTunnel::Ntrip
         std::string password;
         std::string mountpoint;
         location position;      /**< Coordinates to be sent to NTRIP Caster */
+        std::string str{};      /**< NTRIP-STR line of a server, built from mount point and position if empty */
+        handshake_timeouts timeouts{};
     };
     
 }
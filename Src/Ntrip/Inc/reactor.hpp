@@ -0,0 +1,159 @@
+#ifndef VRS_TUNNEL_REACTOR_
+#define VRS_TUNNEL_REACTOR_
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
+#include "connection.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Edge-triggered epoll event loop. It owns the listening socket
+     * and every accepted connection, so one thread serves all the clients.
+     * Events are delivered to connect_listen type which provides
+     * OnClientConnected(const std::shared_ptr<connection>&),
+     * OnDataReceived(connection&) and OnClientDisconnected(connection&).
+     * A listener with deadlines also provides
+     * steady_clock::time_point OnTimer(steady_clock::time_point now),
+     * which is called after every wake up and returns when it is due next.
+     * A listener woken up by other threads also provides OnStart(reactor&),
+     * which is called by the loop thread before the first event.
+     * Copy and move operations are disabled.
+     */
+    class reactor
+    {
+    public:
+        /**
+         * Creates epoll instance, throws std::runtime_error on failure
+         */
+        reactor();
+        ~reactor();
+        reactor(const reactor&)               = delete;
+        reactor& operator=(const reactor&)    = delete;
+        reactor(reactor&&)                    = delete;
+        reactor& operator=(reactor&&)         = delete;
+
+        /**
+         * Opens non-blocking IPv4 listening socket
+         * @param port TCP port to accept connections on
+         * @param reuse_port SO_REUSEPORT lets several reactors listen on the same port,
+         * the kernel balances incoming connections between them
+         * @return true if the socket is listening
+         */
+        [[nodiscard]] bool listen(int port, bool reuse_port = false);
+
+        /**
+         * Dispatches socket events until stop() is called.
+         * Every connection is closed when the loop returns.
+         * @param listener receiver of connection events
+         */
+        template<typename connect_listen>
+        void run(connect_listen& listener);
+
+        /**
+         * Wakes up the loop and makes run() return, can be called from any thread
+         */
+        void stop() noexcept;
+
+        /**
+         * Wakes up the loop, so OnTimer of the listener runs, can be called from any thread
+         */
+        void wake() noexcept;
+
+        /**
+         * Connections without successful read or write for this period are closed.
+         * Activity is checked lazily, so an idle connection lives up to twice the timeout.
+         * Zero disables the timeout.
+         */
+        void set_timeout(std::chrono::milliseconds timeout) noexcept;
+
+        /**
+         * @return number of open connections
+         */
+        std::size_t size() const noexcept;
+
+    private:
+        struct entry
+        {
+            std::shared_ptr<connection> conn{};     /**< Connection owned by the loop */
+            std::list<int>::iterator idle_pos{};    /**< Position in the idle list */
+            std::chrono::steady_clock::time_point checked{}; /**< Last time the activity was checked */
+        };
+
+        static constexpr int max_events = 256;  /**< Events handled per epoll_wait call */
+        static constexpr std::chrono::milliseconds accept_retry{100}; /**< Backlog poll period while out of descriptors */
+
+        int m_epollfd{-1};                          /**< epoll instance */
+        int m_wakefd{-1};                           /**< eventfd to interrupt epoll_wait */
+        int m_listenfd{-1};                         /**< Listening socket */
+        int m_sparefd{-1};                          /**< Reserved descriptor to reject connections when out of them */
+        std::chrono::steady_clock::time_point m_accept_retry{std::chrono::steady_clock::time_point::max()};
+        std::atomic<bool> m_stop_required{false};
+        std::chrono::milliseconds m_timeout{std::chrono::seconds(60)};
+        std::unordered_map<int, entry> m_connections{};
+        std::list<int> m_idle{};                    /**< Sockets ordered by the time they were checked for activity */
+
+        /**
+         * Accepts one pending connection
+         * @return nullptr if there is nothing to accept
+         */
+        std::shared_ptr<connection> accept_one();
+
+        /**
+         * Frees the spare descriptor to accept and close the pending
+         * connections when the process is out of descriptors, otherwise
+         * the edge-triggered listening socket keeps them in the backlog
+         * @return false if there is no spare descriptor or accept still fails
+         */
+        bool reject_pending();
+
+        /**
+         * Forgets the connection, socket is closed when the last reference is released
+         */
+        std::shared_ptr<connection> remove(int fd);
+
+        /**
+         * Finds the next connection which has been idle longer than the timeout.
+         * Active connections met on the way are moved to the end of the idle list,
+         * so each connection is checked at most once per timeout period.
+         * @return nullptr if no connection expired
+         */
+        std::shared_ptr<connection> expired(std::chrono::steady_clock::time_point now);
+
+        /**
+         * @param deadline next listener timer, time_point::max() if none
+         * @return epoll_wait timeout in milliseconds
+         */
+        int wait_time(std::chrono::steady_clock::time_point now,
+            std::chrono::steady_clock::time_point deadline) const;
+
+        void close(int& fd);
+    };
+
+    /**
+     * Detects OnTimer of the listener
+     */
+    template<typename connect_listen, typename = void>
+    struct has_timer : std::false_type { };
+
+    template<typename connect_listen>
+    struct has_timer<connect_listen, std::void_t<decltype(std::declval<connect_listen&>()
+        .OnTimer(std::chrono::steady_clock::time_point{}))>> : std::true_type { };
+
+    /**
+     * Detects OnStart of the listener
+     */
+    template<typename connect_listen, typename = void>
+    struct has_start : std::false_type { };
+
+    template<typename connect_listen>
+    struct has_start<connect_listen, std::void_t<decltype(std::declval<connect_listen&>()
+        .OnStart(std::declval<reactor&>()))>> : std::true_type { };
+}
+
+#endif /* VRS_TUNNEL_REACTOR_ */
@@ -0,0 +1,88 @@
+#include <array>
+#include <cerrno>
+#include <sys/epoll.h>
+
+#include "reactor.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    template<typename connect_listen>
+    void reactor::run(connect_listen& listener)
+    {
+        auto drop = [this, &listener](int fd) {
+            std::shared_ptr<connection> conn = remove(fd);
+            if (conn) {
+                listener.OnClientDisconnected(*conn);
+            }
+        };
+
+        auto accept_all = [this, &listener]() {
+            m_accept_retry = std::chrono::steady_clock::time_point::max();
+            while (std::shared_ptr<connection> conn = accept_one()) {
+                listener.OnClientConnected(conn);
+            }
+        };
+
+        if constexpr (has_start<connect_listen>::value) {
+            listener.OnStart(*this);
+        }
+        std::array<struct epoll_event, max_events> events{};
+        auto deadline = std::chrono::steady_clock::time_point::max();
+        while (!m_stop_required.load()) {
+            int n_events = ::epoll_wait(m_epollfd, events.data(), max_events,
+                wait_time(std::chrono::steady_clock::now(), deadline));
+            if (n_events < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            for (int i = 0; i < n_events; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == m_wakefd) {
+                    continue; // stop flag is checked by the loop, the listener by OnTimer
+                }
+                if (fd == m_listenfd) {
+                    accept_all();
+                    continue;
+                }
+                auto el = m_connections.find(fd);
+                if (el == m_connections.end()) {
+                    continue; // dropped while handling previous event
+                }
+                std::shared_ptr<connection> conn = el->second.conn;
+                uint32_t ev = events[i].events;
+                if (ev & EPOLLOUT) {
+                    [[maybe_unused]] io_status res = conn->flush();
+                }
+                if (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    io_status res{};
+                    while (!conn->is_closing() && (res = conn->receive()) == io_status::Success) {
+                        listener.OnDataReceived(*conn);
+                    }
+                    if (res == io_status::Error) {
+                        drop(fd);
+                        continue;
+                    }
+                }
+                if (conn->is_closing() && conn->pending() == 0) {
+                    drop(fd);
+                }
+            }
+            auto now = std::chrono::steady_clock::now();
+            while (std::shared_ptr<connection> conn = expired(now)) {
+                drop(conn->get_sockfd());
+            }
+            if (m_accept_retry <= now) {
+                accept_all(); // closed connections may have freed descriptors
+            }
+            if constexpr (has_timer<connect_listen>::value) {
+                deadline = listener.OnTimer(now);
+            }
+        }
+
+        while (!m_connections.empty()) {
+            drop(m_connections.begin()->first);
+        }
+    }
+}
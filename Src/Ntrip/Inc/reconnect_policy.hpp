@@ -0,0 +1,83 @@
+#ifndef VRS_TUNNEL_RECONNECT_POLICY_
+#define VRS_TUNNEL_RECONNECT_POLICY_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+#include "ntrip_client.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Delays between connection attempts
+     */
+    struct backoff_settings
+    {
+        std::chrono::milliseconds initial{std::chrono::seconds(1)};    /**< Delay after the failed immediate retry */
+        std::chrono::milliseconds ceiling{std::chrono::seconds(60)};   /**< Backoff never grows above it */
+        std::chrono::milliseconds auth_delay{std::chrono::minutes(5)}; /**< Rejected credentials are not retried sooner */
+        std::chrono::milliseconds stable{std::chrono::seconds(30)};    /**< Shorter sessions do not reset the backoff */
+        double jitter{0.5};                                             /**< Random fraction taken off backoff delays and added to auth_delay, 0..1 */
+    };
+
+    /**
+     * Reconnection metrics
+     */
+    struct reconnect_stats
+    {
+        std::uint64_t attempts{0};          /**< Failed connection attempts */
+        std::uint64_t reconnects{0};        /**< Sessions established after an outage */
+        std::chrono::milliseconds last_outage{0};   /**< From the end of a session to the next one */
+        std::chrono::milliseconds max_outage{0};
+        std::chrono::milliseconds total_outage{0};
+    };
+
+    /**
+     * Reconnect policy of NTRIP client and server. The first retry
+     * after a lost session is immediate, then delays grow exponentially
+     * up to the ceiling, every delay is randomly shortened by up to
+     * jitter, so rovers of a restarted caster do not come back in step.
+     * Authentication failures wait at least auth_delay as retrying does
+     * not help, the jitter is added on top of it.
+     */
+    class reconnect_policy
+    {
+    public:
+        /**
+         * @param settings delays
+         * @param seed random generator seed, tests use fixed one
+         */
+        explicit reconnect_policy(backoff_settings settings = {}, std::uint32_t seed = std::random_device{}());
+
+        /**
+         * Marks the connection as established
+         */
+        void connected();
+
+        /**
+         * Registers a failed attempt or the end of a session
+         * @param reason status of the failed connect, error if a session broke
+         * @return time to wait before the next attempt
+         */
+        [[nodiscard]] std::chrono::milliseconds next_delay(status reason);
+
+        /**
+         * @return reconnection metrics
+         */
+        reconnect_stats stats() const noexcept;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        backoff_settings m_settings;
+        std::mt19937 m_random;
+        unsigned m_failures{0};             /**< Consecutive failures since a stable session */
+        bool m_session{false};              /**< Connection is established */
+        clock::time_point m_session_start{};
+        clock::time_point m_outage_start{}; /**< Epoch zero before the first session */
+        reconnect_stats m_stats{};
+    };
+}
+
+#endif /* VRS_TUNNEL_RECONNECT_POLICY_ */
@@ -0,0 +1,126 @@
+#ifndef VRS_TUNNEL_REGISTRY_
+#define VRS_TUNNEL_REGISTRY_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Concurrent map of values by socket descriptor.
+     * Entries are spread over independently locked shards, so insert and
+     * erase of different sockets rarely contend. Readers take snapshots:
+     * every shard publishes an immutable copy of its values which stays
+     * alive while any snapshot refers to it, so iteration takes no locks.
+     * A shard copy is rebuilt only if the shard changed since the last snapshot.
+     * Copy and move operations are disabled.
+     */
+    template<typename value_type>
+    class registry
+    {
+        struct published
+        {
+            std::uint64_t version{0};           /**< Shard version the values were copied at */
+            std::vector<value_type> values{};
+        };
+
+    public:
+        static constexpr std::size_t shard_count = 64;
+
+        /**
+         * Immutable snapshot of all the values
+         */
+        class view
+        {
+        public:
+            /**
+             * Calls func(const value_type&) for every value, lock free
+             */
+            template<typename F>
+            void for_each(F&& func) const
+            {
+                for (const auto& shard : m_shards) {
+                    for (const auto& value : shard->values) {
+                        func(value);
+                    }
+                }
+            }
+
+            /**
+             * @return number of values in the snapshot
+             */
+            std::size_t size() const noexcept
+            {
+                std::size_t count = 0;
+                for (const auto& shard : m_shards) {
+                    count += shard->values.size();
+                }
+                return count;
+            }
+
+        private:
+            friend class registry;
+            std::array<std::shared_ptr<const published>, shard_count> m_shards{};
+        };
+
+        registry() = default;
+        ~registry() = default;
+        registry(const registry&)               = delete;
+        registry& operator=(const registry&)    = delete;
+        registry(registry&&)                    = delete;
+        registry& operator=(registry&&)         = delete;
+
+        /**
+         * @return false if the id is registered already
+         */
+        [[nodiscard]] bool insert(int id, value_type value);
+
+        /**
+         * @return false if the id is not registered
+         */
+        bool erase(int id);
+
+        /**
+         * Swaps the value of a registered id, snapshots see either the old or the new one
+         * @return false if the id is not registered
+         */
+        bool replace(int id, value_type value);
+
+        /**
+         * @return copy of registered value, value initialized one if there is no such id
+         */
+        value_type find(int id) const;
+
+        /**
+         * @return consistent copy of every shard, taken one shard at a time
+         */
+        view snapshot() const;
+
+        /**
+         * @return number of registered values
+         */
+        std::size_t size() const noexcept;
+
+    private:
+        struct alignas(64) shard
+        {
+            mutable std::mutex mutex{};
+            std::unordered_map<int, value_type> items{};
+            std::atomic<std::uint64_t> version{1};       /**< Incremented on every change */
+            mutable std::shared_ptr<const published> view{}; /**< Accessed with atomic shared_ptr functions */
+        };
+
+        std::array<shard, shard_count> m_shards{};
+        std::atomic<std::size_t> m_size{0};
+
+        shard& shard_of(int id) noexcept;
+        const shard& shard_of(int id) const noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_REGISTRY_ */
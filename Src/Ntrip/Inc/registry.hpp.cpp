@@ -0,0 +1,102 @@
+#include "registry.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    template<typename value_type>
+    [[nodiscard]] bool registry<value_type>::insert(int id, value_type value)
+    {
+        shard& sh = shard_of(id);
+        std::scoped_lock sl(sh.mutex);
+        auto [pos, success] = sh.items.emplace(id, std::move(value));
+        if (!success) {
+            return false;
+        }
+        sh.version.fetch_add(1, std::memory_order_release);
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    template<typename value_type>
+    bool registry<value_type>::erase(int id)
+    {
+        shard& sh = shard_of(id);
+        std::scoped_lock sl(sh.mutex);
+        if (sh.items.erase(id) == 0) {
+            return false;
+        }
+        sh.version.fetch_add(1, std::memory_order_release);
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    template<typename value_type>
+    bool registry<value_type>::replace(int id, value_type value)
+    {
+        shard& sh = shard_of(id);
+        std::scoped_lock sl(sh.mutex);
+        auto el = sh.items.find(id);
+        if (el == sh.items.end()) {
+            return false;
+        }
+        el->second = std::move(value);
+        sh.version.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename value_type>
+    value_type registry<value_type>::find(int id) const
+    {
+        const shard& sh = shard_of(id);
+        std::scoped_lock sl(sh.mutex);
+        auto el = sh.items.find(id);
+        if (el == sh.items.end()) {
+            return value_type{};
+        }
+        return el->second;
+    }
+
+    template<typename value_type>
+    typename registry<value_type>::view registry<value_type>::snapshot() const
+    {
+        view result{};
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            const shard& sh = m_shards[i];
+            auto current = std::atomic_load(&sh.view);
+            if (!current || current->version != sh.version.load(std::memory_order_acquire)) {
+                std::scoped_lock sl(sh.mutex);
+                current = std::atomic_load(&sh.view);
+                std::uint64_t version = sh.version.load(std::memory_order_relaxed);
+                if (!current || current->version != version) {
+                    auto fresh = std::make_shared<published>();
+                    fresh->version = version;
+                    fresh->values.reserve(sh.items.size());
+                    for (const auto& el : sh.items) {
+                        fresh->values.emplace_back(el.second);
+                    }
+                    current = std::move(fresh);
+                    std::atomic_store(&sh.view, current);
+                }
+            }
+            result.m_shards[i] = std::move(current);
+        }
+        return result;
+    }
+
+    template<typename value_type>
+    std::size_t registry<value_type>::size() const noexcept
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    template<typename value_type>
+    typename registry<value_type>::shard& registry<value_type>::shard_of(int id) noexcept
+    {
+        return m_shards[static_cast<unsigned>(id) % shard_count];
+    }
+
+    template<typename value_type>
+    const typename registry<value_type>::shard& registry<value_type>::shard_of(int id) const noexcept
+    {
+        return m_shards[static_cast<unsigned>(id) % shard_count];
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef VRS_TUNNEL_REQUEST_PARSER_
+#define VRS_TUNNEL_REQUEST_PARSER_
+
+#include <cstdint>
+#include <string_view>
+
+#include "async_io.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Request kinds accepted by NTRIP Caster
+     */
+    enum class request_method
+    {
+        unknown,
+        get,        /**< Rover (v1, v2) or sourcetable request */
+        post,       /**< NTRIP v2 server */
+        source      /**< NTRIP v1 server */
+    };
+
+    /**
+     * Parsed NTRIP request. Views point into the buffer given to the parser.
+     */
+    struct ntrip_request
+    {
+        request_method method{request_method::unknown};
+        std::string_view mount{};               /**< Mount point without leading slash, empty for sourcetable */
+        std::string_view password{};            /**< Password of v1 SOURCE request */
+        std::string_view authorization{};       /**< Authorization header value */
+        std::string_view ntrip_version{};       /**< Ntrip-Version header value */
+        std::string_view ntrip_gga{};           /**< Ntrip-GGA header value */
+        std::string_view ntrip_str{};           /**< Ntrip-STR header value, sourcetable line of a server */
+        std::string_view transfer_encoding{};   /**< Transfer-Encoding header value */
+    };
+
+    /**
+     * Incremental NTRIP/HTTP request header parser. It is resumed on every
+     * partial read with the same, grown buffer and scans only new bytes.
+     * Fields are kept as offsets, so nothing is allocated per request.
+     */
+    class request_parser
+    {
+    public:
+        /**
+         * Continues parsing
+         * @param buffer all bytes received so far, starting with the request line
+         * @return InProgress if more bytes are needed, Success when the header
+         * is complete, Error if the request is malformed
+         */
+        [[nodiscard]] io_status parse(std::string_view buffer) noexcept;
+
+        /**
+         * @return parsed request, views point into the buffer of the last parse call
+         */
+        ntrip_request request() const noexcept;
+
+        /**
+         * @return length of the complete header including the empty line,
+         * the rest of the buffer is the body
+         */
+        std::size_t size() const noexcept;
+
+        /**
+         * Prepares parser for the next request
+         */
+        void reset() noexcept;
+
+    private:
+        /**
+         * Position of a field in the buffer
+         */
+        struct field
+        {
+            std::uint32_t offset{0};
+            std::uint32_t length{0};
+        };
+
+        enum class state { request_line, header, done, error };
+
+        state m_state{state::request_line};
+        std::size_t m_pos{0};           /**< Bytes already scanned */
+        std::size_t m_line_start{0};    /**< Beginning of the current line */
+        const char* m_base{nullptr};    /**< Buffer of the last parse call */
+        request_method m_method{request_method::unknown};
+        field m_mount{};
+        field m_password{};
+        field m_authorization{};
+        field m_ntrip_version{};
+        field m_ntrip_gga{};
+        field m_ntrip_str{};
+        field m_transfer_encoding{};
+
+        bool parse_request_line(std::string_view line) noexcept;
+        bool parse_header(std::string_view line) noexcept;
+        field to_field(std::string_view part) const noexcept;
+        std::string_view view(field f) const noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_REQUEST_PARSER_ */
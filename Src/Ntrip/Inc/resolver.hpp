@@ -0,0 +1,124 @@
+#ifndef VRS_TUNNEL_RESOLVER_
+#define VRS_TUNNEL_RESOLVER_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "tcp_client.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Cache lifetimes of resolved names
+     */
+    struct resolver_settings
+    {
+        std::chrono::milliseconds ttl{std::chrono::minutes(5)};          /**< Fresh entry is served without lookup */
+        std::chrono::milliseconds negative_ttl{std::chrono::seconds(5)}; /**< Failure is remembered, no lookup is repeated */
+        std::chrono::milliseconds max_stale{std::chrono::hours(24)};     /**< Expired entry is served while it is being refreshed */
+    };
+
+    /**
+     * Host name resolver with a cache. Lookups run in a worker thread,
+     * so a slow or unavailable name service never blocks the caller
+     * longer than its own timeout. Expired entries are refreshed in
+     * background and served meanwhile, also when the refresh fails.
+     * Copy and move operations are disabled.
+     */
+    class resolver
+    {
+    public:
+        /**
+         * Blocking name lookup performed by the worker
+         * @return Success and endpoints in preference order, or Error
+         */
+        using lookup_function = std::function<io_status(const std::string& host, int port, std::vector<endpoint>& endpoints)>;
+
+        /**
+         * @param lookup name service, getaddrinfo by default, tests provide a stub
+         * @param settings cache lifetimes
+         */
+        explicit resolver(lookup_function lookup = system_lookup, resolver_settings settings = {});
+        ~resolver();
+        resolver(const resolver&)               = delete;
+        resolver& operator=(const resolver&)    = delete;
+        resolver(resolver&&)                    = delete;
+        resolver& operator=(resolver&&)         = delete;
+
+        /**
+         * Gets endpoints from the cache or waits for the lookup
+         * @param host name or numeric address
+         * @param port TCP port
+         * @param endpoints resolved addresses
+         * @param timeout longest wait for the worker, zero only checks the cache
+         * @return Success if endpoints are stored (fresh or stale), InProgress
+         * if the lookup is still running, Error if the name can not be resolved
+         */
+        [[nodiscard]] io_status resolve(const std::string& host, int port,
+            std::vector<endpoint>& endpoints, std::chrono::milliseconds timeout);
+
+        /**
+         * @return number of lookups handed to the name service
+         */
+        std::uint64_t lookups() const noexcept;
+
+        /**
+         * Resolves the name with getaddrinfo
+         */
+        static io_status system_lookup(const std::string& host, int port, std::vector<endpoint>& endpoints);
+
+        /**
+         * @return process-wide resolver used by tcp_client
+         */
+        static resolver& shared();
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        /**
+         * Cached result of one host and port
+         */
+        struct entry
+        {
+            std::string host{};
+            int port{0};
+            std::vector<endpoint> endpoints{};  /**< Last successful result */
+            clock::time_point fresh_until{};    /**< End of freshness of the endpoints */
+            clock::time_point expires{};        /**< Next lookup is due, end of negative caching after failure */
+            bool failed{false};                 /**< The last lookup failed */
+            bool queued{false};                 /**< Lookup is waiting or running */
+            std::uint64_t generation{0};        /**< Completed lookups */
+        };
+
+        lookup_function m_lookup;
+        resolver_settings m_settings;
+        mutable std::mutex m_mutex{};
+        std::condition_variable m_done{};       /**< Lookup completed */
+        std::condition_variable m_work{};       /**< Lookup queued or stop */
+        std::unordered_map<std::string, entry> m_cache{};
+        std::deque<std::string> m_queue{};      /**< Keys of the cache waiting for lookup */
+        std::uint64_t m_lookups{0};
+        bool m_stop{false};
+        std::thread m_worker;
+
+        /**
+         * Queues lookup of the entry unless it is queued already, m_mutex is held
+         */
+        void schedule(const std::string& key, entry& e);
+
+        /**
+         * Worker thread body
+         */
+        void run();
+    };
+}
+
+#endif /* VRS_TUNNEL_RESOLVER_ */
@@ -0,0 +1,75 @@
+#ifndef VRS_TUNNEL_RESPONSE_PARSER_
+#define VRS_TUNNEL_RESPONSE_PARSER_
+
+#include <cstddef>
+#include <string_view>
+
+#include "io_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Protocol of NTRIP Caster response
+     */
+    enum class response_protocol
+    {
+        unknown,
+        icy,            /**< NTRIP v1 "ICY 200 OK" */
+        http,           /**< NTRIP v2 "HTTP/1.x" */
+        sourcetable     /**< NTRIP v1 "SOURCETABLE 200 OK" */
+    };
+
+    /**
+     * Incremental NTRIP Caster response parser. It is resumed on every
+     * partial read with the same, grown buffer and scans only new bytes.
+     * The response is classified as soon as the status line arrives:
+     * NTRIP v1 responses and failures do not wait for the rest of the
+     * header, successful HTTP responses are complete after the empty line.
+     */
+    class response_parser
+    {
+    public:
+        static constexpr std::size_t max_header = 8192; /**< Longer headers are rejected */
+
+        /**
+         * Continues parsing
+         * @param buffer all bytes received so far, starting with the status line
+         * @return InProgress if more bytes are needed, Success when the
+         * response is classified, Error if the response is malformed
+         */
+        [[nodiscard]] io_status parse(std::string_view buffer) noexcept;
+
+        /**
+         * @return status code of the response, 0 until the status line is parsed
+         */
+        int code() const noexcept;
+
+        /**
+         * @return protocol named by the status line
+         */
+        response_protocol protocol() const noexcept;
+
+        /**
+         * @return length of the parsed header, the rest of the buffer is the body
+         */
+        std::size_t size() const noexcept;
+
+        /**
+         * Prepares parser for the next response
+         */
+        void reset() noexcept;
+
+    private:
+        enum class state { status_line, header, done, error };
+
+        state m_state{state::status_line};
+        std::size_t m_pos{0};           /**< Bytes already scanned */
+        std::size_t m_line_start{0};    /**< Beginning of the current line */
+        int m_code{0};
+        response_protocol m_protocol{response_protocol::unknown};
+
+        bool parse_status_line(std::string_view line) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_RESPONSE_PARSER_ */
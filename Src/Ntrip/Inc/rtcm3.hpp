@@ -0,0 +1,103 @@
+#ifndef VRS_TUNNEL_RTCM3_
+#define VRS_TUNNEL_RTCM3_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "location.hpp"
+#include "rtcm3_framer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Stationary antenna reference point of message 1005 or 1006
+     */
+    struct station_position
+    {
+        std::uint16_t station_id{0};
+        std::uint8_t itrf_year{0};
+        bool gps{false};            /**< Station provides GPS observations */
+        bool glonass{false};
+        bool galileo{false};
+        double x{0};                /**< ECEF coordinates, meters */
+        double y{0};
+        double z{0};
+        double antenna_height{0};   /**< Meters above the marker, 1006 only */
+    };
+
+    /**
+     * GNSS of a Multiple Signal Message
+     */
+    enum class msm_system : std::uint8_t { gps, glonass, galileo, sbas, qzss, beidou, navic };
+
+    /**
+     * Header of a Multiple Signal Message (MSM1 to MSM7), observations are not decoded
+     */
+    struct msm_header
+    {
+        std::uint16_t type{0};
+        std::uint16_t station_id{0};
+        msm_system system{msm_system::gps};
+        std::uint32_t epoch_time{0};    /**< Milliseconds of the week, GLONASS: day of week and ms of the day */
+        bool multiple{false};           /**< More messages of the same epoch follow */
+        std::uint8_t satellites{0};     /**< Satellites in the satellite mask */
+        std::uint8_t signals{0};        /**< Signal types in the signal mask */
+        std::uint8_t cells{0};          /**< Observed satellite/signal pairs of the cell mask */
+    };
+
+    /**
+     * RTCM 3 helper class with static methods.
+     * Fields are read straight from the frame payload, nothing is allocated.
+     */
+    class rtcm3
+    {
+    private:
+    constexpr rtcm3() noexcept { };
+
+    public:
+    /**
+     * Extracts unsigned big endian bit field
+     * @param data buffer the position is counted from
+     * @param pos position of the first bit
+     * @param len field length, up to 57 bits
+     */
+    static std::uint64_t getbitu(const std::uint8_t* data, std::size_t pos, unsigned len) noexcept;
+
+    /**
+     * Extracts two's complement big endian bit field
+     * @param data buffer the position is counted from
+     * @param pos position of the first bit
+     * @param len field length, up to 57 bits
+     */
+    static std::int64_t getbits(const std::uint8_t* data, std::size_t pos, unsigned len) noexcept;
+
+    /**
+     * Decodes stationary antenna reference point
+     * @param frame message 1005 or 1006
+     * @param position decoded reference point
+     * @return false if the frame is another message or too short
+     */
+    [[nodiscard]] static bool decode_station(const rtcm3_frame& frame, station_position& position) noexcept;
+
+    /**
+     * @return true for the message numbers of MSM1 to MSM7 of any GNSS
+     */
+    static bool is_msm(std::uint16_t type) noexcept;
+
+    /**
+     * Decodes MSM header and counts the mask bits, satellite data is not touched
+     * @param frame MSM1 to MSM7 message
+     * @param header decoded header
+     * @return false if the frame is another message or its masks do not fit
+     */
+    [[nodiscard]] static bool decode_msm(const rtcm3_frame& frame, msm_header& header) noexcept;
+
+    /**
+     * Converts WGS84 ECEF coordinates to geodetic ones
+     * @return latitude and longitude in degrees, ellipsoidal height in meters
+     */
+    static location ecef_to_geodetic(double x, double y, double z) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_RTCM3_ */
@@ -0,0 +1,119 @@
+#ifndef VRS_TUNNEL_RTCM3_FRAMER_
+#define VRS_TUNNEL_RTCM3_FRAMER_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "io_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * RTCM3 transport frame: preamble, 6 reserved bits, 10 bit length,
+     * payload and CRC-24Q. The frame does not own its bytes.
+     */
+    struct rtcm3_frame
+    {
+        const std::uint8_t* data{nullptr};  /**< Frame preamble */
+        std::size_t size{0};                /**< Header, payload and CRC */
+
+        /**
+         * @return first byte of the message
+         */
+        const std::uint8_t* payload() const noexcept;
+
+        /**
+         * @return message length without header and CRC
+         */
+        std::size_t payload_size() const noexcept;
+
+        /**
+         * @return 12 bit message number, 0 if the payload is too short
+         */
+        std::uint16_t message_type() const noexcept;
+    };
+
+    /**
+     * RTCM3 framer counters
+     */
+    struct rtcm3_stats
+    {
+        std::uint64_t frames{0};            /**< Valid frames */
+        std::uint64_t crc_errors{0};        /**< Candidates rejected by CRC */
+        std::uint64_t discarded_bytes{0};   /**< Bytes skipped while searching for a frame */
+    };
+
+    /**
+     * Incremental RTCM3 framer.
+     * The caller feeds received bytes and takes frames until next() returns
+     * InProgress. Frames which lie entirely in the fed buffer are returned in
+     * place; only a frame split between two buffers is assembled in the
+     * framer's own fixed storage. A candidate with invalid reserved bits or
+     * CRC is skipped one byte at a time, so the framer resynchronizes on the
+     * next preamble after corruption. Nothing is allocated.
+     * Copy and move operations are disabled.
+     */
+    class rtcm3_framer
+    {
+    public:
+        static constexpr std::uint8_t preamble = 0xD3;
+        static constexpr std::size_t header_size = 3;
+        static constexpr std::size_t crc_size = 3;
+        static constexpr std::size_t max_payload = 1023;
+        static constexpr std::size_t max_frame = header_size + max_payload + crc_size;
+
+        rtcm3_framer() = default;
+        rtcm3_framer(const rtcm3_framer&)             = delete;
+        rtcm3_framer& operator=(const rtcm3_framer&)  = delete;
+        rtcm3_framer(rtcm3_framer&&)                  = delete;
+        rtcm3_framer& operator=(rtcm3_framer&&)       = delete;
+
+        /**
+         * Hands received bytes to the framer, the buffer must stay
+         * unchanged until next() returns InProgress
+         */
+        void feed(const std::uint8_t* data, std::size_t size) noexcept;
+        void feed(const char* data, std::size_t size) noexcept;
+
+        /**
+         * Finds the next valid frame
+         * @param frame set on Success, valid until the next call
+         * @return Success or InProgress when the fed bytes are used up,
+         * an incomplete frame is kept for the next feed
+         */
+        [[nodiscard]] io_status next(rtcm3_frame& frame) noexcept;
+
+        /**
+         * Drops the incomplete frame and the rest of the fed buffer
+         */
+        void reset() noexcept;
+
+        /**
+         * @return framer counters
+         */
+        rtcm3_stats stats() const noexcept;
+
+        /**
+         * Computes CRC-24Q eight bytes per step
+         * @param crc value of the preceding bytes, 0 at the beginning of the frame
+         * @return 24 bit CRC
+         */
+        static std::uint32_t crc24q(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0) noexcept;
+
+    private:
+        const std::uint8_t* m_input{nullptr};           /**< Unprocessed part of the fed buffer */
+        std::size_t m_input_size{0};
+        std::array<std::uint8_t, max_frame> m_partial{};/**< Frame split between buffers */
+        std::size_t m_begin{0};
+        std::size_t m_end{0};
+        rtcm3_stats m_stats{};
+
+        /**
+         * Drops the preamble of the buffered candidate and moves to the next one
+         */
+        void skip_partial() noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_RTCM3_FRAMER_ */
@@ -0,0 +1,169 @@
+#ifndef VRS_TUNNEL_SERIAL_SINK_
+#define VRS_TUNNEL_SERIAL_SINK_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <termios.h>
+
+#include "io_backend.hpp"
+#include "message_filter.hpp"
+#include "rtcm3_framer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Serial port flow control
+     */
+    enum class flow_control
+    {
+        none,
+        rtscts,     /**< Hardware RTS/CTS */
+        xonxoff     /**< Software XON/XOFF */
+    };
+
+    /**
+     * Serial port configuration, 8N1 framing is always used
+     */
+    struct serial_settings
+    {
+        int baud{115200};
+        flow_control flow{flow_control::none};
+        bool rtcm_frames{true};     /**< Write whole RTCM3 frames only, false passes bytes through */
+        std::chrono::milliseconds max_backlog{500}; /**< Frames which would wait longer on the link are dropped */
+        message_filter filter{};    /**< Message types written to the port */
+    };
+
+    /**
+     * Serial sink counters
+     */
+    struct serial_stats
+    {
+        std::uint64_t frames{0};            /**< Frames written */
+        std::uint64_t bytes{0};             /**< Bytes written */
+        std::uint64_t dropped_frames{0};    /**< Frames which did not fit into the link bandwidth */
+        std::uint64_t dropped_bytes{0};
+        std::uint64_t discarded_bytes{0};   /**< Bytes outside valid RTCM3 frames */
+        std::uint64_t filtered_frames{0};   /**< Frames of message types not wanted by the receiver */
+        std::uint64_t filtered_bytes{0};
+    };
+
+    /**
+     * Correction output to GNSS receiver over a serial port.
+     * Incoming bytes are split into CRC checked RTCM3 frames, every frame
+     * is handed to the port whole, so the receiver never gets a frame
+     * interleaved with a partial one. The link is modelled as a queue
+     * drained at baud / 10 bytes per second; a frame which would wait
+     * longer than max_backlog is dropped before the receiver buffer fills.
+     * The sink never waits for the port: frames the driver does not take
+     * stay in the output until flush() is called once the port is writable.
+     * Copy and move operations are disabled.
+     */
+    class serial_sink
+    {
+    public:
+        static constexpr std::size_t output_capacity = 8 * rtcm3_framer::max_frame; /**< Frames gathered for one write */
+
+        serial_sink() = default;
+        ~serial_sink();
+        serial_sink(const serial_sink&)             = delete;
+        serial_sink& operator=(const serial_sink&)  = delete;
+        serial_sink(serial_sink&&)                  = delete;
+        serial_sink& operator=(serial_sink&&)       = delete;
+
+        /**
+         * Opens and configures the port in raw mode
+         * @param path device, /dev/ttyUSB0 for example
+         * @param settings port configuration
+         * @return Error if the device can not be opened or the baud rate is not supported
+         */
+        [[nodiscard]] io_status open(const std::string& path, const serial_settings& settings);
+
+        /**
+         * Closes the port if it is open
+         */
+        void close() noexcept;
+
+        /**
+         * Discards the incomplete frame, called when the stream restarts
+         */
+        void reset() noexcept;
+
+        /**
+         * Writes complete frames found in the received bytes,
+         * the incomplete tail is kept for the next call
+         * @param data received correction
+         * @param size amount of received bytes
+         * @return Error if the port is broken
+         */
+        [[nodiscard]] io_status write(const char* data, std::size_t size) noexcept;
+
+        /**
+         * Writes frames left by the blocked port, called when it becomes writable
+         * @return Success if nothing is left, InProgress if the port would still block, Error
+         */
+        [[nodiscard]] io_status flush() noexcept;
+
+        /**
+         * @return true while admitted frames wait for the port to become writable
+         */
+        bool blocked() const noexcept;
+
+        /**
+         * @return serial sink counters
+         */
+        serial_stats stats() const noexcept;
+
+        /**
+         * @return received frames and bytes of every message type
+         */
+        const message_stats& messages() const noexcept;
+
+        /**
+         * @return file descriptor of the port, -1 if it is closed
+         */
+        int get_fd() const noexcept;
+
+        /**
+         * Converts baud rate to termios speed constant
+         * @return false if the rate is not supported
+         */
+        static bool to_speed(int baud, speed_t& speed) noexcept;
+
+        /**
+         * Parses flow control name: none, rtscts, xonxoff
+         * @return false if the name is unknown
+         */
+        static bool parse(std::string_view name, flow_control& flow) noexcept;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        int m_fd{-1};
+        serial_settings m_settings{};
+        double m_rate{0};                               /**< Link bandwidth, bytes per second */
+        double m_backlog{0};                            /**< Bytes modelled as waiting on the link */
+        clock::time_point m_drained{};                  /**< Time of the last backlog update */
+        rtcm3_framer m_framer{};
+        std::unique_ptr<message_stats> m_messages{std::make_unique<message_stats>()};
+        std::array<char, output_capacity> m_output{};   /**< Admitted frames waiting for write */
+        std::size_t m_output_size{0};
+        bool m_failed{false};
+        serial_stats m_stats{};
+
+        /**
+         * Admits the frame to the output or drops it
+         */
+        void admit(const char* data, std::size_t size) noexcept;
+
+        /**
+         * Counts the frame as dropped
+         */
+        void drop(std::size_t size) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_SERIAL_SINK_ */
@@ -0,0 +1,43 @@
+#ifndef VRS_TUNNEL_SHARED_BUFFER_
+#define VRS_TUNNEL_SHARED_BUFFER_
+
+#include <memory>
+#include <string_view>
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Immutable block of bytes. It is allocated once and shared by reference
+     * between all the connections which transmit it, so broadcasting
+     * to N subscribers costs no copies. Copy and move operations are disabled.
+     */
+    class shared_buffer
+    {
+        shared_buffer(const shared_buffer&)             = delete;
+        shared_buffer& operator=(const shared_buffer&)  = delete;
+        shared_buffer(shared_buffer&&)                  = delete;
+        shared_buffer& operator=(shared_buffer&&)       = delete;
+
+        std::unique_ptr<char[]> m_data;     /**< Buffer content */
+        std::size_t m_size;                 /**< Buffer size */
+
+        shared_buffer(const char* data, std::size_t size);
+
+    public:
+        ~shared_buffer() = default;
+
+        /**
+         * Copies the bytes into a new shared buffer
+         * @param data bytes to be shared
+         * @param size amount of bytes
+         * @return reference counted buffer
+         */
+        static std::shared_ptr<const shared_buffer> make(const char* data, std::size_t size);
+
+        const char* data() const noexcept;
+        std::size_t size() const noexcept;
+        std::string_view view() const noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_SHARED_BUFFER_ */
@@ -0,0 +1,84 @@
+#ifndef VRS_TUNNEL_SOURCETABLE_
+#define VRS_TUNNEL_SOURCETABLE_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "location.hpp"
+#include "shared_buffer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Caster sourcetable built from the live mount points.
+     * The complete response is rendered once per change of the mount list
+     * into immutable shared buffers, so serving GET / only takes references.
+     * Entries use STR layout consumed by mount_point::parse_table.
+     * Thread safe. Copy and move operations are disabled.
+     */
+    class sourcetable
+    {
+    public:
+        /**
+         * Pre-serialized sourcetable response
+         */
+        struct rendered
+        {
+            std::uint64_t version{0};                           /**< Incremented on every mount list change */
+            std::shared_ptr<const shared_buffer> v1_header{};   /**< NTRIP 1.0 status line and headers */
+            std::shared_ptr<const shared_buffer> v2_header{};   /**< NTRIP 2.0 status line and headers */
+            std::shared_ptr<const shared_buffer> body{};        /**< STR lines and ENDSOURCETABLE */
+        };
+
+        sourcetable();
+        ~sourcetable() = default;
+        sourcetable(const sourcetable&)               = delete;
+        sourcetable& operator=(const sourcetable&)    = delete;
+        sourcetable(sourcetable&&)                    = delete;
+        sourcetable& operator=(sourcetable&&)         = delete;
+
+        /**
+         * Adds or replaces mount point entry and renders the table again
+         * @param mount mount point name
+         * @param str STR line of the base station, with or without "STR;" prefix.
+         * Entry with default values is created if it is empty.
+         */
+        void add(std::string_view mount, std::string_view str);
+
+        /**
+         * Replaces latitude and longitude of the entry, the table is
+         * rendered again only if the rounded coordinates changed
+         * @return false if there is no such entry
+         */
+        bool set_position(std::string_view mount, const location& position);
+
+        /**
+         * Removes mount point entry and renders the table again
+         * @return false if there was no such entry
+         */
+        bool remove(std::string_view mount);
+
+        /**
+         * @return current response, never nullptr
+         */
+        std::shared_ptr<const rendered> get() const;
+
+    private:
+        mutable std::mutex m_mutex{};
+        std::map<std::string, std::string, std::less<>> m_entries{};    /**< STR line of each mount point */
+        std::uint64_t m_version{0};
+        std::shared_ptr<const rendered> m_rendered{};   /**< Accessed with atomic shared_ptr functions */
+
+        /**
+         * Serializes the entries, called under the mutex
+         */
+        void render();
+    };
+}
+
+#endif /* VRS_TUNNEL_SOURCETABLE_ */
@@ -0,0 +1,109 @@
+#ifndef VRS_TUNNEL_SPMC_RING_
+#define VRS_TUNNEL_SPMC_RING_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * Result of reading from the ring
+     */
+    enum class ring_status
+    {
+        Success,    /**< Next chunk is copied */
+        Empty,      /**< Nothing new is published */
+        Lapped      /**< Producer overwrote unread chunks, cursor is moved to the newest one */
+    };
+
+    /**
+     * Wait-free single producer, multiple consumer ring of byte chunks.
+     * One ingest thread publishes chunks of a mount point stream, every reactor
+     * thread reads them with its own cursor. Producer never waits for consumers:
+     * a consumer which falls behind by more than the ring capacity is lapped.
+     * Slots are protected by sequence numbers, so neither side takes a lock.
+     * Every chunk carries a tag, a value the producer gives it for the consumers.
+     * Copy and move operations are disabled.
+     */
+    class spmc_ring
+    {
+    public:
+        static constexpr std::size_t slot_size = 2048; /**< Largest chunk stored in one slot */
+
+        /**
+         * Reading position of one consumer
+         */
+        struct cursor
+        {
+            std::uint64_t next{0};      /**< Sequence number of the next chunk to read */
+            std::uint64_t lapped{0};    /**< Times the consumer was overrun by the producer */
+            std::uint64_t lost{0};      /**< Chunks skipped because of overruns */
+        };
+
+        /**
+         * @param capacity number of slots
+         */
+        explicit spmc_ring(std::size_t capacity);
+        ~spmc_ring() = default;
+        spmc_ring(const spmc_ring&)             = delete;
+        spmc_ring& operator=(const spmc_ring&)  = delete;
+        spmc_ring(spmc_ring&&)                  = delete;
+        spmc_ring& operator=(spmc_ring&&)       = delete;
+
+        /**
+         * Publishes bytes, chunks larger than slot_size occupy several slots.
+         * It must be called from the producer thread only.
+         * @param data bytes to publish
+         * @param size amount of bytes
+         * @param tag value of every slot of the chunk
+         */
+        void publish(const char* data, std::size_t size, std::uint32_t tag = 0) noexcept;
+
+        /**
+         * @return cursor which receives chunks published from now on
+         */
+        cursor subscribe() const noexcept;
+
+        /**
+         * Copies the next chunk
+         * @param cur consumer position, advanced on success and resynchronized when lapped
+         * @param data buffer of at least slot_size bytes
+         * @param size amount of copied bytes
+         * @return status of the read
+         */
+        [[nodiscard]] ring_status read(cursor& cur, char* data, std::size_t& size) const noexcept;
+
+        /**
+         * Copies the next chunk and its tag
+         */
+        [[nodiscard]] ring_status read(cursor& cur, char* data, std::size_t& size, std::uint32_t& tag) const noexcept;
+
+        /**
+         * @return number of chunks published but not read by the consumer yet
+         */
+        std::uint64_t lag(const cursor& cur) const noexcept;
+
+        std::size_t capacity() const noexcept;
+
+    private:
+        static constexpr std::size_t slot_words = slot_size / sizeof(std::uint64_t);
+
+        struct alignas(64) slot
+        {
+            std::atomic<std::uint64_t> seq{0};  /**< 2n+1 while chunk n is written, 2n+2 when it is ready */
+            std::atomic<std::uint32_t> size{0};
+            std::atomic<std::uint32_t> tag{0};
+            std::array<std::atomic<std::uint64_t>, slot_words> words{};
+        };
+
+        std::size_t m_capacity;                     /**< Number of slots */
+        std::unique_ptr<slot[]> m_slots;
+        alignas(64) std::atomic<std::uint64_t> m_head{0};   /**< Number of published chunks */
+
+        void publish_slot(const char* data, std::size_t size, std::uint32_t tag) noexcept;
+    };
+}
+
+#endif /* VRS_TUNNEL_SPMC_RING_ */
@@ -0,0 +1,61 @@
+#ifndef VRS_TUNNEL_STREAM_PROFILE_
+#define VRS_TUNNEL_STREAM_PROFILE_
+
+#include <bitset>
+#include <string>
+#include <string_view>
+
+#include "location.hpp"
+#include "message_filter.hpp"
+#include "rtcm3.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * What a base station stream contains: message types, GNSS systems
+     * and the reference point of 1005/1006. It is collected frame by frame
+     * without allocation and turns into the NTRIP-STR line of the station.
+     */
+    class stream_profile
+    {
+    public:
+        /**
+         * Records the frame, decodes 1005/1006
+         */
+        void add(const rtcm3_frame& frame) noexcept;
+
+        /**
+         * @return true until the first RTCM3 frame
+         */
+        bool empty() const noexcept;
+
+        /**
+         * @return true once a reference point has been decoded
+         */
+        bool has_position() const noexcept;
+
+        /**
+         * @return geodetic reference point, meaningful if has_position()
+         */
+        location position() const noexcept;
+
+        /**
+         * @return the last decoded 1005/1006
+         */
+        const station_position& station() const noexcept;
+
+        /**
+         * Builds STR line without the "STR;" prefix
+         * @param mount mount point name, also used as identifier
+         * @param fallback reference point used if none has been decoded
+         */
+        std::string str(std::string_view mount, const location& fallback) const;
+
+    private:
+        std::bitset<message_filter::message_types> m_types{};   /**< Message types seen */
+        station_position m_station{};
+        bool m_has_position{false};
+    };
+}
+
+#endif /* VRS_TUNNEL_STREAM_PROFILE_ */
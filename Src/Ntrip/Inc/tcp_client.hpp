@@ -1,7 +1,9 @@
 #ifndef TCP_ASYNCHRONOUS_CLIENT_
 #define TCP_ASYNCHRONOUS_CLIENT_
 
+#include <chrono>
 #include <string>
+#include <vector>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
@@ -11,6 +13,15 @@
 
 namespace VrsTunnel::Ntrip
 {
+    /**
+     * Socket address of a server
+     */
+    struct endpoint
+    {
+        struct sockaddr_storage address;
+        socklen_t length;
+    };
+
     /**
      *  TCP client class. Copy and move operations are disabled.
      */
@@ -20,6 +31,9 @@ namespace VrsTunnel::Ntrip
         int m_sockfd{-1}; /**< socket file descriptor */
 
     public:
+        static constexpr std::chrono::milliseconds default_timeout{std::chrono::seconds(10)}; /**< Deadline of connect without explicit timeout */
+        static constexpr std::chrono::milliseconds default_attempt_delay{250}; /**< RFC 8305 recommendation */
+
         /**
          * default constructor
          */
@@ -53,6 +67,32 @@ namespace VrsTunnel::Ntrip
          */
         [[nodiscard]] io_status connect(std::string addr, int port);
 
+        /**
+         * connect method creates tcp connection with a deadline,
+         * all addresses of the server are raced (see connect(endpoints)).
+         * @param addr server address
+         * @param port TCP port of the server
+         * @param timeout time limit for all addresses of the server
+         * @param attempt_delay time before the next address is tried in parallel
+         * @return connection result, Error if the time is over
+         */
+        [[nodiscard]] io_status connect(std::string addr, int port, std::chrono::milliseconds timeout,
+            std::chrono::milliseconds attempt_delay = default_attempt_delay);
+
+        /**
+         * Happy Eyeballs (RFC 8305) connection. Address families are
+         * interleaved, a non-blocking attempt is started every attempt_delay
+         * or as soon as the previous one fails, while earlier attempts are
+         * still awaited. The first connected socket wins, the rest are closed.
+         * The socket is switched back to blocking mode when it is connected.
+         * @param endpoints addresses of the server in preference order
+         * @param timeout time limit for all attempts
+         * @param attempt_delay time before the next address is tried in parallel
+         * @return connection result, Error if the time is over
+         */
+        [[nodiscard]] io_status connect(const std::vector<endpoint>& endpoints, std::chrono::milliseconds timeout,
+            std::chrono::milliseconds attempt_delay = default_attempt_delay);
+
         /**
          * @return file descriptor of TCP connection
          */
@@ -3,15 +3,17 @@
 
 #include <memory>
 #include <thread>
-#include <atomic>
-#include <sys/socket.h>
+#include <vector>
 
-#include "tcp_client.hpp"
-
-#include <iostream>
+#include "reactor.hpp"
 
 namespace VrsTunnel::Ntrip
 {
+    /**
+     * TCP server runs epoll reactors in background threads.
+     * A reactor owns listening and client sockets, connection
+     * events are delivered to connect_listen type (see reactor).
+     */
     class tcp_server
     {
     public:
@@ -22,25 +24,39 @@ namespace VrsTunnel::Ntrip
         tcp_server& operator=(const tcp_server&) = delete;
         tcp_server& operator=(tcp_server&&) = delete;
        
+        /**
+         * Starts single reactor thread
+         */
         template<typename connect_listen>
         [[nodiscard]] bool start(int port, connect_listen& listener);
 
+        /**
+         * Starts one reactor thread per listener, thread N is pinned to the Nth CPU
+         * the process is allowed to run on, wrapping around if there are fewer.
+         * Every reactor has its own SO_REUSEPORT socket bound to the port
+         * and owns the connections it accepted: a listener must not need clients
+         * of the other shards, whatever the shards share goes through the listeners,
+         * e.g. mount points of accept_listener through mount_registry.
+         * @param port TCP port to accept connections on
+         * @param listeners receiver of connection events for each shard
+         * @return true if all the shards are listening
+         */
+        template<typename connect_listen>
+        [[nodiscard]] bool start(int port, std::vector<std::unique_ptr<connect_listen>>& listeners);
+
         void stop();
         
     private:
         int m_port{-1};
-        std::thread m_thread_v4{};
-        std::atomic<bool> stop_required{true};
-        int m_servfd4{-1};
-        struct sockaddr_in m_addr4{};
-        void close(int& servfd);
+        std::vector<std::thread> m_threads{};
+        std::vector<std::unique_ptr<reactor>> m_reactors{};
 
         template<typename connect_listen>
-        void run_accepting(struct sockaddr* addr, int sockfd, connect_listen& listener);
+        void run_accepting(reactor& shard, connect_listen& listener, int core);
 
     };
 
     
 }
 
-#endif /* VRS_TUNNEL_TCP_SERVER_ */
\ No newline at end of file
+#endif /* VRS_TUNNEL_TCP_SERVER_ */
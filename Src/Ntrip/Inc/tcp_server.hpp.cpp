@@ -1,83 +1,92 @@
+#include <pthread.h>
+#include <sched.h>
+
 #include "tcp_server.hpp"
+#include "reactor.hpp.cpp"
 
 namespace VrsTunnel::Ntrip
 {
     template<typename connect_listen>
     [[nodiscard]] bool tcp_server::start(int port, connect_listen& listener)
     {
+        if (port <= 0 || !m_reactors.empty()) {
+            return false;
+        }
         m_port = port;
-        auto start_thread = [instance = this](std::thread& the_thread, int& servfd, struct sockaddr_in& addr, 
-                    int family, connect_listen& listener, int port, std::atomic<bool>& stop_required) {
-            servfd = socket(family, SOCK_STREAM, 0);
-            if (servfd == 0) {
-                servfd = -1;
-                return false;
-            }
-            memset(&addr, 0, sizeof(addr));
-            addr.sin_family      = family;
-            addr.sin_addr.s_addr = htonl(INADDR_ANY);
-            addr.sin_port        = htons(port);
-            if ((bind(servfd, (const struct sockaddr *)&addr, sizeof(addr))) < 0) {
+        auto shard = std::make_unique<reactor>();
+        if (!shard->listen(m_port)) {
+            return false;
+        }
+        m_reactors.emplace_back(std::move(shard));
+        m_threads.emplace_back(&tcp_server::run_accepting<connect_listen>, 
+                this, std::ref(*m_reactors.back()), std::ref(listener), -1);
+        return true;
+    }
+
+    template<typename connect_listen>
+    [[nodiscard]] bool tcp_server::start(int port, std::vector<std::unique_ptr<connect_listen>>& listeners)
+    {
+        if (port <= 0 || listeners.empty() || !m_reactors.empty()) {
+            return false;
+        }
+        m_port = port;
+        // all the sockets are bound before accepting starts, so failure leaves no thread behind
+        for (std::size_t i = 0; i < listeners.size(); ++i) {
+            auto shard = std::make_unique<reactor>();
+            if (!shard->listen(m_port, true)) {
+                m_reactors.clear();
                 return false;
             }
-            if (listen(servfd, 64) < 0) {
-                return false;
+            m_reactors.emplace_back(std::move(shard));
+        }
+        // only CPUs of the process cpuset, a container may not own core 0
+        std::vector<int> cores{};
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    cores.push_back(cpu);
+                }
             }
-            stop_required.store(false);
-            the_thread = std::thread{&tcp_server::run_accepting<connect_listen>, 
-                    instance, (struct sockaddr*)&addr, servfd, std::ref(listener)};
-            return true;
-        };
-
-        if (m_port > 0) {
-            return start_thread(m_thread_v4, m_servfd4, m_addr4, AF_INET, listener, m_port, stop_required);
         }
-        return false;
+        for (std::size_t i = 0; i < listeners.size(); ++i) {
+            int core = cores.empty() ? -1 : cores[i % cores.size()];
+            m_threads.emplace_back(&tcp_server::run_accepting<connect_listen>, 
+                    this, std::ref(*m_reactors[i]), std::ref(*listeners[i]), core);
+        }
+        return true;
     }
 
     template<typename connect_listen>
-    void tcp_server::run_accepting(struct sockaddr* addr, int sockfd, connect_listen& listener)
+    void tcp_server::run_accepting(reactor& shard, connect_listen& listener, int core)
     {
-        socklen_t sock_len = sizeof(*addr);
-        for(;;) {
-            if (stop_required.load()) {
-                return;
-            }
-            int client_socket = accept(sockfd, addr, &sock_len);
-            if (client_socket > 0) { 
-                listener.OnClientConnected(std::make_unique<tcp_client>(client_socket));
-            }
+        if (core >= 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(core, &cpus);
+            // not fatal, the shard just migrates between cores
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus);
         }
+        shard.run(listener);
     }
         
     void tcp_server::stop()
     {
-        stop_required.store(true);
-        if (m_port > 0) {
-            tcp_client tc{};
-            auto res = tc.connect("localhost", m_port);
-            if (res == io_status::Success) {
-                tc.close();
-            }
+        for (auto& shard : m_reactors) {
+            shard->stop();
         }
-        close(m_servfd4);
-        if (m_thread_v4.joinable()) {
-            m_thread_v4.join();
+        for (auto& th : m_threads) {
+            if (th.joinable()) {
+                th.join();
+            }
         }
+        m_threads.clear();
+        m_reactors.clear();
     }
     
     tcp_server::~tcp_server()
     {
-        this->close(m_servfd4);
-    }
-
-    void tcp_server::close(int& servfd) {
-        if (servfd != -1) {
-            int res = ::close(servfd);
-            if (res != 0) {
-                throw std::runtime_error("possible memory leak");
-            }
-            servfd = -1;
-        }
+        this->stop();
     }
-}
\ No newline at end of file
+}
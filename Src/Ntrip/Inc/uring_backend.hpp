@@ -0,0 +1,72 @@
+#ifndef VRS_TUNNEL_URING_BACKEND_
+#define VRS_TUNNEL_URING_BACKEND_
+
+#include <array>
+#include <sys/socket.h>
+
+#include "io_backend.hpp"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace VrsTunnel::Ntrip
+{
+    /**
+     * io_uring backend on raw system calls. Every instance owns a small ring,
+     * a gather send is queued with one io_uring_enter call and its completion
+     * is read from the shared completion queue without system calls.
+     */
+    class uring_backend final : public io_backend
+    {
+        int m_sockfd;                       /**< Socket to write to */
+        int m_ringfd{-1};                   /**< io_uring instance */
+        void* m_sq_ring{nullptr};           /**< Mapped submission queue ring */
+        std::size_t m_sq_ring_size{0};
+        void* m_cq_ring{nullptr};           /**< Mapped completion queue ring, can be the same mapping */
+        std::size_t m_cq_ring_size{0};
+        io_uring_sqe* m_sqes{nullptr};      /**< Mapped submission queue entries */
+        std::size_t m_sqes_size{0};
+        unsigned* m_sq_tail{nullptr};
+        unsigned* m_sq_mask{nullptr};
+        unsigned* m_sq_array{nullptr};
+        unsigned* m_cq_head{nullptr};
+        unsigned* m_cq_tail{nullptr};
+        unsigned* m_cq_mask{nullptr};
+        io_uring_cqe* m_cqes{nullptr};
+
+        std::array<struct iovec, max_iov> m_iov{}; /**< Buffers being transmitted */
+        std::size_t m_count{0};             /**< Number of buffers */
+        std::size_t m_first{0};             /**< First buffer not written completely */
+        struct msghdr m_msg{};              /**< Referenced by the kernel while the send is in flight */
+        std::size_t m_sent{0};              /**< Bytes already written */
+        bool m_in_flight{false};            /**< Send is owned by the kernel */
+        bool m_failed{false};               /**< Send failed */
+
+        /**
+         * Queues send of the rest of the buffers
+         */
+        void submit() noexcept;
+
+        /**
+         * Takes the completion of the send, resubmits short write
+         * @param wait block until the completion arrives
+         */
+        void reap(bool wait) noexcept;
+
+        void release() noexcept;
+
+    public:
+        /**
+         * Sets up the ring, throws std::runtime_error if io_uring is not available
+         */
+        explicit uring_backend(int sockfd);
+        ~uring_backend() override;
+
+        [[nodiscard]] io_status write(const struct iovec* iov, std::size_t count) override;
+        [[nodiscard]] io_status check() noexcept override;
+        [[nodiscard]] ssize_t end() noexcept override;
+        io_engine engine() const noexcept override;
+    };
+}
+
+#endif /* VRS_TUNNEL_URING_BACKEND_ */
@@ -1,29 +1,547 @@
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string_view>
+
 #include "accept_listener.hpp"
+#include "rtcm3.hpp"
+
+namespace
+{
+    constexpr std::string_view response_icy_ok {"ICY 200 OK\r\n\r\n"};
+    constexpr std::string_view response_rover_ok {"HTTP/1.1 200 OK\r\n"
+        "Ntrip-Version: Ntrip/2.0\r\n"
+        "Content-Type: gnss/data\r\n"
+        "Cache-Control: no-store, no-cache, max-age=0\r\n"
+        "Connection: close\r\n\r\n"};
+    constexpr std::string_view response_server_ok {"HTTP/1.1 200 OK\r\n"
+        "Ntrip-Version: Ntrip/2.0\r\n"
+        "Connection: close\r\n\r\n"};
+    constexpr std::string_view response_bad_request {"HTTP/1.1 400 Bad Request\r\n\r\n"};
+    constexpr std::string_view response_not_found {"HTTP/1.1 404 Not Found\r\n\r\n"};
+    constexpr std::string_view response_conflict {"HTTP/1.1 409 Conflict\r\n\r\n"};
+
+    constexpr std::uint32_t tag_epoch = 1;  /**< Chunk of frames begins an observation epoch */
+    constexpr std::uint32_t tag_raw = 2;    /**< Chunk of a stream which is not RTCM3 */
+
+    /**
+     * @return size of the RTCM3 frame which begins at the pointer
+     */
+    std::size_t frame_size(const char* frame) noexcept
+    {
+        auto header = reinterpret_cast<const std::uint8_t*>(frame);
+        return VrsTunnel::Ntrip::rtcm3_framer::header_size
+            + (static_cast<std::size_t>(header[1] & 0x03) << 8 | header[2])
+            + VrsTunnel::Ntrip::rtcm3_framer::crc_size;
+    }
+}
 
 namespace VrsTunnel::Ntrip
 {
+    accept_listener::accept_listener(const queue_limits& limits) :
+        m_limits{limits}
+    {
+        if (m_limits.policy == overflow_policy::disconnect) {
+            m_next_stall_check = std::chrono::steady_clock::time_point{};
+        }
+    }
+
+    accept_listener::accept_listener(std::shared_ptr<mount_registry> mounts, std::size_t shard,
+        const queue_limits& limits) : accept_listener(limits)
+    {
+        if (!mounts || shard >= mounts->shards()) {
+            throw std::runtime_error("wrong shard of the mount registry");
+        }
+        m_mounts = std::move(mounts);
+        m_shard = shard;
+    }
+
+    void accept_listener::OnStart(reactor& loop)
+    {
+        m_mounts->attach(m_shard, loop);
+    }
     
-    void accept_listener::OnClientConnected(std::unique_ptr<tcp_client> client)
-    {
-        std::scoped_lock sl(the_mutex);
-        element elem{};
-        elem.asy_io = std::make_unique<async_io>(client->get_sockfd());
-        elem.tcp_client = std::move(client);
-        int id = elem.tcp_client->get_sockfd();
-        auto [el_iter, success] = m_clients.emplace(id, std::move(elem));
-        if (!success) {
+    void accept_listener::OnClientConnected(const std::shared_ptr<connection>& client)
+    {
+        client->set_limits(m_limits);
+        int fd = client->get_sockfd();
+        auto [el, success] = m_sessions.try_emplace(fd);
+        if (!success || !m_clients.insert(fd, std::make_shared<const accept_listener::client>(
+                accept_listener::client{client, client_role::pending, {}}))) {
             throw std::runtime_error("TCP client exists already");
         }
+        el->second.conn = client;
     }
-    
-    std::list<std::weak_ptr<async_io>> accept_listener::get_asyncs() const
+
+    void accept_listener::OnDataReceived(connection& client)
+    {
+        auto el = m_sessions.find(client.get_sockfd());
+        if (el == m_sessions.end()) {
+            client.consume(client.input().size());
+            return;
+        }
+        session& elem = el->second;
+        if (elem.role == client_role::pending) {
+            auto res = elem.parser.parse(client.input());
+            if (res == io_status::InProgress) {
+                return;
+            }
+            if (res == io_status::Error) {
+                [[maybe_unused]] auto sent = client.send(response_bad_request.data(), response_bad_request.size());
+                client.close();
+                return;
+            }
+            on_request(elem, client);
+            client.consume(elem.parser.size());
+        }
+        if (elem.role == client_role::source) {
+            auto data = client.input();
+            if (!data.empty()) {
+                on_stream(elem, data);
+            }
+        }
+        else if (elem.role == client_role::rover) {
+            auto data = client.input();
+            if (!data.empty()) {
+                on_rover(elem, data);
+            }
+        }
+        client.consume(client.input().size());
+    }
+
+    void accept_listener::on_request(session& elem, connection& client)
+    {
+        auto req = elem.parser.request();
+        auto reply = [&client](std::string_view response) {
+            [[maybe_unused]] auto sent = client.send(response.data(), response.size());
+        };
+        bool v2 = req.ntrip_version == "Ntrip/2.0";
+
+        if (req.method == request_method::get && req.mount.empty()) {
+            send_table(client, v2);
+            return;
+        }
+        if (req.method == request_method::get) {
+            std::string_view mount = req.mount.substr(0, req.mount.find('?'));
+            std::string_view query = mount.size() < req.mount.size() ? req.mount.substr(mount.size() + 1) : std::string_view{};
+            bool valid = true;
+            auto filter = rover_filter(query, valid);
+            if (!valid) {
+                reply(response_bad_request);
+                client.close();
+                return;
+            }
+            auto conn = elem.conn.lock();
+            bool local = m_sources.find(mount) != m_sources.end();
+            if (!conn || (!local && !m_mounts->find(mount))) {
+                reply(response_not_found);
+                client.close();
+                return;
+            }
+            reply(v2 ? response_rover_ok : response_icy_ok);
+            elem.role = client_role::rover;
+            elem.mount = mount;
+            elem.sentences = std::make_unique<nmea_framer>();
+            elem.position = std::make_shared<rover_fix>();
+            publish(client.get_sockfd(), elem);
+            m_fan_out.subscribe(elem.mount, conn, std::move(filter));
+            if (!local) {
+                auto [remote, created] = m_remote.try_emplace(elem.mount);
+                if (created || !remote->second.feed) {
+                    join(elem.mount, remote->second);
+                }
+            }
+            return;
+        }
+
+        auto stream = m_mounts->add(req.mount, m_shard, req.ntrip_str);
+        if (!stream) {
+            reply(response_conflict); // mount point is fed by another base station
+            client.close();
+            return;
+        }
+        reply(req.method == request_method::post ? response_server_ok : response_icy_ok);
+        elem.role = client_role::source;
+        elem.mount = req.mount;
+        elem.feed = std::move(stream);
+        elem.framer = std::make_unique<rtcm3_framer>();
+        elem.messages = std::make_shared<message_stats>();
+        elem.epochs = std::make_shared<epoch_monitor>();
+        if (m_epoch_wait.count() > 0) {
+            elem.bundle = std::make_unique<epoch_assembler>(m_epoch_wait);
+        }
+        {
+            std::lock_guard lock(m_epochs_mutex);
+            m_epochs[elem.mount] = elem.epochs;
+        }
+        publish(client.get_sockfd(), elem);
+        m_sources.emplace(elem.mount, client.get_sockfd());
+        auto remote = m_remote.find(elem.mount);
+        if (remote != m_remote.end()) {
+            leave(remote->second);  // rovers of this shard are fed directly again
+            m_remote.erase(remote);
+        }
+    }
+
+    void accept_listener::publish(int fd, const session& elem)
+    {
+        // counters and fix exist before the record is published, readers never see the pointers change
+        m_clients.replace(fd, std::make_shared<const client>(
+            client{elem.conn, elem.role, elem.mount, elem.messages, elem.position}));
+    }
+
+    void accept_listener::on_stream(session& elem, std::string_view data)
     {
-        std::list<std::weak_ptr<async_io>> list{};
-        std::scoped_lock sl(the_mutex);
-        for (const auto el : m_clients) {
-            list.emplace_back(std::weak_ptr(el.second.asy_io));
+        m_batch.clear();
+        bool epoch = false; // the batch begins an epoch
+        elem.framer->feed(data.data(), data.size());
+        auto arrival = epoch_monitor::clock::now();
+        rtcm3_frame frame{};
+        msm_header msm{};
+        while (elem.framer->next(frame) == io_status::Success) {
+            std::uint16_t type = frame.message_type();
+            elem.messages->count(type, frame.size);
+            station_position station{};
+            bool is_msm = rtcm3::is_msm(type) && rtcm3::decode_msm(frame, msm);
+            if (is_msm) {
+                elem.epochs->add(msm, arrival);
+            }
+            else if ((type == 1005 || type == 1006) && rtcm3::decode_station(frame, station)) {
+                // the sourcetable shows where the antenna is, not what the operator typed
+                m_mounts->table().set_position(elem.mount, rtcm3::ecef_to_geodetic(station.x, station.y, station.z));
+            }
+            if (elem.bundle) {
+                if (is_msm && elem.bundle->other_epoch(msm)) {
+                    send_epoch(elem, true); // the last message of the previous epoch has been lost
+                }
+                if (elem.bundle->add(frame, is_msm ? &msm : nullptr, arrival) == io_status::Success) {
+                    send_epoch(elem, true);
+                }
+            }
+            else if (!elem.raw) {
+                if (is_msm && epoch_monitor::day_time(msm) != elem.epoch_time) {
+                    // a slow rover skips to this frame, so it starts the next buffer
+                    publish_frames(elem, m_batch, epoch);
+                    m_batch.clear();
+                    elem.epoch_time = epoch_monitor::day_time(msm);
+                    epoch = true;
+                }
+                m_batch.add(frame);
+            }
+        }
+        if (elem.bundle) {
+            if (!elem.bundle->is_open()) {
+                send_epoch(elem, false);    // frames between epochs
+            }
+            else {
+                m_next_deadline = std::min(m_next_deadline, elem.bundle->deadline());
+            }
+            return;
+        }
+        rtcm3_stats stats = elem.framer->stats();
+        if (!elem.raw && stats.frames == 0 && stats.discarded_bytes > rtcm3_framer::max_frame) {
+            elem.raw = true;    // not RTCM3, nothing to align
+        }
+        if (elem.raw) {
+            m_fan_out.publish(elem.mount, data.data(), data.size());
+            hand_over(elem, data, tag_raw);
+            return;
+        }
+        publish_frames(elem, m_batch, epoch);
+    }
+
+    std::shared_ptr<const message_filter> accept_listener::rover_filter(std::string_view query, bool& valid)
+    {
+        valid = true;
+        constexpr std::string_view key {"msg="};
+        std::string_view spec{};
+        while (!query.empty()) {
+            std::string_view param = query.substr(0, query.find('&'));
+            query.remove_prefix(std::min(query.size(), param.size() + 1));
+            if (param.substr(0, key.size()) == key) {
+                spec = param.substr(key.size());
+            }
+        }
+        if (spec.empty()) {
+            return nullptr;
         }
+        auto known = m_rover_filters.find(spec);
+        if (known != m_rover_filters.end()) {
+            if (auto filter = known->second.lock()) {
+                return filter;
+            }
+        }
+        message_filter parsed{};
+        if (!message_filter::parse(spec, parsed)) {
+            valid = false;
+            return nullptr;
+        }
+        if (m_rover_filters.size() >= 64) {
+            for (auto it = m_rover_filters.begin(); it != m_rover_filters.end(); ) {
+                it = it->second.expired() ? m_rover_filters.erase(it) : std::next(it);
+            }
+        }
+        auto filter = std::make_shared<const message_filter>(parsed);
+        m_rover_filters[std::string{spec}] = filter;
+        return filter;
+    }
+
+    void accept_listener::set_filter(const std::string& mount, std::shared_ptr<const message_filter> filter)
+    {
+        m_fan_out.set_filter(mount, std::move(filter));
+    }
+
+    void accept_listener::send_table(connection& client, bool v2)
+    {
+        auto table = m_mounts->table().get();
+        std::array<std::shared_ptr<const shared_buffer>, 2> response {
+            v2 ? table->v2_header : table->v1_header, table->body };
+        [[maybe_unused]] auto sent = client.send(response.data(), response.size());
+        client.close();
+    }
+
+    void accept_listener::OnClientDisconnected(connection& client)
+    {
+        m_fan_out.unsubscribe(client);
+        auto el = m_sessions.find(client.get_sockfd());
+        if (el == m_sessions.end()) {
+            return;
+        }
+        const session& elem = el->second;
+        if (elem.role == client_role::source) {
+            m_sources.erase(elem.mount);
+            m_mounts->remove(elem.mount);
+            if (m_fan_out.subscribers(elem.mount) > 0) {
+                m_remote.try_emplace(elem.mount);   // rovers wait for a base station on any shard
+            }
+            std::lock_guard lock(m_epochs_mutex);
+            m_epochs.erase(elem.mount);
+        }
+        else if (elem.role == client_role::rover && m_fan_out.subscribers(elem.mount) == 0) {
+            auto remote = m_remote.find(elem.mount);
+            if (remote != m_remote.end()) {
+                leave(remote->second);
+                m_remote.erase(remote);
+            }
+        }
+        m_clients.erase(client.get_sockfd());
+        m_sessions.erase(el);
+    }
+
+    std::list<std::weak_ptr<connection>> accept_listener::get_connections() const
+    {
+        std::list<std::weak_ptr<connection>> list{};
+        m_clients.snapshot().for_each([&list](const std::shared_ptr<const client>& el) {
+            list.emplace_back(el->conn);
+        });
         return list;
     }
+
+    void accept_listener::on_rover(session& elem, std::string_view data)
+    {
+        elem.sentences->feed(data.data(), data.size());
+        std::string_view sentence{};
+        while (elem.sentences->next(sentence) == io_status::Success) {
+            gga_fix fix{};
+            if (nmea::parseGGA(sentence, fix)) {
+                elem.position->set(fix);
+            }
+        }
+    }
+
+    void accept_listener::send_epoch(session& elem, bool epoch)
+    {
+        publish_frames(elem, elem.bundle->batch(), epoch);
+        elem.bundle->clear();
+    }
+
+    void accept_listener::publish_frames(session& elem, const frame_batch& frames, bool epoch)
+    {
+        if (frames.empty()) {
+            return;
+        }
+        std::string_view bytes = frames.bytes();
+        if (m_fan_out.filtered(elem.mount)) {
+            m_fan_out.publish(elem.mount, bytes.data(), bytes.size(), frames, epoch);
+        }
+        else {
+            m_fan_out.publish(elem.mount, bytes.data(), bytes.size(), epoch);
+        }
+        hand_over(elem, bytes, epoch ? tag_epoch : 0);
+    }
+
+    void accept_listener::hand_over(session& elem, std::string_view bytes, std::uint32_t tag)
+    {
+        if (!elem.feed || !elem.feed->ring || elem.feed->readers.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        if (tag == tag_raw) {
+            elem.feed->ring->publish(bytes.data(), bytes.size(), tag);
+        }
+        else {
+            static_assert(rtcm3_framer::max_frame <= spmc_ring::slot_size);
+            // every slot holds whole frames, a reader filters them without the framer
+            while (!bytes.empty()) {
+                std::size_t size = 0;
+                while (size < bytes.size() && size + frame_size(bytes.data() + size) <= spmc_ring::slot_size) {
+                    size += frame_size(bytes.data() + size);
+                }
+                elem.feed->ring->publish(bytes.data(), size, tag);
+                bytes.remove_prefix(size);
+                tag = 0;    // the epoch begins in the first slot
+            }
+        }
+        m_mounts->notify(*elem.feed);
+    }
+
+    void accept_listener::join(const std::string& mount, remote_feed& remote)
+    {
+        auto stream = m_mounts->find(mount);
+        if (!stream || stream->shard == m_shard || !stream->ring) {
+            return; // no base station yet, the registry wakes this shard up when it comes
+        }
+        stream->readers.fetch_or(std::uint64_t{1} << m_shard);
+        remote.cursor = stream->ring->subscribe();
+        remote.epochs = false;
+        remote.resync = false;
+        remote.feed = std::move(stream);
+    }
+
+    void accept_listener::leave(remote_feed& remote)
+    {
+        if (remote.feed) {
+            remote.feed->readers.fetch_and(~(std::uint64_t{1} << m_shard));
+            remote.feed = nullptr;
+        }
+    }
+
+    void accept_listener::receive_remote()
+    {
+        for (auto& [mount, remote] : m_remote) {
+            if (!remote.feed) {
+                join(mount, remote);
+            }
+            if (!remote.feed) {
+                continue;
+            }
+            // chunks published before the base station left are read to the end
+            bool closed = remote.feed->closed.load(std::memory_order_acquire);
+            std::size_t size = 0;
+            std::uint32_t tag = 0;
+            ring_status res{};
+            while ((res = remote.feed->ring->read(remote.cursor, m_chunk.data(), size, tag)) != ring_status::Empty) {
+                if (res == ring_status::Lapped) {
+                    remote.resync = remote.epochs; // a rover gets whole epochs only
+                    continue;
+                }
+                if (tag & tag_epoch) {
+                    remote.epochs = true;
+                    remote.resync = false;
+                }
+                if (!remote.resync) {
+                    deliver(mount, size, tag);
+                }
+            }
+            if (closed) {
+                leave(remote);
+                join(mount, remote);    // the next base station may be registered already
+            }
+        }
+    }
+
+    void accept_listener::deliver(const std::string& mount, std::size_t size, std::uint32_t tag)
+    {
+        bool epoch = tag & tag_epoch;
+        if (tag == tag_raw) {
+            m_fan_out.publish(mount, m_chunk.data(), size);
+        }
+        else if (!m_fan_out.filtered(mount)) {
+            m_fan_out.publish(mount, m_chunk.data(), size, epoch);
+        }
+        else {
+            m_batch.clear();
+            for (std::size_t offset = 0; offset < size; offset += frame_size(m_chunk.data() + offset)) {
+                m_batch.add(rtcm3_frame{reinterpret_cast<const std::uint8_t*>(m_chunk.data() + offset),
+                    frame_size(m_chunk.data() + offset)});
+            }
+            m_fan_out.publish(mount, m_chunk.data(), size, m_batch, epoch);
+        }
+    }
+
+    void accept_listener::check_stalls(std::chrono::steady_clock::time_point now)
+    {
+        for (const auto& [fd, elem] : m_sessions) {
+            if (elem.role != client_role::rover) {
+                continue;
+            }
+            if (auto conn = elem.conn.lock()) {
+                // closing wakes up the reactor, which drops the rover
+                conn->disconnect_stalled(now);
+            }
+        }
+        // a quarter of the timeout late at most
+        m_next_stall_check = now + std::max(m_limits.stall_timeout / 4, std::chrono::milliseconds(10));
+    }
+
+    std::chrono::steady_clock::time_point accept_listener::OnTimer(std::chrono::steady_clock::time_point now)
+    {
+        if (m_mounts->notified(m_shard)) {
+            receive_remote();
+        }
+        if (m_next_stall_check <= now) {
+            check_stalls(now);
+        }
+        if (now < m_next_deadline) {
+            return std::min(m_next_deadline, m_next_stall_check);
+        }
+        m_next_deadline = std::chrono::steady_clock::time_point::max();
+        for (const auto& [mount, fd] : m_sources) {
+            auto el = m_sessions.find(fd);
+            if (el == m_sessions.end() || !el->second.bundle || !el->second.bundle->is_open()) {
+                continue;
+            }
+            session& elem = el->second;
+            if (elem.bundle->deadline() <= now) {
+                send_epoch(elem, true);
+            }
+            else {
+                m_next_deadline = std::min(m_next_deadline, elem.bundle->deadline());
+            }
+        }
+        return std::min(m_next_deadline, m_next_stall_check);
+    }
+
+    void accept_listener::set_epoch_wait(std::chrono::milliseconds wait) noexcept
+    {
+        m_epoch_wait = wait;
+    }
+
+    std::vector<std::pair<std::string, epoch_metrics>> accept_listener::station_metrics() const
+    {
+        std::vector<std::pair<std::string, epoch_metrics>> metrics{};
+        std::lock_guard lock(m_epochs_mutex);
+        metrics.reserve(m_epochs.size());
+        for (const auto& [mount, epochs] : m_epochs) {
+            metrics.emplace_back(mount, epochs->metrics());
+        }
+        return metrics;
+    }
+
+    void accept_listener::rover_fix::set(const gga_fix& fix)
+    {
+        std::lock_guard lock(m_mutex);
+        m_fix = fix;
+    }
+
+    gga_fix accept_listener::rover_fix::get() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_fix;
+    }
+
+    registry<std::shared_ptr<const accept_listener::client>>::view accept_listener::clients() const
+    {
+        return m_clients.snapshot();
+    }
 }
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cerrno>
+
+#include "aio_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    aio_backend::aio_backend(int sockfd) noexcept
+    {
+        m_cb.aio_fildes = sockfd;
+        m_cb.aio_sigevent.sigev_notify = SIGEV_SIGNAL;
+    }
+
+    aio_backend::~aio_backend()
+    {
+        [[maybe_unused]] ssize_t res = end();
+    }
+
+    [[nodiscard]] io_status aio_backend::write(const struct iovec* iov, std::size_t count)
+    {
+        if (m_started || count > max_iov) {
+            return io_status::Error;
+        }
+        std::copy(iov, iov + count, m_iov.begin());
+        m_count = count;
+        m_first = advance(m_iov.data(), 0, m_count, 0);
+        m_sent = 0;
+        m_failed = false;
+        if (m_first < m_count) {
+            submit();
+        }
+        return m_failed ? io_status::Error : io_status::Success;
+    }
+
+    void aio_backend::submit() noexcept
+    {
+        m_cb.aio_nbytes = m_iov[m_first].iov_len;
+        m_cb.aio_offset = 0;
+        m_cb.aio_buf = m_iov[m_first].iov_base;
+        m_syscalls += 2; // hand-off to the helper thread and its write
+        if (::aio_write(&m_cb) != 0) {
+            m_failed = true;
+            return;
+        }
+        m_started = true;
+    }
+
+    void aio_backend::complete() noexcept
+    {
+        m_started = false;
+        ssize_t res = ::aio_return(&m_cb);
+        if (res < 0) {
+            m_failed = true;
+            return;
+        }
+        m_sent += res;
+        m_first = advance(m_iov.data(), m_first, m_count, res);
+        if (m_first < m_count) {
+            submit();
+        }
+    }
+
+    [[nodiscard]] io_status aio_backend::check() noexcept
+    {
+        if (m_started) {
+            int res = ::aio_error(&m_cb); // reads the control block, no system call
+            if (res == EINPROGRESS) {
+                return io_status::InProgress;
+            }
+            complete();
+        }
+        if (m_failed) {
+            return io_status::Error;
+        }
+        return m_started ? io_status::InProgress : io_status::Success;
+    }
+
+    [[nodiscard]] ssize_t aio_backend::end() noexcept
+    {
+        const struct aiocb* list[1] = { &m_cb };
+        while (m_started) {
+            while (::aio_error(&m_cb) == EINPROGRESS) {
+                ++m_syscalls;
+                ::aio_suspend(list, 1, nullptr); // the buffer is released by the caller
+            }
+            complete();
+        }
+        ssize_t res = m_failed ? -1 : static_cast<ssize_t>(m_sent);
+        m_count = 0;
+        m_first = 0;
+        m_sent = 0;
+        m_failed = false;
+        return res;
+    }
+
+    io_engine aio_backend::engine() const noexcept
+    {
+        return io_engine::posix_aio;
+    }
+}
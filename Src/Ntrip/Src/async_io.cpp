@@ -1,48 +1,153 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <stdexcept>
+#include <sys/socket.h>
+
 #include "async_io.hpp"
 
 namespace VrsTunnel::Ntrip
 {
-    async_io::async_io(int sockfd) noexcept
+    async_io::async_io(int sockfd) :
+        async_io(sockfd, io_backend::get_default())
+    { }
+
+    async_io::async_io(int sockfd, io_engine engine) :
+        m_sockfd{sockfd},
+        m_backend{io_backend::make_instance(engine, sockfd)}
+    { }
+
+    io_engine async_io::engine() const noexcept
+    {
+        return m_backend->engine();
+    }
+
+    std::uint64_t async_io::syscalls() const noexcept
     {
-        ::memset(&m_read_cb, 0, sizeof(m_read_cb));
-        m_read_cb.aio_fildes = sockfd;
-        m_read_cb.aio_sigevent.sigev_notify = SIGEV_SIGNAL;
+        return m_backend->syscalls();
     }
 
     [[nodiscard]] io_status async_io::check() noexcept
     {
-        int res = ::aio_error(&m_read_cb);
-        if (res == EINPROGRESS) {
-            return io_status::InProgress;
+        if (m_failed) {
+            return io_status::Error;
         }
-        else if (res == 0) {
-            return io_status::Success;
+        if (m_batch == 0) {
+            if (m_queue.empty()) {
+                return io_status::Success;
+            }
+            submit();
+            if (m_failed) {
+                return io_status::Error;
+            }
         }
-        else {
+        io_status res = m_backend->check();
+        if (res == io_status::InProgress) {
+            return res;
+        }
+        ssize_t written = m_backend->end();
+        if (res == io_status::Error || written < 0) {
+            m_failed = true;
             return io_status::Error;
         }
+        m_written += written;
+        m_pending -= written;
+        m_queue.erase(m_queue.begin(), m_queue.begin() + m_batch);
+        m_batch = 0;
+        if (m_queue.empty()) {
+            return io_status::Success;
+        }
+        submit();
+        return m_failed ? io_status::Error : io_status::InProgress;
     };
 
     [[nodiscard]] io_status async_io::write(const char* data, int size)
     {
-        m_data = std::make_unique<char[]>(size);
-        memcpy(m_data.get(), data, size);
-        m_read_cb.aio_nbytes = size;
-        m_read_cb.aio_offset = 0;
-        m_read_cb.aio_buf = m_data.get();
-        int res = ::aio_write(&m_read_cb);
-        if (res == 0) {
-            return io_status::Success;
+        enqueue(shared_buffer::make(data, size));
+        return flush();
+    }
+
+    [[nodiscard]] io_status async_io::write(std::shared_ptr<const shared_buffer> data)
+    {
+        enqueue(std::move(data));
+        return flush();
+    }
+
+    void async_io::enqueue(const char* data, std::size_t size)
+    {
+        m_queue.push_back(chunk{data, size, nullptr});
+        m_pending += size;
+    }
+
+    void async_io::enqueue(std::shared_ptr<const shared_buffer> data)
+    {
+        const char* bytes = data->data();
+        std::size_t size = data->size();
+        m_queue.push_back(chunk{bytes, size, std::move(data)});
+        m_pending += size;
+    }
+
+    [[nodiscard]] io_status async_io::flush() noexcept
+    {
+        if (m_failed) {
+            return io_status::Error;
         }
-        else {
+        if (m_batch == 0 && !m_queue.empty()) {
+            submit();
+        }
+        return m_failed ? io_status::Error : io_status::Success;
+    }
+
+    void async_io::submit() noexcept
+    {
+        std::array<struct iovec, io_backend::max_iov> iov{};
+        m_batch = std::min(m_queue.size(), io_backend::max_iov);
+        for (std::size_t i = 0; i < m_batch; ++i) {
+            iov[i].iov_base = const_cast<char*>(m_queue[i].data);
+            iov[i].iov_len = m_queue[i].size;
+        }
+        if (m_backend->write(iov.data(), m_batch) != io_status::Success) {
+            m_failed = true;
+        }
+    }
+
+    std::size_t async_io::pending() const noexcept
+    {
+        return m_pending;
+    }
+
+    [[nodiscard]] io_status async_io::receive(char* buffer, std::size_t capacity, std::size_t& received) noexcept
+    {
+        received = 0;
+        for (;;) {
+            ssize_t n_read = ::recv(m_sockfd, buffer, capacity, MSG_DONTWAIT);
+            if (n_read > 0) {
+                received = n_read;
+                return io_status::Success;
+            }
+            if (n_read == 0) {
+                m_eof = capacity > 0;
+                return m_eof ? io_status::Error : io_status::InProgress;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return io_status::InProgress;
+            }
             return io_status::Error;
         }
     }
 
+    bool async_io::eof() const noexcept
+    {
+        return m_eof;
+    }
+
     int async_io::available() noexcept
     {
         int n_bytes_avail = 0;
-        int res = ::ioctl(m_read_cb.aio_fildes, FIONREAD, &n_bytes_avail);
+        int res = ::ioctl(m_sockfd, FIONREAD, &n_bytes_avail);
         if (res == 0) {
             return n_bytes_avail;
         }
@@ -57,7 +162,7 @@ namespace VrsTunnel::Ntrip
     std::unique_ptr<char[]> async_io::read(int size)
     {
         auto data = std::make_unique<char[]>(size);
-        ssize_t n_read = static_cast<int>(::read(m_read_cb.aio_fildes, data.get(), size));
+        ssize_t n_read = static_cast<int>(::read(m_sockfd, data.get(), size));
         if (n_read != size) {
             throw std::runtime_error("missing data");
         }
@@ -66,9 +171,13 @@ namespace VrsTunnel::Ntrip
 
     [[nodiscard]] ssize_t async_io::end() noexcept
     {
-        if (m_data) {
-            m_data.reset();
-        }
-        return aio_return(&m_read_cb);
+        ssize_t written = m_batch > 0 ? m_backend->end() : 0;
+        ssize_t res = (m_failed || written < 0) ? -1 : m_written + written;
+        m_queue.clear();
+        m_batch = 0;
+        m_pending = 0;
+        m_written = 0;
+        m_failed = false;
+        return res;
     }
-}
\ No newline at end of file
+}
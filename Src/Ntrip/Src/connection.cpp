@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "connection.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    connection::connection(std::unique_ptr<tcp_client> client) noexcept :
+        m_tcp{std::move(client)},
+        m_activity{std::chrono::steady_clock::now()}
+    { }
+
+    int connection::get_sockfd() noexcept
+    {
+        return m_tcp->get_sockfd();
+    }
+
+    std::string_view connection::input() const noexcept
+    {
+        return std::string_view(m_input.data(), m_input_size);
+    }
+
+    void connection::consume(std::size_t size) noexcept
+    {
+        if (size >= m_input_size) {
+            m_input_size = 0;
+            return;
+        }
+        ::memmove(m_input.data(), m_input.data() + size, m_input_size - size);
+        m_input_size -= size;
+    }
+
+    [[nodiscard]] io_status connection::receive() noexcept
+    {
+        if (m_input_size == m_input.size()) {
+            return io_status::Error; // peer sends more than we can parse
+        }
+        ssize_t n_read = ::recv(m_tcp->get_sockfd(), m_input.data() + m_input_size,
+            m_input.size() - m_input_size, 0);
+        if (n_read > 0) {
+            m_input_size += n_read;
+            m_activity = std::chrono::steady_clock::now();
+            return io_status::Success;
+        }
+        if (n_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return io_status::InProgress;
+        }
+        return io_status::Error;
+    }
+
+    [[nodiscard]] io_status connection::send(const char* data, std::size_t size)
+    {
+        if (m_closing) {
+            return io_status::Error;
+        }
+        if (m_skipping) {
+            discard(size);
+            return io_status::InProgress;
+        }
+        ssize_t sent = 0;
+        if (m_output.empty()) {
+            sent = write_some(data, size);
+            if (sent < 0) {
+                return io_status::Error;
+            }
+        }
+        if (static_cast<std::size_t>(sent) < size) {
+            return enqueue(shared_buffer::make(data + sent, size - sent), 0, false);
+        }
+        return io_status::Success;
+    }
+
+    [[nodiscard]] io_status connection::send(std::shared_ptr<const shared_buffer> data, bool epoch)
+    {
+        if (m_closing) {
+            return io_status::Error;
+        }
+        if (epoch) {
+            m_epochs = true;
+            m_skipping = false;
+        }
+        if (m_skipping) {
+            discard(data->size());
+            return io_status::InProgress;
+        }
+        ssize_t sent = 0;
+        if (m_output.empty()) {
+            sent = write_some(data->data(), data->size());
+            if (sent < 0) {
+                return io_status::Error;
+            }
+        }
+        if (static_cast<std::size_t>(sent) < data->size()) {
+            return enqueue(std::move(data), sent, epoch);
+        }
+        return io_status::Success;
+    }
+
+    [[nodiscard]] io_status connection::send(const std::shared_ptr<const shared_buffer>* chunks, std::size_t count)
+    {
+        if (m_closing) {
+            return io_status::Error;
+        }
+        if (m_skipping) {
+            for (std::size_t i = 0; i < count; ++i) {
+                discard(chunks[i]->size());
+            }
+            return io_status::InProgress;
+        }
+        std::size_t first = 0;
+        std::size_t offset = 0;
+        if (m_output.empty()) {
+            ssize_t sent = write_some(chunks, count);
+            if (sent < 0) {
+                return io_status::Error;
+            }
+            offset = sent;
+            while (first < count && offset >= chunks[first]->size()) {
+                offset -= chunks[first]->size();
+                ++first;
+            }
+        }
+        io_status res = io_status::Success;
+        for (; first < count; ++first) {
+            res = enqueue(chunks[first], offset, false);
+            if (res == io_status::Error) {
+                return res;
+            }
+            offset = 0;
+        }
+        return res;
+    }
+
+    [[nodiscard]] io_status connection::enqueue(std::shared_ptr<const shared_buffer> data, std::size_t offset, bool epoch)
+    {
+        std::size_t size = data->size() - offset;
+        if (m_output.empty()) {
+            m_output_offset = offset; // the rest is sent from the same buffer
+        }
+        else if (over_limits(size)) {
+            if (!is_stalled()) {
+                m_stall_since = std::chrono::steady_clock::now();
+                ++m_stats.stalls;
+            }
+            switch (m_limits.policy)
+            {
+            case overflow_policy::drop_oldest:
+                while (m_output.size() > 1 && over_limits(size)) {
+                    drop(m_output.begin() + 1);
+                }
+                break;
+            case overflow_policy::skip_epoch:
+                while (m_output.size() > 1) {
+                    drop(m_output.begin() + 1);
+                }
+                if (m_epochs && !epoch) {
+                    // the rest of this epoch is useless without its beginning
+                    m_skipping = true;
+                    discard(size);
+                    return io_status::InProgress;
+                }
+                break;
+            case overflow_policy::disconnect:
+                discard(size);  // the connection is closed by disconnect_stalled
+                return io_status::InProgress;
+            }
+        }
+        m_output_size += size;
+        m_output.push_back(chunk{std::move(data), epoch});
+        return io_status::InProgress;
+    }
+
+    bool connection::over_limits(std::size_t size) const noexcept
+    {
+        return m_output_size + size > m_limits.high_bytes
+            || m_output.size() + 1 > m_limits.high_frames;
+    }
+
+    void connection::drop(std::deque<chunk>::iterator queued) noexcept
+    {
+        discard(queued->data->size());
+        m_output_size -= queued->data->size();
+        m_output.erase(queued);
+    }
+
+    void connection::discard(std::size_t size) noexcept
+    {
+        ++m_stats.dropped_frames;
+        m_stats.dropped_bytes += size;
+    }
+
+    [[nodiscard]] io_status connection::flush() noexcept
+    {
+        while (!m_output.empty()) {
+            const shared_buffer& head = *m_output.front().data;
+            ssize_t res = write_some(head.data() + m_output_offset, head.size() - m_output_offset);
+            if (res < 0) {
+                m_output.clear();
+                m_output_offset = 0;
+                m_output_size = 0;
+                return io_status::Error;
+            }
+            m_output_offset += res;
+            m_output_size -= res;
+            if (m_output_offset < head.size()) {
+                return io_status::InProgress;
+            }
+            m_output.pop_front();
+            m_output_offset = 0;
+            if (is_stalled() && m_output_size <= m_limits.low_bytes
+                    && m_output.size() <= m_limits.low_frames) {
+                m_stall_since = {};
+            }
+        }
+        return io_status::Success;
+    }
+
+    ssize_t connection::write_some(const char* data, std::size_t size) noexcept
+    {
+        std::size_t sent = 0;
+        while (sent < size) {
+            ssize_t res = ::send(m_tcp->get_sockfd(), data + sent, size - sent, MSG_NOSIGNAL);
+            if (res > 0) {
+                sent += res;
+                continue;
+            }
+            if (res < 0 && errno == EINTR) {
+                continue;
+            }
+            if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            m_closing = true;
+            return -1;
+        }
+        if (sent > 0) {
+            m_activity = std::chrono::steady_clock::now();
+        }
+        return sent;
+    }
+
+    ssize_t connection::write_some(const std::shared_ptr<const shared_buffer>* chunks, std::size_t count) noexcept
+    {
+        std::array<struct iovec, max_vector> iov{};
+        std::size_t n_iov = std::min(count, max_vector);
+        for (std::size_t i = 0; i < n_iov; ++i) {
+            iov[i].iov_base = const_cast<char*>(chunks[i]->data());
+            iov[i].iov_len = chunks[i]->size();
+        }
+        std::size_t sent = 0;
+        std::size_t first = 0;
+        for (;;) {
+            while (first < n_iov && iov[first].iov_len == 0) {
+                ++first;
+            }
+            if (first == n_iov) {
+                break;
+            }
+            struct msghdr msg{};
+            msg.msg_iov = iov.data() + first;
+            msg.msg_iovlen = n_iov - first;
+            ssize_t res = ::sendmsg(m_tcp->get_sockfd(), &msg, MSG_NOSIGNAL);
+            if (res > 0) {
+                sent += res;
+                std::size_t left = res;
+                while (left > 0 && left >= iov[first].iov_len) {
+                    left -= iov[first].iov_len;
+                    ++first;
+                }
+                if (left > 0) {
+                    iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+                    iov[first].iov_len -= left;
+                }
+                continue;
+            }
+            if (res < 0 && errno == EINTR) {
+                continue;
+            }
+            if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            m_closing = true;
+            return -1;
+        }
+        if (sent > 0) {
+            m_activity = std::chrono::steady_clock::now();
+        }
+        return sent;
+    }
+
+    std::size_t connection::pending() const noexcept
+    {
+        return m_output_size;
+    }
+
+    void connection::set_limits(const queue_limits& limits) noexcept
+    {
+        m_limits = limits;
+    }
+
+    queue_stats connection::stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    bool connection::is_stalled() const noexcept
+    {
+        return m_stall_since != std::chrono::steady_clock::time_point{};
+    }
+
+    bool connection::disconnect_stalled(std::chrono::steady_clock::time_point now) noexcept
+    {
+        if (m_limits.policy != overflow_policy::disconnect || !is_stalled()
+                || now - m_stall_since < m_limits.stall_timeout) {
+            return false;
+        }
+        m_output.clear();
+        m_output_offset = 0;
+        m_output_size = 0;
+        close();
+        return true;
+    }
+
+    void connection::close() noexcept
+    {
+        m_closing = true;
+        // wakes up the reactor even if the peer is silent
+        ::shutdown(m_tcp->get_sockfd(), SHUT_RD);
+    }
+
+    bool connection::is_closing() const noexcept
+    {
+        return m_closing;
+    }
+
+    std::chrono::steady_clock::time_point connection::last_activity() const noexcept
+    {
+        return m_activity;
+    }
+}
@@ -0,0 +1,50 @@
+#include "epoch_assembler.hpp"
+#include "epoch_monitor.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    epoch_assembler::epoch_assembler(std::chrono::milliseconds wait) noexcept
+        : m_wait{wait}
+    { }
+
+    bool epoch_assembler::other_epoch(const msm_header& msm) const noexcept
+    {
+        return m_open && epoch_monitor::day_time(msm) != m_time;
+    }
+
+    [[nodiscard]] io_status epoch_assembler::add(const rtcm3_frame& frame, const msm_header* msm, clock::time_point now)
+    {
+        m_batch.add(frame);
+        if (!msm) {
+            return io_status::InProgress;
+        }
+        if (!m_open) {
+            m_open = true;
+            m_time = epoch_monitor::day_time(*msm);
+            m_deadline = now + m_wait;
+        }
+        return msm->multiple ? io_status::InProgress : io_status::Success;
+    }
+
+    bool epoch_assembler::is_open() const noexcept
+    {
+        return m_open;
+    }
+
+    epoch_assembler::clock::time_point epoch_assembler::deadline() const noexcept
+    {
+        return m_open ? m_deadline : clock::time_point::max();
+    }
+
+    const frame_batch& epoch_assembler::batch() const noexcept
+    {
+        return m_batch;
+    }
+
+    void epoch_assembler::clear() noexcept
+    {
+        m_batch.clear();
+        m_open = false;
+        m_deadline = clock::time_point::max();
+    }
+}
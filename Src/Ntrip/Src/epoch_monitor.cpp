@@ -0,0 +1,101 @@
+#include <cstdlib>
+
+#include "epoch_monitor.hpp"
+
+namespace
+{
+    constexpr std::uint32_t day_ms = 86'400'000;
+    constexpr std::uint32_t glonass_offset_ms = 3 * 3'600'000 - 18'000;   // UTC(SU) + 3 h, GPS - UTC = 18 s
+    constexpr std::uint32_t beidou_offset_ms = 14'000;                     // GPS - BDT = 14 s
+
+    template<typename T>
+    void publish(std::atomic<T>& value, T v) noexcept
+    {
+        value.store(v, std::memory_order_relaxed);
+    }
+}
+
+namespace VrsTunnel::Ntrip
+{
+    std::uint32_t epoch_monitor::day_time(const msm_header& header) noexcept
+    {
+        switch (header.system) {
+        case msm_system::glonass:
+            return ((header.epoch_time & 0x7FFFFFF) + day_ms - glonass_offset_ms) % day_ms;
+        case msm_system::beidou:
+            return (header.epoch_time + beidou_offset_ms) % day_ms;
+        default:
+            return header.epoch_time % day_ms;
+        }
+    }
+
+    void epoch_monitor::add(const msm_header& header, clock::time_point arrival) noexcept
+    {
+        std::uint32_t time = day_time(header);
+        if (m_open && time != m_time) {
+            close();    // the last message of the epoch has been lost
+        }
+        if (!m_open && m_has_previous && time == m_previous_time) {
+            // some receivers clear the multiple message bit in the last message of every GNSS
+            m_open = true;
+            m_reopened = true;
+        }
+        if (!m_open) {
+            m_open = true;
+            m_time = time;
+            m_arrival = arrival;
+            m_satellites = 0;
+            m_signals = 0;
+        }
+        m_satellites += header.satellites;
+        m_signals += header.cells;
+        if (!header.multiple) {
+            close();
+        }
+    }
+
+    epoch_metrics epoch_monitor::metrics() const noexcept
+    {
+        epoch_metrics m{};
+        m.epochs = m_epochs.load(std::memory_order_relaxed);
+        m.satellites = m_last_satellites.load(std::memory_order_relaxed);
+        m.signals = m_last_signals.load(std::memory_order_relaxed);
+        m.interval_ms = m_interval_ms.load(std::memory_order_relaxed);
+        m.jitter_us = m_last_jitter_us.load(std::memory_order_relaxed);
+        m.gaps = m_gaps.load(std::memory_order_relaxed);
+        return m;
+    }
+
+    void epoch_monitor::close() noexcept
+    {
+        m_open = false;
+        publish(m_last_satellites, m_satellites);
+        publish(m_last_signals, m_signals);
+        if (m_reopened) {
+            m_reopened = false;
+            return;
+        }
+        if (m_has_previous) {
+            std::uint32_t interval = (m_time + day_ms - m_previous_time) % day_ms;
+            if (interval > 0) {
+                if (m_nominal_ms == 0 || interval < m_nominal_ms) {
+                    m_nominal_ms = interval;
+                }
+                else if (interval * 2 > m_nominal_ms * 3) {
+                    publish(m_gaps, m_gaps.load(std::memory_order_relaxed) + 1);
+                }
+                auto arrival_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    m_arrival - m_previous_arrival).count();
+                std::int64_t deviation = std::llabs(arrival_us - std::int64_t{interval} * 1000);
+                // J += (|D| - J) / 16, kept scaled by 16 to stay in integers
+                m_jitter_us += deviation - (m_jitter_us >> 4);
+                publish(m_interval_ms, interval);
+                publish(m_last_jitter_us, static_cast<std::uint32_t>(m_jitter_us >> 4));
+            }
+        }
+        m_has_previous = true;
+        m_previous_time = m_time;
+        m_previous_arrival = m_arrival;
+        publish(m_epochs, m_epochs.load(std::memory_order_relaxed) + 1);
+    }
+}
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "epoll_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    epoll_backend::epoll_backend(int sockfd) noexcept :
+        m_sockfd{sockfd}
+    { }
+
+    epoll_backend::~epoll_backend()
+    {
+        if (m_epollfd != -1) {
+            ::close(m_epollfd);
+        }
+    }
+
+    [[nodiscard]] io_status epoll_backend::write(const struct iovec* iov, std::size_t count)
+    {
+        if (count > max_iov) {
+            return io_status::Error;
+        }
+        std::copy(iov, iov + count, m_iov.begin());
+        m_count = count;
+        m_first = 0;
+        m_sent = 0;
+        m_waiting = false;
+        m_failed = false;
+        send_some();
+        return m_failed ? io_status::Error : io_status::Success;
+    }
+
+    void epoll_backend::send_some() noexcept
+    {
+        for (;;) {
+            m_first = advance(m_iov.data(), m_first, m_count, 0); // skips empty buffers
+            if (m_first == m_count) {
+                return;
+            }
+            struct msghdr msg{};
+            msg.msg_iov = m_iov.data() + m_first;
+            msg.msg_iovlen = m_count - m_first;
+            ++m_syscalls;
+            ssize_t res = ::sendmsg(m_sockfd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (res > 0) {
+                m_sent += res;
+                m_first = advance(m_iov.data(), m_first, m_count, res);
+                continue;
+            }
+            if (res < 0 && errno == EINTR) {
+                continue;
+            }
+            if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (m_epollfd == -1) {
+                    m_syscalls += 2;
+                    m_epollfd = ::epoll_create1(EPOLL_CLOEXEC);
+                    struct epoll_event ev{};
+                    ev.events = EPOLLOUT | EPOLLET;
+                    ev.data.fd = m_sockfd;
+                    if (m_epollfd == -1 || ::epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_sockfd, &ev) != 0) {
+                        m_failed = true;
+                        return;
+                    }
+                }
+                m_waiting = true;
+                return;
+            }
+            m_failed = true;
+            return;
+        }
+    }
+
+    [[nodiscard]] io_status epoll_backend::check() noexcept
+    {
+        if (m_failed) {
+            return io_status::Error;
+        }
+        if (m_waiting) {
+            struct epoll_event ev{};
+            ++m_syscalls;
+            int n = ::epoll_wait(m_epollfd, &ev, 1, 0);
+            if (n <= 0) {
+                return io_status::InProgress;
+            }
+            m_waiting = false;
+            send_some();
+            if (m_failed) {
+                return io_status::Error;
+            }
+        }
+        return m_first == m_count ? io_status::Success : io_status::InProgress;
+    }
+
+    [[nodiscard]] ssize_t epoll_backend::end() noexcept
+    {
+        ssize_t res = m_failed ? -1 : static_cast<ssize_t>(m_sent);
+        m_count = 0;
+        m_first = 0;
+        m_sent = 0;
+        m_waiting = false;
+        m_failed = false;
+        return res;
+    }
+
+    io_engine epoll_backend::engine() const noexcept
+    {
+        return io_engine::epoll;
+    }
+}
@@ -0,0 +1,164 @@
+#include <algorithm>
+
+#include "fan_out.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    void fan_out::subscribe(const std::string& mount, const std::shared_ptr<connection>& rover,
+        std::shared_ptr<const message_filter> filter)
+    {
+        unsubscribe(*rover);
+        if (filter && filter->accepts_all()) {
+            filter.reset();
+        }
+        auto& subs = m_mounts[mount];
+        if (filter) {
+            ++subs.filtered;
+        }
+        subs.list.push_back(subscriber{rover, std::move(filter)});
+        m_rovers[rover->get_sockfd()] = mount;
+    }
+
+    void fan_out::unsubscribe(connection& rover)
+    {
+        auto mount = m_rovers.find(rover.get_sockfd());
+        if (mount == m_rovers.end()) {
+            return;
+        }
+        auto subs = m_mounts.find(mount->second);
+        if (subs != m_mounts.end()) {
+            auto& list = subs->second.list;
+            for (std::size_t i = 0; i < list.size(); ) {
+                auto sub = list[i].conn.lock();
+                if (!sub || sub.get() == &rover) {
+                    remove(subs->second, i);
+                    continue;
+                }
+                ++i;
+            }
+            if (list.empty()) {
+                m_mounts.erase(subs);
+            }
+        }
+        m_rovers.erase(mount);
+    }
+
+    void fan_out::set_filter(const std::string& mount, std::shared_ptr<const message_filter> filter)
+    {
+        if (!filter || filter->accepts_all()) {
+            m_filters.erase(mount);
+            return;
+        }
+        m_filters[mount] = std::move(filter);
+    }
+
+    bool fan_out::filtered(const std::string& mount) const
+    {
+        auto subs = m_mounts.find(mount);
+        if (subs == m_mounts.end()) {
+            return false;
+        }
+        return subs->second.filtered > 0 || m_filters.find(mount) != m_filters.end();
+    }
+
+    std::size_t fan_out::publish(const std::string& mount, const char* data, std::size_t size, bool epoch)
+    {
+        if (m_mounts.find(mount) == m_mounts.end()) {
+            return 0;
+        }
+        return publish(mount, shared_buffer::make(data, size), epoch);
+    }
+
+    std::size_t fan_out::publish(const std::string& mount, const std::shared_ptr<const shared_buffer>& data,
+        bool epoch)
+    {
+        auto subs = m_mounts.find(mount);
+        if (subs == m_mounts.end()) {
+            return 0;
+        }
+        std::size_t delivered = 0;
+        auto& list = subs->second.list;
+        for (std::size_t i = 0; i < list.size(); ) {
+            auto sub = list[i].conn.lock();
+            if (sub && sub->send(data, epoch) != io_status::Error) {
+                ++delivered;
+                ++i;
+                continue;
+            }
+            // broken rover is dropped by the reactor, just forget it here
+            if (sub) {
+                m_rovers.erase(sub->get_sockfd());
+            }
+            remove(subs->second, i);
+        }
+        return delivered;
+    }
+
+    std::size_t fan_out::publish(const std::string& mount, const char* data, std::size_t size,
+        const frame_batch& frames, bool epoch)
+    {
+        auto subs = m_mounts.find(mount);
+        if (subs == m_mounts.end()) {
+            return 0;
+        }
+        auto mount_filter = m_filters.find(mount);
+        const message_filter* common = mount_filter == m_filters.end() ? nullptr : mount_filter->second.get();
+        std::shared_ptr<const shared_buffer> raw{};
+        m_selected.clear();
+        auto output = [&](const message_filter* filter) -> const std::shared_ptr<const shared_buffer>& {
+            if (!filter && !common) {
+                if (!raw) {
+                    raw = shared_buffer::make(data, size);
+                }
+                return raw;
+            }
+            auto found = std::find_if(m_selected.begin(), m_selected.end(),
+                [filter](const auto& sel) { return sel.first == filter; });
+            if (found != m_selected.end()) {
+                return found->second;
+            }
+            m_selected.emplace_back(filter, frames.select(common, filter));
+            return m_selected.back().second;
+        };
+
+        std::size_t delivered = 0;
+        auto& list = subs->second.list;
+        for (std::size_t i = 0; i < list.size(); ) {
+            auto sub = list[i].conn.lock();
+            if (sub) {
+                const auto& buffer = output(list[i].filter.get());
+                if (!buffer) {
+                    ++i; // nothing this rover wants
+                    continue;
+                }
+                if (sub->send(buffer, epoch) != io_status::Error) {
+                    ++delivered;
+                    ++i;
+                    continue;
+                }
+                m_rovers.erase(sub->get_sockfd());
+            }
+            remove(subs->second, i);
+        }
+        m_selected.clear();
+        return delivered;
+    }
+
+    std::size_t fan_out::subscribers(const std::string& mount) const
+    {
+        auto subs = m_mounts.find(mount);
+        if (subs == m_mounts.end()) {
+            return 0;
+        }
+        return subs->second.list.size();
+    }
+
+    void fan_out::remove(mount_subscribers& subs, std::size_t index)
+    {
+        if (subs.list[index].filter) {
+            --subs.filtered;
+        }
+        subs.list[index] = std::move(subs.list.back());
+        subs.list.pop_back();
+    }
+}
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "forwarder.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    forwarder::forwarder(int outfd, bool use_splice) noexcept :
+        m_outfd{outfd}
+    {
+        if (use_splice && ::pipe2(m_pipe, O_CLOEXEC) == 0) {
+            ::fcntl(m_pipe[0], F_SETPIPE_SZ, static_cast<int>(pipe_capacity));
+            m_splice = true;
+        }
+    }
+
+    forwarder::~forwarder()
+    {
+        close_pipe();
+    }
+
+    [[nodiscard]] io_status forwarder::forward(int sockfd, std::size_t& moved) noexcept
+    {
+        moved = 0;
+        int flags = ::fcntl(sockfd, F_GETFL);
+        if (flags < 0 || (!(flags & O_NONBLOCK) && ::fcntl(sockfd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+            return io_status::Error;
+        }
+        if (blocked()) {
+            io_status res = flush();
+            if (res != io_status::Success) {
+                return res; // the socket is not read until the output takes the backlog
+            }
+        }
+        if (m_splice) {
+            return forward_spliced(sockfd, moved);
+        }
+        return forward_buffered(sockfd, moved);
+    }
+
+    [[nodiscard]] io_status forwarder::forward_spliced(int sockfd, std::size_t& moved) noexcept
+    {
+        for (;;) {
+            ssize_t n = ::splice(sockfd, nullptr, m_pipe[1], nullptr, pipe_capacity,
+                SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0) {
+                m_piped += n;
+                moved += n;
+                if (drain_pipe() == io_status::Error) {
+                    return io_status::Error;
+                }
+                if (blocked()) {
+                    return io_status::Success;
+                }
+                if (!m_splice) {
+                    break; // the output refused splice, the rest goes through the buffer
+                }
+                continue;
+            }
+            if (n == 0) {
+                return io_status::Error; // end of stream
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return moved > 0 ? io_status::Success : io_status::InProgress;
+            }
+            if (errno == EINVAL || errno == ENOSYS) {
+                close_pipe();
+                break;
+            }
+            return io_status::Error;
+        }
+        std::size_t rest = 0;
+        io_status res = forward_buffered(sockfd, rest);
+        moved += rest;
+        if (res == io_status::InProgress && moved > 0) {
+            return io_status::Success;
+        }
+        return res;
+    }
+
+    [[nodiscard]] io_status forwarder::forward_buffered(int sockfd, std::size_t& moved) noexcept
+    {
+        while (!blocked()) {
+            ssize_t n = ::recv(sockfd, m_buffer.data(), m_buffer.size(), MSG_DONTWAIT);
+            if (n > 0) {
+                if (write(m_buffer.data(), n) != io_status::Success) {
+                    return io_status::Error;
+                }
+                moved += n;
+                continue;
+            }
+            if (n == 0) {
+                return io_status::Error; // end of stream
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return io_status::Error;
+        }
+        return moved > 0 ? io_status::Success : io_status::InProgress;
+    }
+
+    [[nodiscard]] io_status forwarder::drain_pipe() noexcept
+    {
+        while (m_piped > 0 && m_splice) {
+            ssize_t n = ::splice(m_pipe[0], nullptr, m_outfd, nullptr, m_piped, SPLICE_F_MOVE);
+            if (n > 0) {
+                m_piped -= n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return io_status::InProgress; // the bytes wait in the pipe
+            }
+            if (n < 0 && (errno == EINVAL || errno == ENOSYS)) {
+                m_splice = false;
+                break;
+            }
+            return io_status::Error;
+        }
+        if (m_splice || m_piped == 0) {
+            return io_status::Success;
+        }
+        // bytes already in the pipe are copied out once, ahead of the queued ones
+        std::vector<char> piped(m_piped);
+        std::size_t size = 0;
+        while (size < piped.size()) {
+            ssize_t n = ::read(m_pipe[0], piped.data() + size, piped.size() - size);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                return io_status::Error;
+            }
+            size += n;
+        }
+        m_piped = 0;
+        close_pipe();
+        piped.insert(piped.end(), m_pending.begin(), m_pending.end());
+        m_pending.swap(piped);
+        return drain_pending();
+    }
+
+    [[nodiscard]] io_status forwarder::drain_pending() noexcept
+    {
+        const char* data = m_pending.data();
+        std::size_t size = m_pending.size();
+        io_status res = write_some(data, size);
+        m_pending.erase(m_pending.begin(), m_pending.end() - size);
+        return res;
+    }
+
+    [[nodiscard]] io_status forwarder::write_some(const char*& data, std::size_t& size) noexcept
+    {
+        while (size > 0) {
+            ssize_t n = ::write(m_outfd, data, size);
+            if (n > 0) {
+                data += n;
+                size -= n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return io_status::InProgress;
+            }
+            return io_status::Error;
+        }
+        return io_status::Success;
+    }
+
+    [[nodiscard]] io_status forwarder::write(const char* data, std::size_t size) noexcept
+    {
+        if (blocked() && flush() == io_status::Error) {
+            return io_status::Error;
+        }
+        if (!blocked() && write_some(data, size) == io_status::Error) {
+            return io_status::Error;
+        }
+        m_pending.insert(m_pending.end(), data, data + size);
+        return io_status::Success;
+    }
+
+    [[nodiscard]] io_status forwarder::flush() noexcept
+    {
+        io_status res = drain_pipe();
+        if (res != io_status::Success) {
+            return res;
+        }
+        return drain_pending();
+    }
+
+    bool forwarder::blocked() const noexcept
+    {
+        return m_piped > 0 || !m_pending.empty();
+    }
+
+    bool forwarder::spliced() const noexcept
+    {
+        return m_splice;
+    }
+
+    void forwarder::close_pipe() noexcept
+    {
+        m_splice = false;
+        for (int& fd : m_pipe) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+}
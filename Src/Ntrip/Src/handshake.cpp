@@ -0,0 +1,89 @@
+#include <array>
+#include <cerrno>
+#include <poll.h>
+
+#include "handshake.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    handshake::handshake(const handshake_timeouts& timeouts) noexcept :
+        m_timeouts{timeouts}
+    { }
+
+    [[nodiscard]] io_status handshake::run(async_io& aio, int sockfd, const char* request, std::size_t size)
+    {
+        m_parser.reset();
+        m_response.clear();
+        clock::time_point deadline = clock::now() + m_timeouts.send;
+        if (aio.write(request, static_cast<int>(size)) == io_status::Error) {
+            return io_status::Error;
+        }
+
+        bool sent = false;
+        std::array<char, 1024> buffer{};
+        for (;;) {
+            if (!sent) {
+                io_status wr_res = aio.check();
+                if (wr_res == io_status::Error) {
+                    return io_status::Error;
+                }
+                if (wr_res == io_status::Success) {
+                    sent = true;
+                    deadline = clock::now() + m_timeouts.response;
+                }
+            }
+
+            std::size_t received = 0;
+            io_status rd_res = io_status::Success;
+            while ((rd_res = aio.receive(buffer.data(), buffer.size(), received)) == io_status::Success) {
+                m_response.append(buffer.data(), received);
+            }
+            io_status res = m_parser.parse(m_response);
+            if (res == io_status::Error) {
+                return res;
+            }
+            if (res == io_status::Success && sent) {
+                return res;
+            }
+            if (rd_res == io_status::Error && res != io_status::Success) {
+                return io_status::Error; // closed before the status line
+            }
+
+            clock::time_point now = clock::now();
+            if (now >= deadline) {
+                return io_status::Error;
+            }
+            // write completion is not a socket event for every backend, so it is polled
+            clock::time_point wake = sent ? deadline : std::min(deadline, now + std::chrono::milliseconds(1));
+            if (!wait(sockfd, wake)) {
+                return io_status::Error;
+            }
+        }
+    }
+
+    const response_parser& handshake::response() const noexcept
+    {
+        return m_parser;
+    }
+
+    std::string_view handshake::body() const noexcept
+    {
+        return std::string_view(m_response).substr(m_parser.size());
+    }
+
+    bool handshake::wait(int sockfd, clock::time_point deadline) noexcept
+    {
+        auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - clock::now());
+        if (left.count() <= 0) {
+            return true;
+        }
+        struct timespec ts{};
+        ts.tv_sec = left.count() / 1000000000;
+        ts.tv_nsec = left.count() % 1000000000;
+        struct pollfd pfd{};
+        pfd.fd = sockfd;
+        pfd.events = POLLIN | POLLRDHUP;
+        int res = ::ppoll(&pfd, 1, &ts, nullptr);
+        return res >= 0 || errno == EINTR;
+    }
+}
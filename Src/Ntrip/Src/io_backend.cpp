@@ -0,0 +1,80 @@
+#include <atomic>
+#include <stdexcept>
+
+#include "aio_backend.hpp"
+#include "epoll_backend.hpp"
+#include "uring_backend.hpp"
+
+namespace
+{
+    std::atomic<VrsTunnel::Ntrip::io_engine> default_engine{VrsTunnel::Ntrip::io_engine::epoll};
+}
+
+namespace VrsTunnel::Ntrip
+{
+    std::uint64_t io_backend::syscalls() const noexcept
+    {
+        return m_syscalls;
+    }
+
+    std::size_t io_backend::advance(struct iovec* iov, std::size_t first, std::size_t count,
+        std::size_t written) noexcept
+    {
+        while (first < count && written >= iov[first].iov_len) {
+            written -= iov[first].iov_len;
+            ++first;
+        }
+        if (first < count) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + written;
+            iov[first].iov_len -= written;
+        }
+        return first;
+    }
+
+    std::unique_ptr<io_backend> io_backend::make_instance(io_engine engine, int sockfd)
+    {
+        switch (engine)
+        {
+        case io_engine::posix_aio:
+            return std::make_unique<aio_backend>(sockfd);
+        case io_engine::io_uring:
+            try {
+                return std::make_unique<uring_backend>(sockfd);
+            }
+            catch (const std::runtime_error&) {
+                // kernel without io_uring or the ring is not permitted
+            }
+            [[fallthrough]];
+        case io_engine::epoll:
+        default:
+            return std::make_unique<epoll_backend>(sockfd);
+        }
+    }
+
+    void io_backend::set_default(io_engine engine) noexcept
+    {
+        default_engine.store(engine);
+    }
+
+    io_engine io_backend::get_default() noexcept
+    {
+        return default_engine.load();
+    }
+
+    bool io_backend::parse(std::string_view name, io_engine& engine) noexcept
+    {
+        if (name == "aio") {
+            engine = io_engine::posix_aio;
+        }
+        else if (name == "epoll") {
+            engine = io_engine::epoll;
+        }
+        else if (name == "uring") {
+            engine = io_engine::io_uring;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,143 @@
+#include <charconv>
+
+#include "message_filter.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    message_filter::message_filter() noexcept
+    {
+        m_allowed.set();
+    }
+
+    [[nodiscard]] bool message_filter::parse(std::string_view spec, message_filter& filter) noexcept
+    {
+        bool deny = !spec.empty() && spec.front() == '!';
+        if (deny) {
+            spec.remove_prefix(1);
+        }
+        if (spec.empty()) {
+            return false;
+        }
+        message_filter result{};
+        if (!deny) {
+            result.m_allowed.reset();
+        }
+        const char* pos = spec.data();
+        const char* end = spec.data() + spec.size();
+        for (;;) {
+            unsigned first = 0;
+            auto [next, ec] = std::from_chars(pos, end, first);
+            if (ec != std::errc{} || first >= message_types) {
+                return false;
+            }
+            unsigned last = first;
+            if (next != end && *next == '-') {
+                auto [range_end, range_ec] = std::from_chars(next + 1, end, last);
+                if (range_ec != std::errc{} || last >= message_types || last < first) {
+                    return false;
+                }
+                next = range_end;
+            }
+            if (deny) {
+                result.deny(static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(last));
+            }
+            else {
+                result.allow(static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(last));
+            }
+            if (next == end) {
+                break;
+            }
+            if (*next != ',') {
+                return false;
+            }
+            pos = next + 1;
+        }
+        filter = result;
+        return true;
+    }
+
+    void message_filter::allow(std::uint16_t first, std::uint16_t last) noexcept
+    {
+        for (std::size_t t = first; t <= last && t < message_types; ++t) {
+            m_allowed.set(t);
+        }
+    }
+
+    void message_filter::deny(std::uint16_t first, std::uint16_t last) noexcept
+    {
+        for (std::size_t t = first; t <= last && t < message_types; ++t) {
+            m_allowed.reset(t);
+        }
+    }
+
+    bool message_filter::accepts(std::uint16_t type) const noexcept
+    {
+        return m_allowed.test(type & (message_types - 1));
+    }
+
+    bool message_filter::accepts_all() const noexcept
+    {
+        return m_allowed.all();
+    }
+
+    void message_stats::count(std::uint16_t type, std::size_t size) noexcept
+    {
+        // single writer, relaxed load and store avoid locked increments
+        counter& c = m_counters[type & (message_filter::message_types - 1)];
+        c.frames.store(c.frames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        c.bytes.store(c.bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    }
+
+    std::uint64_t message_stats::frames(std::uint16_t type) const noexcept
+    {
+        return m_counters[type & (message_filter::message_types - 1)].frames.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t message_stats::bytes(std::uint16_t type) const noexcept
+    {
+        return m_counters[type & (message_filter::message_types - 1)].bytes.load(std::memory_order_relaxed);
+    }
+
+    void frame_batch::clear() noexcept
+    {
+        m_bytes.clear();
+        m_entries.clear();
+    }
+
+    void frame_batch::add(const rtcm3_frame& frame)
+    {
+        m_entries.push_back(entry{static_cast<std::uint32_t>(m_bytes.size()),
+            static_cast<std::uint16_t>(frame.size), frame.message_type()});
+        const char* data = reinterpret_cast<const char*>(frame.data);
+        m_bytes.insert(m_bytes.end(), data, data + frame.size);
+    }
+
+    bool frame_batch::empty() const noexcept
+    {
+        return m_entries.empty();
+    }
+
+    std::string_view frame_batch::bytes() const noexcept
+    {
+        return std::string_view{m_bytes.data(), m_bytes.size()};
+    }
+
+    std::shared_ptr<const shared_buffer> frame_batch::select(const message_filter* first,
+        const message_filter* second) const
+    {
+        if (!first && !second) {
+            return m_bytes.empty() ? nullptr : shared_buffer::make(m_bytes.data(), m_bytes.size());
+        }
+        m_selected.clear();
+        for (const auto& e : m_entries) {
+            if ((first && !first->accepts(e.type)) || (second && !second->accepts(e.type))) {
+                continue;
+            }
+            m_selected.insert(m_selected.end(), m_bytes.data() + e.offset, m_bytes.data() + e.offset + e.size);
+        }
+        if (m_selected.empty()) {
+            return nullptr;
+        }
+        return shared_buffer::make(m_selected.data(), m_selected.size());
+    }
+}
@@ -0,0 +1,106 @@
+#include <stdexcept>
+
+#include "mount_registry.hpp"
+#include "reactor.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    mount_registry::feed::feed(std::size_t owner, bool shared) :
+        shard{owner},
+        ring{shared ? std::make_unique<spmc_ring>(ring_capacity) : nullptr}
+    { }
+
+    mount_registry::mount_registry(std::size_t shards) :
+        m_shards{shards},
+        m_state{std::make_unique<shard_state[]>(shards)}
+    {
+        if (shards == 0 || shards > max_shards) {
+            throw std::runtime_error("wrong number of shards");
+        }
+    }
+
+    std::size_t mount_registry::shards() const noexcept
+    {
+        return m_shards;
+    }
+
+    std::shared_ptr<mount_registry::feed> mount_registry::add(std::string_view mount, std::size_t shard,
+        std::string_view str)
+    {
+        auto stream = std::make_shared<feed>(shard, m_shards > 1);
+        {
+            std::scoped_lock sl(m_mutex);
+            if (!m_mounts.emplace(mount, stream).second) {
+                return nullptr;
+            }
+            m_table.add(mount, str);
+        }
+        // rovers of a base station which has just left wait for the next one
+        for (std::size_t s = 0; s < m_shards; ++s) {
+            if (s != shard) {
+                wake(s);
+            }
+        }
+        return stream;
+    }
+
+    void mount_registry::remove(std::string_view mount)
+    {
+        std::shared_ptr<feed> stream{};
+        {
+            std::scoped_lock sl(m_mutex);
+            auto found = m_mounts.find(mount);
+            if (found == m_mounts.end()) {
+                return;
+            }
+            stream = std::move(found->second);
+            m_mounts.erase(found);
+            m_table.remove(mount);
+        }
+        stream->closed.store(true, std::memory_order_release);
+        notify(*stream);
+    }
+
+    std::shared_ptr<mount_registry::feed> mount_registry::find(std::string_view mount) const
+    {
+        std::scoped_lock sl(m_mutex);
+        auto found = m_mounts.find(mount);
+        return found == m_mounts.end() ? nullptr : found->second;
+    }
+
+    sourcetable& mount_registry::table() noexcept
+    {
+        return m_table;
+    }
+
+    void mount_registry::attach(std::size_t shard, reactor& loop) noexcept
+    {
+        m_state[shard].loop.store(&loop, std::memory_order_release);
+        loop.wake(); // notifications sent before the reactor started
+    }
+
+    void mount_registry::notify(const feed& stream) noexcept
+    {
+        std::uint64_t readers = stream.readers.load(std::memory_order_acquire);
+        for (std::size_t shard = 0; readers != 0; ++shard, readers >>= 1) {
+            if (readers & 1) {
+                wake(shard);
+            }
+        }
+    }
+
+    bool mount_registry::notified(std::size_t shard) noexcept
+    {
+        return m_state[shard].pending.exchange(false);
+    }
+
+    void mount_registry::wake(std::size_t shard) noexcept
+    {
+        if (m_state[shard].pending.exchange(true)) {
+            return;
+        }
+        if (reactor* loop = m_state[shard].loop.load(std::memory_order_acquire)) {
+            loop->wake();
+        }
+    }
+}
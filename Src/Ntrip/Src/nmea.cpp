@@ -1,62 +1,329 @@
 #include <string>
-#include <cinttypes>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 
 #include "nmea.hpp"
 
+namespace
+{
+    constexpr std::size_t gga_fields = 14;
+
+    /**
+     * @return 0-15, negative if the character is not a hex digit
+     */
+    int hex_value(char c) noexcept
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        return -1;
+    }
+
+    /**
+     * Splits comma separated fields, the ones after the last slot stay in it
+     * @return number of fields found
+     */
+    std::size_t split(std::string_view data, std::array<std::string_view, gga_fields>& fields) noexcept
+    {
+        std::size_t count = 0;
+        while (count < fields.size() - 1) {
+            auto comma = static_cast<const char*>(std::memchr(data.data(), ',', data.size()));
+            if (!comma) {
+                break;
+            }
+            std::size_t len = static_cast<std::size_t>(comma - data.data());
+            fields[count++] = data.substr(0, len);
+            data.remove_prefix(len + 1);
+        }
+        fields[count++] = data;
+        return count;
+    }
+
+    /**
+     * @return false unless the whole field is a finite number
+     */
+    template<typename T>
+    bool parse_number(std::string_view field, T& value) noexcept
+    {
+        const char* end = field.data() + field.size();
+        auto [ptr, ec] = std::from_chars(field.data(), end, value);
+        if constexpr (std::is_floating_point_v<T>) {
+            if (ec == std::errc{} && !std::isfinite(value)) {
+                return false;
+            }
+        }
+        return ec == std::errc{} && ptr == end && !field.empty();
+    }
+
+    /**
+     * Parses dddmm.mmmm
+     * @param degree_digits 2 for latitude, 3 for longitude
+     * @param degrees positive value in degrees
+     */
+    bool parse_coordinate(std::string_view field, std::size_t degree_digits, double& degrees) noexcept
+    {
+        unsigned whole = 0;
+        double minutes = 0;
+        if (field.size() < degree_digits + 2 || field[degree_digits] == '-' || field[0] == '-'
+                || !parse_number(field.substr(0, degree_digits), whole)
+                || !parse_number(field.substr(degree_digits), minutes) || minutes >= 60) {
+            return false;
+        }
+        degrees = whole + minutes / 60;
+        return true;
+    }
+
+    constexpr double max_elevation = 1e9;   /**< Meters, formatGGA keeps the millimeters in 64 bits */
+
+    /**
+     * Appends the fields of a sentence and XORs every byte after '$' into the checksum
+     */
+    class sentence_writer
+    {
+    public:
+        explicit sentence_writer(char* buffer) noexcept : m_begin{buffer}, m_pos{buffer} { }
+
+        /**
+         * The checksum covers the bytes written from now on
+         */
+        void begin_checksum() noexcept
+        {
+            m_sum = 0;
+        }
+
+        void put(char c) noexcept
+        {
+            *m_pos++ = c;
+            m_sum ^= static_cast<std::uint8_t>(c);
+        }
+
+        void put(std::string_view text) noexcept
+        {
+            for (char c : text) {
+                put(c);
+            }
+        }
+
+        /**
+         * Zero padded decimal of the fixed width
+         */
+        void digits(std::uint64_t value, int width) noexcept
+        {
+            char* end = m_pos + width;
+            for (char* p = end; p != m_pos; value /= 10) {
+                *--p = static_cast<char>('0' + value % 10);
+                m_sum ^= static_cast<std::uint8_t>(*p);
+            }
+            m_pos = end;
+        }
+
+        /**
+         * Writes |degrees| as DDMM.MMMMMMMM or DDDMM.MMMMMMMM, rounded in units of 1e-8 minute
+         */
+        void coordinate(double degrees, int degree_digits) noexcept
+        {
+            constexpr std::uint64_t units = 100'000'000;    // per minute
+            auto total = static_cast<std::uint64_t>(std::llround(std::fabs(degrees) * 60 * units));
+            digits(total / (60 * units), degree_digits);
+            std::uint64_t rest = total % (60 * units);
+            digits(rest / units, 2);
+            put('.');
+            digits(rest % units, 8);
+        }
+
+        /**
+         * Writes the value with three decimals
+         */
+        void fixed3(double value) noexcept
+        {
+            std::int64_t millis = std::llround(value * 1000);
+            if (millis < 0) {
+                put('-');
+                millis = -millis;
+            }
+            char* start = m_pos;
+            m_pos = std::to_chars(m_pos, m_pos + 20, millis / 1000).ptr;
+            for (char* p = start; p != m_pos; ++p) {
+                m_sum ^= static_cast<std::uint8_t>(*p);
+            }
+            put('.');
+            digits(static_cast<std::uint64_t>(millis % 1000), 3);
+        }
+
+        /**
+         * Appends the checksum and the line end
+         * @return sentence length
+         */
+        std::size_t finish() noexcept
+        {
+            constexpr char hex[] = "0123456789ABCDEF";
+            *m_pos++ = '*';
+            *m_pos++ = hex[m_sum >> 4];
+            *m_pos++ = hex[m_sum & 0xF];
+            *m_pos++ = '\r';
+            *m_pos++ = '\n';
+            return static_cast<std::size_t>(m_pos - m_begin);
+        }
+
+    private:
+        char* m_begin;
+        char* m_pos;
+        std::uint8_t m_sum{0};
+    };
+
+    /**
+     * Parses hhmmss.ss
+     */
+    bool parse_time(std::string_view field, std::chrono::milliseconds& time) noexcept
+    {
+        unsigned hours = 0;
+        unsigned minutes = 0;
+        double seconds = 0;
+        if (field.size() < 6 || field[4] == '-'
+                || !parse_number(field.substr(0, 2), hours) || hours > 23
+                || !parse_number(field.substr(2, 2), minutes) || minutes > 59
+                || !parse_number(field.substr(4), seconds) || seconds >= 61) {
+            return false;
+        }
+        auto ms = static_cast<std::int64_t>(seconds * 1000 + 0.5);
+        time = std::chrono::milliseconds((hours * 60 + minutes) * 60000 + ms);
+        return true;
+    }
+}
+
 
 namespace VrsTunnel::Ntrip
 {
     uint8_t nmea::checksum(std::string_view data) {
-        int len = data.length();
-        uint8_t checksum = data[0];
-        for(int i = 1; i < len; ++i) {
-            checksum ^= data[i];
+        // XOR is bytewise, so eight bytes are folded at once and the word is reduced at the end
+        const char* p = data.data();
+        std::size_t len = data.length();
+        std::uint64_t words = 0;
+        for (; len >= sizeof(words); p += sizeof(words), len -= sizeof(words)) {
+            std::uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            words ^= word;
+        }
+        words ^= words >> 32;
+        words ^= words >> 16;
+        words ^= words >> 8;
+        uint8_t checksum = static_cast<uint8_t>(words);
+        for (; len > 0; ++p, --len) {
+            checksum ^= static_cast<uint8_t>(*p);
         }
         return checksum;
     }
 
+    [[nodiscard]] bool nmea::parseGGA(std::string_view sentence, gga_fix& fix) noexcept {
+        while (!sentence.empty() && (sentence.back() == '\n' || sentence.back() == '\r')) {
+            sentence.remove_suffix(1);
+        }
+        // $ttGGA,...*hh
+        std::size_t size = sentence.size();
+        auto is_upper = [](char c) { return c >= 'A' && c <= 'Z'; };
+        if (size < 10 || sentence[0] != '$' || !is_upper(sentence[1]) || !is_upper(sentence[2])
+                || sentence[size - 3] != '*' || sentence.compare(3, 4, "GGA,") != 0) {
+            return false;
+        }
+        int sum = hex_value(sentence[size - 2]) << 4 | hex_value(sentence[size - 1]);
+        std::string_view body = sentence.substr(1, size - 4);
+        if (sum < 0 || sum != checksum(body)) {
+            return false;
+        }
+
+        // time, latitude, N/S, longitude, E/W, quality, satellites, HDOP, altitude, M, separation, M, age, station
+        std::array<std::string_view, gga_fields> fields{};
+        std::size_t count = split(body.substr(6), fields);
+        if (count < 9) {
+            return false;
+        }
+        gga_fix parsed{};
+        double latitude = 0;
+        double longitude = 0;
+        unsigned quality = 0;
+        unsigned satellites = 0;
+        if (!parse_number(fields[5], quality) || quality == 0 || quality > 9
+                || !parse_coordinate(fields[1], 2, latitude) || latitude > 90
+                || !parse_coordinate(fields[3], 3, longitude) || longitude > 180
+                || !parse_time(fields[0], parsed.time)
+                || (!fields[6].empty() && !parse_number(fields[6], satellites))
+                || (!fields[7].empty() && !parse_number(fields[7], parsed.hdop))
+                || (!fields[8].empty() && !parse_number(fields[8], parsed.position.Elevation))) {
+            return false;
+        }
+        if (fields[2] == "S") {
+            latitude = -latitude;
+        }
+        else if (fields[2] != "N") {
+            return false;
+        }
+        if (fields[4] == "W") {
+            longitude = -longitude;
+        }
+        else if (fields[4] != "E") {
+            return false;
+        }
+        parsed.position.Latitude = latitude;
+        parsed.position.Longitude = longitude;
+        parsed.quality = static_cast<std::uint8_t>(quality);
+        parsed.satellites = static_cast<std::uint8_t>(std::min(satellites, 255U));
+        fix = parsed;
+        return true;
+    }
+
     [[nodiscard]] std::variant<std::string, nmea::ErrorCode>
     nmea::getGGA(location location, std::chrono::system_clock::time_point time) {
-        constexpr int bsize = 256;
-        char buf[bsize] = { 0 };
-        auto span = time.time_since_epoch();
+        char gga[max_gga];
+        std::size_t size = formatGGA(location, time, gga, sizeof(gga));
+        if (size == 0) {
+            return nmea::ErrorCode::Undefined;
+        }
+        return std::string(gga, size);
+    }
 
+    [[nodiscard]] std::size_t nmea::formatGGA(location location, std::chrono::system_clock::time_point time,
+        char* buffer, std::size_t size) noexcept {
+        if (size < max_gga || !(std::fabs(location.Elevation) < max_elevation)
+                || !(std::fabs(location.Latitude) <= 90) || !(std::fabs(location.Longitude) <= 180)) {
+            return 0;
+        }
         using namespace std;
+        auto span = time.time_since_epoch();
         using chrono_days = chrono::duration<long, std::ratio<86400>>;
         chrono_days days = chrono::duration_cast<chrono_days>(span);
         chrono::hours hours = chrono::duration_cast<chrono::hours>(span -= days);
         chrono::minutes minutes = chrono::duration_cast<chrono::minutes>(span -= hours);
         chrono::seconds seconds = chrono::duration_cast<chrono::seconds>(span -= minutes);
         chrono::milliseconds milliseconds = chrono::duration_cast<chrono::milliseconds>(span -= seconds);
-        int centiseconds = milliseconds.count() / 10;
-
-        const char* NS = "N";
-        if (location.Latitude < 0) {
-            NS = "S";
-            location.Latitude = -location.Latitude;
-        }
-        const char* EW = "E";
-        if (location.Longitude < 0) {
-            EW = "W";
-            location.Longitude = -location.Longitude;
-        }
-
-        int print_res = snprintf(buf, bsize, "GPGGA,%02" PRId64 "%02" PRId64 "%02" PRId64 ".%02d,%02d%011.8f,%s,%03d%011.8f,%s,4,12,0.9,%.3f,M,%.3f,M,0,0000", 
-            hours.count(), minutes.count(), seconds.count(), centiseconds,
-            static_cast<int>(location.Latitude), (location.Latitude - static_cast<int>(location.Latitude))*60, NS,
-            static_cast<int>(location.Longitude), (location.Longitude - static_cast<int>(location.Longitude))*60, EW,
-            location.Elevation, location.Elevation);
-
-        if(print_res < 0) {
-            return nmea::ErrorCode::Undefined;
-        }
-
-        char gga[bsize] = { 0 };
-        print_res = snprintf(gga, bsize, "$%s*%X\r\n", buf, nmea::checksum(std::string{buf}));
-        if(print_res < 0) {
-            return nmea::ErrorCode::Undefined;
-        }
 
-        return gga;
+        sentence_writer out{buffer};
+        out.put('$');
+        out.begin_checksum();
+        out.put("GPGGA,");
+        out.digits(static_cast<std::uint64_t>(hours.count()), 2);
+        out.digits(static_cast<std::uint64_t>(minutes.count()), 2);
+        out.digits(static_cast<std::uint64_t>(seconds.count()), 2);
+        out.put('.');
+        out.digits(static_cast<std::uint64_t>(milliseconds.count() / 10), 2);
+        out.put(',');
+        out.coordinate(location.Latitude, 2);
+        out.put(location.Latitude < 0 ? ",S," : ",N,");
+        out.coordinate(location.Longitude, 3);
+        out.put(location.Longitude < 0 ? ",W," : ",E,");
+        out.put("4,12,0.9,");
+        out.fixed3(location.Elevation);
+        out.put(",M,");
+        out.fixed3(location.Elevation);
+        out.put(",M,0,0000");
+        return out.finish();
     }
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <cstring>
+
+#include "nmea_framer.hpp"
+
+namespace
+{
+    std::string_view trim_line_end(const char* data, std::size_t size) noexcept
+    {
+        while (size > 0 && (data[size - 1] == '\n' || data[size - 1] == '\r')) {
+            --size;
+        }
+        return std::string_view{data, size};
+    }
+}
+
+namespace VrsTunnel::Ntrip
+{
+    void nmea_framer::feed(const char* data, std::size_t size) noexcept
+    {
+        m_input = data;
+        m_input_size = size;
+    }
+
+    [[nodiscard]] io_status nmea_framer::next(std::string_view& sentence) noexcept
+    {
+        for (;;) {
+            if (m_input_size == 0) {
+                return io_status::InProgress;
+            }
+            auto line_end = static_cast<const char*>(std::memchr(m_input, '\n', m_input_size));
+            std::size_t take = line_end ? static_cast<std::size_t>(line_end - m_input) + 1 : m_input_size;
+
+            if (m_overlong) {
+                // the line did not fit, everything up to its end is dropped
+                m_stats.discarded_bytes += take;
+                m_input += take;
+                m_input_size -= take;
+                m_overlong = line_end == nullptr;
+                continue;
+            }
+
+            if (m_partial_size > 0) {
+                if (m_partial_size + take > max_sentence) {
+                    m_stats.discarded_bytes += m_partial_size;
+                    m_partial_size = 0;
+                    m_overlong = true;
+                    continue;
+                }
+                std::memcpy(m_partial.data() + m_partial_size, m_input, take);
+                m_partial_size += take;
+                m_input += take;
+                m_input_size -= take;
+                if (!line_end) {
+                    return io_status::InProgress;
+                }
+                sentence = trim_line_end(m_partial.data(), m_partial_size);
+                m_partial_size = 0; // storage is reused only after the caller is done with the sentence
+                ++m_stats.sentences;
+                return io_status::Success;
+            }
+
+            auto start = static_cast<const char*>(std::memchr(m_input, '$', take));
+            if (!start) {
+                m_stats.discarded_bytes += take;
+                m_input += take;
+                m_input_size -= take;
+                continue;
+            }
+            std::size_t skip = static_cast<std::size_t>(start - m_input);
+            m_stats.discarded_bytes += skip;
+            m_input += skip;
+            m_input_size -= skip;
+            take -= skip;
+            if (take > max_sentence) {
+                m_stats.discarded_bytes += take;
+                m_input += take;
+                m_input_size -= take;
+                m_overlong = line_end == nullptr;
+                continue;
+            }
+            if (!line_end) {
+                // the sentence continues in the next buffer
+                std::memcpy(m_partial.data(), m_input, take);
+                m_partial_size = take;
+                m_input_size = 0;
+                return io_status::InProgress;
+            }
+            sentence = trim_line_end(m_input, take);
+            m_input += take;
+            m_input_size -= take;
+            ++m_stats.sentences;
+            return io_status::Success;
+        }
+    }
+
+    void nmea_framer::reset() noexcept
+    {
+        m_input = nullptr;
+        m_input_size = 0;
+        m_partial_size = 0;
+        m_overlong = false;
+    }
+
+    nmea_stats nmea_framer::stats() const noexcept
+    {
+        return m_stats;
+    }
+}
@@ -1,9 +1,14 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include <memory>
+#include <poll.h>
 
 #include "ntrip_client.hpp"
 #include "login_encode.hpp"
 #include "nmea.hpp"
 #include "mount_point.hpp"
+#include "handshake.hpp"
 
 namespace VrsTunnel::Ntrip
 {
@@ -30,8 +35,9 @@ namespace VrsTunnel::Ntrip
     ntrip_client::getMountPoints(std::string address, int tcpPort, 
             std::string name, std::string password)
     {
+        handshake_timeouts timeouts{};
         tcp_client tc{};
-        auto con_res = tc.connect(address, tcpPort);
+        auto con_res = tc.connect(address, tcpPort, timeouts.connect, timeouts.attempt_delay);
         if (con_res != io_status::Success) {
             return con_res;
         }
@@ -45,18 +51,27 @@ namespace VrsTunnel::Ntrip
         }
 
         std::string responseRaw{};
-        for(int i = 0; i < 50; i++) { // 5 seconds timeout
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            auto avail = aio.available();
-            if (avail < 0) {
-                return io_status::Error;
+        std::array<char, receive_chunk> buffer{};
+        auto deadline = std::chrono::steady_clock::now() + timeouts.send + timeouts.response;
+        for (;;) {
+            std::size_t received = 0;
+            io_status rd_res = io_status::Success;
+            while ((rd_res = aio.receive(buffer.data(), buffer.size(), received)) == io_status::Success) {
+                responseRaw.append(buffer.data(), received);
+            }
+            if (rd_res == io_status::Error || this->hasTableEnding(responseRaw)) {
+                break; // the caster may close the connection after the table
             }
-            else if (avail > 0) {
-                auto chunk = aio.read(avail);
-                responseRaw.append(chunk.get(), avail);
-                if (this->hasTableEnding(responseRaw)) {
-                    break;
-                }
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                break;
+            }
+            struct pollfd pfd{};
+            pfd.fd = tc.get_sockfd();
+            pfd.events = POLLIN | POLLRDHUP;
+            if (::poll(&pfd, 1, static_cast<int>(left.count()) + 1) < 0 && errno != EINTR) {
+                break;
             }
         }
         int end_res = aio.end();
@@ -89,7 +104,8 @@ namespace VrsTunnel::Ntrip
             throw std::runtime_error("tcp connection already created");
         }
         m_tcp = std::make_unique<tcp_client>();
-        auto con_res = m_tcp->connect(nlogin.address, nlogin.port);
+        auto con_res = m_tcp->connect(nlogin.address, nlogin.port,
+            nlogin.timeouts.connect, nlogin.timeouts.attempt_delay);
         if (con_res != io_status::Success) {
             m_tcp.reset();
             m_status = status::error;
@@ -97,34 +113,10 @@ namespace VrsTunnel::Ntrip
         }
         m_aio = std::make_unique<async_io>(m_tcp->get_sockfd());
         std::unique_ptr<char[]> request = build_request(nlogin.mountpoint.data(), nlogin.username, nlogin.password);
-        auto res = m_aio->write(request.get(), strlen(request.get()));
-        if (res != io_status::Success) {
-            m_status = status::error;
-            return m_status;
-        }
 
         // read authentication result
-        std::string responseText{};
-        for(int i = 1; i < 50; ++i) { // 5 second timeout
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            auto avail = m_aio->available();
-            if (avail < 0) {
-                m_status = status::error;
-                return m_status;
-            }
-            else if (avail > 0) {
-                auto chunk = m_aio->read(avail);
-                responseText.append(chunk.get(), avail);
-                const std::string ending {"\r\n\r\n"};
-                if (responseText.length() >= ending.length()) {
-                    if (responseText.compare(responseText.length() - ending.length(),
-                                ending.length(), ending) == 0) {
-                        break;
-                    }
-                }
-            }
-        }
-        if (m_aio->check() != io_status::Success) {
+        handshake hs{nlogin.timeouts};
+        if (hs.run(*m_aio, m_tcp->get_sockfd(), request.get(), strlen(request.get())) != io_status::Success) {
             m_status = status::error;
             return m_status;
         }
@@ -133,47 +125,80 @@ namespace VrsTunnel::Ntrip
             m_status = status::error;
             return m_status;
         }
+        m_body.assign(hs.body());
 
-        auto startsWith = [text = &responseText](std::string_view start) -> bool
+        switch (hs.response().code())
         {
-            if (start.size() > text->size()) {
-                return false;
-            }
-            return text->compare(0, start.size(), start) == 0;
-        };
-
-        if (startsWith("ICY 200 OK\r\n")) {
-            m_status = status::ready;
-        }
-        else if (startsWith("HTTP/1.1 401 Unauthorized\r\n")) {
+        case 200:
+            m_status = hs.response().protocol() == response_protocol::sourcetable
+                ? status::nomount : status::ready;
+            break;
+        case 401:
             m_status = status::authfailure;
-        } 
-        else if (startsWith("HTTP/1.1 404 Not Found\r\n")) {
+            break;
+        case 404:
             m_status = status::nomount;
-        } 
-        else {
+            break;
+        default:
             m_status = status::error;
+            break;
         }
         return m_status;
     }
 
+    int ntrip_client::get_sockfd() const noexcept
+    {
+        return m_tcp ? m_tcp->get_sockfd() : -1;
+    }
+
     int ntrip_client::available()
     {
+        if (!m_body.empty()) {
+            return static_cast<int>(m_body.size());
+        }
         return m_aio->available();
     }
 
     std::unique_ptr<char[]> ntrip_client::receive(int size)
     {
+        if (!m_body.empty()) {
+            if (static_cast<std::size_t>(size) > m_body.size()) {
+                throw std::runtime_error("read error");
+            }
+            auto data = std::make_unique<char[]>(size);
+            ::memcpy(data.get(), m_body.data(), size);
+            m_body.erase(0, size);
+            return data;
+        }
         return m_aio->read(size);
     }
 
+    [[nodiscard]] io_status ntrip_client::receive(char* buffer, std::size_t capacity, std::size_t& received) noexcept
+    {
+        if (!m_aio) {
+            received = 0;
+            return io_status::Error;
+        }
+        if (!m_body.empty()) {
+            received = std::min(capacity, m_body.size());
+            ::memcpy(buffer, m_body.data(), received);
+            m_body.erase(0, received);
+            return io_status::Success;
+        }
+        return m_aio->receive(buffer, capacity, received);
+    }
+
     [[nodiscard]] io_status ntrip_client::send_gga_begin(location location, std::chrono::system_clock::time_point time)
     {
         if (!m_aio) {
             throw std::runtime_error("no tcp connection");
         }
-        std::string gga = std::get<std::string>(nmea::getGGA(location, time));
-        return m_aio->write(gga.c_str(), gga.length());
+        char gga[nmea::max_gga];
+        std::size_t size = nmea::formatGGA(location, time, gga, sizeof(gga));
+        if (size == 0) {
+            return io_status::Error;
+        }
+        return m_aio->write(gga, static_cast<int>(size));
     }
 
     [[nodiscard]] status ntrip_client::get_status()
@@ -211,6 +236,7 @@ namespace VrsTunnel::Ntrip
         }
         [[maybe_unused]] ssize_t res = m_aio->end();
         m_tcp->close();
+        m_body.clear();
         m_status = status::uninitialized;
     }
 
@@ -1,5 +1,9 @@
+#include <cstdio>
+
 #include "ntrip_server.hpp"
 #include "login_encode.hpp"
+#include "handshake.hpp"
+#include "stream_profile.hpp"
 
 namespace VrsTunnel::Ntrip
 {
@@ -9,7 +13,8 @@ namespace VrsTunnel::Ntrip
             throw std::runtime_error("tcp connection already created");
         }
         m_tcp = std::make_unique<tcp_client>();
-        auto con_res = m_tcp->connect(nlogin.address, nlogin.port);
+        auto con_res = m_tcp->connect(nlogin.address, nlogin.port,
+            nlogin.timeouts.connect, nlogin.timeouts.attempt_delay);
         if (con_res != io_status::Success) {
             m_tcp.reset();
             m_status = status::error;
@@ -17,34 +22,10 @@ namespace VrsTunnel::Ntrip
         }
         m_aio = std::make_unique<async_io>(m_tcp->get_sockfd());
         std::unique_ptr<char[]> request = this->build_request(nlogin);
-        auto res = m_aio->write(request.get(), strlen(request.get()));
-        if (res != io_status::Success) {
-            m_status = status::error;
-            return m_status;
-        }
 
         // read authentication result
-        std::string responseText{};
-        for(int i = 1; i < 50; ++i) { // 5 second timeout
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            auto avail = m_aio->available();
-            if (avail < 0) {
-                m_status = status::error;
-                return m_status;
-            }
-            else if (avail > 0) {
-                auto chunk = m_aio->read(avail);
-                responseText.append(chunk.get(), avail);
-                const std::string ending {"\r\n\r\n"};
-                if (responseText.length() >= ending.length()) {
-                    if (responseText.compare(responseText.length() - ending.length(),
-                                ending.length(), ending) == 0) {
-                        break;
-                    }
-                }
-            }
-        }
-        if (m_aio->check() != io_status::Success) {
+        handshake hs{nlogin.timeouts};
+        if (hs.run(*m_aio, m_tcp->get_sockfd(), request.get(), strlen(request.get())) != io_status::Success) {
             m_status = status::error;
             return m_status;
         }
@@ -54,40 +35,40 @@ namespace VrsTunnel::Ntrip
             return m_status;
         }
 
-        auto startsWith = [text = &responseText](std::string_view start) -> bool
+        switch (hs.response().code())
         {
-            if (start.size() > text->size()) {
-                return false;
-            }
-            return text->compare(0, start.size(), start) == 0;
-        };
-
-        if (startsWith("HTTP/1.1 200 OK\r\n")) {
+        case 200:
             m_status = status::ready;
-        }
-        else if (startsWith("HTTP/1.1 401 Unauthorized\r\n")) {
+            break;
+        case 401:
             m_status = status::authfailure;
-        } 
-        else if (startsWith("HTTP/1.1 404 Not Found\r\n")) {
+            break;
+        case 404:
             m_status = status::nomount;
-        } 
-        else {
+            break;
+        default:
             m_status = status::error;
+            break;
         }
         return m_status;
     }
     
     std::unique_ptr<char[]> ntrip_server::build_request(ntrip_login& nlogin)
     {
-        // mount, port, auth, mount, lat, lon
+        // mount, port, auth, STR line
+        // the header ends with an empty line, correction follows unencoded
         const char* requestFormat = "POST /%s HTTP/1.1\r\n"
             "Host: somehost:%d\r\n"
             "Ntrip-Version: Ntrip/2.0\r\n"
             "User-Agent: NTRIP PvvovanServer\r\n"
             "Authorization: Basic %s\r\n"
-            "NTRIP-STR: %s;CMR-;12(1),12(1);2;GPS+GLONASS;23;ua;"
-            "%9.6f;%9.6f;0;0;Trimble AgGPS_542;none;B;N;9600;none;"
-            "\r\nTransfer-Encoding: chunked";
+            "NTRIP-STR: %s\r\n"
+            "\r\n";
+        std::string str{nlogin.str};
+        if (str.empty()) {
+            // nothing is known about the stream, format and receiver are left empty
+            str = stream_profile{}.str(nlogin.mountpoint, nlogin.position);
+        }
 
         std::unique_ptr<char[]> request;
         std::string auth{""};
@@ -96,9 +77,8 @@ namespace VrsTunnel::Ntrip
             auth = (*encoder).get(nlogin.username, nlogin.password);
         }
 
-        request = std::make_unique<char[]>(strlen(requestFormat) + nlogin.mountpoint.size()*2 + 5 + auth.length() + 33);
-        sprintf(request.get(), requestFormat, nlogin.mountpoint.data(), nlogin.port, auth.c_str(),
-            nlogin.mountpoint.data(), nlogin.position.Latitude, nlogin.position.Longitude);
+        request = std::make_unique<char[]>(strlen(requestFormat) + nlogin.mountpoint.size() + 5 + auth.length() + str.size() + 1);
+        sprintf(request.get(), requestFormat, nlogin.mountpoint.data(), nlogin.port, auth.c_str(), str.c_str());
         return request;
     }
 
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "reactor.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    reactor::reactor()
+    {
+        m_epollfd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (m_epollfd < 0) {
+            throw std::runtime_error("epoll instance not created");
+        }
+        m_wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_wakefd < 0) {
+            close(m_epollfd);
+            throw std::runtime_error("eventfd not created");
+        }
+        struct epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = m_wakefd;
+        if (::epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_wakefd, &ev) != 0) {
+            close(m_wakefd);
+            close(m_epollfd);
+            throw std::runtime_error("eventfd not registered");
+        }
+        m_sparefd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+
+    reactor::~reactor()
+    {
+        m_connections.clear();
+        close(m_listenfd);
+        close(m_sparefd);
+        close(m_wakefd);
+        close(m_epollfd);
+    }
+
+    [[nodiscard]] bool reactor::listen(int port, bool reuse_port)
+    {
+        m_listenfd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listenfd < 0) {
+            m_listenfd = -1;
+            return false;
+        }
+        int on = 1;
+        ::setsockopt(m_listenfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (reuse_port && ::setsockopt(m_listenfd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+            close(m_listenfd);
+            return false;
+        }
+
+        struct sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port        = htons(port);
+        if (::bind(m_listenfd, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) < 0
+                || ::listen(m_listenfd, SOMAXCONN) < 0) {
+            close(m_listenfd);
+            return false;
+        }
+
+        struct epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = m_listenfd;
+        if (::epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_listenfd, &ev) != 0) {
+            close(m_listenfd);
+            return false;
+        }
+        return true;
+    }
+
+    void reactor::stop() noexcept
+    {
+        m_stop_required.store(true);
+        wake();
+    }
+
+    void reactor::wake() noexcept
+    {
+        // edge-triggered, every write is an event and the counter is never read
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t res = ::write(m_wakefd, &one, sizeof(one));
+    }
+
+    void reactor::set_timeout(std::chrono::milliseconds timeout) noexcept
+    {
+        m_timeout = timeout;
+    }
+
+    std::size_t reactor::size() const noexcept
+    {
+        return m_connections.size();
+    }
+
+    std::shared_ptr<connection> reactor::accept_one()
+    {
+        for (;;) {
+            int fd = ::accept4(m_listenfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if ((errno == EMFILE || errno == ENFILE) && !reject_pending()) {
+                    // no new edge comes for the backlog, poll it instead
+                    m_accept_retry = std::chrono::steady_clock::now() + accept_retry;
+                }
+                return nullptr;
+            }
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+            struct epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.fd = fd;
+            if (::epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                ::close(fd);
+                continue;
+            }
+
+            entry el{};
+            el.conn = std::make_shared<connection>(std::make_unique<tcp_client>(fd));
+            el.idle_pos = m_idle.insert(m_idle.end(), fd);
+            el.checked = std::chrono::steady_clock::now();
+            auto [pos, success] = m_connections.emplace(fd, std::move(el));
+            if (!success) {
+                throw std::runtime_error("TCP client exists already");
+            }
+            return pos->second.conn;
+        }
+    }
+
+    bool reactor::reject_pending()
+    {
+        if (m_sparefd == -1) {
+            m_sparefd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if (m_sparefd == -1) {
+                return false;
+            }
+        }
+        close(m_sparefd);
+        for (;;) {
+            int fd = ::accept4(m_listenfd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                close(fd);
+            }
+            else if (errno != EINTR && errno != ECONNABORTED) {
+                break;
+            }
+        }
+        bool drained = errno == EAGAIN || errno == EWOULDBLOCK;
+        m_sparefd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return drained;
+    }
+
+    std::shared_ptr<connection> reactor::remove(int fd)
+    {
+        auto el = m_connections.find(fd);
+        if (el == m_connections.end()) {
+            return nullptr;
+        }
+        std::shared_ptr<connection> conn = std::move(el->second.conn);
+        m_idle.erase(el->second.idle_pos);
+        m_connections.erase(el);
+        ::epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr);
+        return conn;
+    }
+
+    std::shared_ptr<connection> reactor::expired(std::chrono::steady_clock::time_point now)
+    {
+        if (m_timeout.count() <= 0) {
+            return nullptr;
+        }
+        while (!m_idle.empty()) {
+            auto& el = m_connections.at(m_idle.front());
+            if (now - el.checked < m_timeout) {
+                return nullptr; // the rest of the list was checked later
+            }
+            if (now - el.conn->last_activity() >= m_timeout) {
+                return el.conn;
+            }
+            el.checked = now;
+            m_idle.splice(m_idle.end(), m_idle, el.idle_pos);
+        }
+        return nullptr;
+    }
+
+    int reactor::wait_time(std::chrono::steady_clock::time_point now,
+        std::chrono::steady_clock::time_point deadline) const
+    {
+        if (m_timeout.count() > 0 && !m_idle.empty()) {
+            const auto& el = m_connections.at(m_idle.front());
+            deadline = std::min(deadline, el.checked + m_timeout);
+        }
+        deadline = std::min(deadline, m_accept_retry);
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            return -1;
+        }
+        if (deadline <= now) {
+            return 0;
+        }
+        // rounded up, so the loop does not wake up just before the deadline
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        return static_cast<int>(std::min<std::chrono::milliseconds::rep>(left.count(), 1000 * 60 * 60));
+    }
+
+    void reactor::close(int& fd)
+    {
+        if (fd != -1) {
+            int res = ::close(fd);
+            if (res != 0) {
+                throw std::runtime_error("possible memory leak");
+            }
+            fd = -1;
+        }
+    }
+}
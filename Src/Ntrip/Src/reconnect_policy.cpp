@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "reconnect_policy.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    reconnect_policy::reconnect_policy(backoff_settings settings, std::uint32_t seed) :
+        m_settings{settings},
+        m_random{seed}
+    { }
+
+    void reconnect_policy::connected()
+    {
+        clock::time_point now = clock::now();
+        if (m_outage_start != clock::time_point{}) {
+            auto outage = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_outage_start);
+            m_stats.last_outage = outage;
+            m_stats.max_outage = std::max(m_stats.max_outage, outage);
+            m_stats.total_outage += outage;
+            ++m_stats.reconnects;
+            m_outage_start = clock::time_point{};
+        }
+        m_session = true;
+        m_session_start = now;
+    }
+
+    [[nodiscard]] std::chrono::milliseconds reconnect_policy::next_delay(status reason)
+    {
+        clock::time_point now = clock::now();
+        if (m_session) {
+            m_session = false;
+            m_outage_start = now;
+            if (now - m_session_start >= m_settings.stable) {
+                m_failures = 0; // a flapping connection keeps backing off
+            }
+        }
+        else {
+            ++m_stats.attempts;
+            if (m_outage_start == clock::time_point{}) {
+                m_outage_start = now;
+            }
+        }
+
+        std::uniform_real_distribution<double> cut(0.0, std::clamp(m_settings.jitter, 0.0, 1.0));
+        std::chrono::milliseconds base{0};
+        unsigned failures = m_failures++;
+        if (reason == status::authfailure) {
+            // auth_delay is a floor, spread the retries above it
+            base = m_settings.auth_delay;
+            return std::chrono::milliseconds(static_cast<std::int64_t>(base.count() * (1.0 + cut(m_random))));
+        }
+        if (failures == 0) {
+            return base; // immediate retry, most outages are a single reset
+        }
+        unsigned shift = std::min(failures - 1, 30U);
+        base = m_settings.initial.count() > (m_settings.ceiling.count() >> shift)
+            ? m_settings.ceiling
+            : std::chrono::milliseconds(m_settings.initial.count() << shift);
+        return std::chrono::milliseconds(static_cast<std::int64_t>(base.count() * (1.0 - cut(m_random))));
+    }
+
+    reconnect_stats reconnect_policy::stats() const noexcept
+    {
+        return m_stats;
+    }
+}
@@ -0,0 +1,9 @@
+#include <memory>
+
+#include "registry.hpp.cpp"
+#include "accept_listener.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    template class registry<std::shared_ptr<const accept_listener::client>>;
+}
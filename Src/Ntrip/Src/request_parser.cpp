@@ -0,0 +1,174 @@
+#include <cstring>
+
+#include "request_parser.hpp"
+
+namespace
+{
+    std::string_view trim(std::string_view sv) noexcept
+    {
+        while (!sv.empty() && (sv.front() == ' ' || sv.front() == '\t')) {
+            sv.remove_prefix(1);
+        }
+        while (!sv.empty() && (sv.back() == ' ' || sv.back() == '\t')) {
+            sv.remove_suffix(1);
+        }
+        return sv;
+    }
+
+    bool iequals(std::string_view a, std::string_view b) noexcept
+    {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if ((a[i] | 0x20) != (b[i] | 0x20)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Splits off the next space separated token
+     */
+    std::string_view next_token(std::string_view& line) noexcept
+    {
+        line = trim(line);
+        std::size_t end = line.find(' ');
+        std::string_view token = line.substr(0, end);
+        line.remove_prefix(end == std::string_view::npos ? line.size() : end);
+        return token;
+    }
+}
+
+namespace VrsTunnel::Ntrip
+{
+    [[nodiscard]] io_status request_parser::parse(std::string_view buffer) noexcept
+    {
+        m_base = buffer.data();
+        while (m_state == state::request_line || m_state == state::header) {
+            if (m_pos >= buffer.size()) {
+                return io_status::InProgress;
+            }
+            const void* lf = ::memchr(buffer.data() + m_pos, '\n', buffer.size() - m_pos);
+            if (lf == nullptr) {
+                m_pos = buffer.size();
+                return io_status::InProgress;
+            }
+            std::size_t line_end = static_cast<const char*>(lf) - buffer.data();
+            std::string_view line = buffer.substr(m_line_start, line_end - m_line_start);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            m_pos = line_end + 1;
+            m_line_start = m_pos;
+
+            if (m_state == state::request_line) {
+                m_state = parse_request_line(line) ? state::header : state::error;
+            }
+            else if (line.empty()) {
+                m_state = state::done;
+            }
+            else if (!parse_header(line)) {
+                m_state = state::error;
+            }
+        }
+        return m_state == state::done ? io_status::Success : io_status::Error;
+    }
+
+    bool request_parser::parse_request_line(std::string_view line) noexcept
+    {
+        std::string_view rest = line;
+        std::string_view method = next_token(rest);
+        if (method == "GET") {
+            m_method = request_method::get;
+        }
+        else if (method == "POST") {
+            m_method = request_method::post;
+        }
+        else if (method == "SOURCE") {
+            m_method = request_method::source;
+            std::string_view password = next_token(rest);
+            m_password = to_field(password);
+        }
+        else {
+            return false;
+        }
+        std::string_view target = next_token(rest);
+        if (target.empty() || target.front() != '/') {
+            return false;
+        }
+        target.remove_prefix(1);
+        if (m_method != request_method::get && target.empty()) {
+            return false; // server has to name its mount point
+        }
+        m_mount = to_field(target);
+        return true;
+    }
+
+    bool request_parser::parse_header(std::string_view line) noexcept
+    {
+        std::size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            return false;
+        }
+        std::string_view name = trim(line.substr(0, colon));
+        field value = to_field(trim(line.substr(colon + 1)));
+        if (iequals(name, "Authorization")) {
+            m_authorization = value;
+        }
+        else if (iequals(name, "Ntrip-Version")) {
+            m_ntrip_version = value;
+        }
+        else if (iequals(name, "Ntrip-GGA")) {
+            m_ntrip_gga = value;
+        }
+        else if (iequals(name, "Ntrip-STR")) {
+            m_ntrip_str = value;
+        }
+        else if (iequals(name, "Transfer-Encoding")) {
+            m_transfer_encoding = value;
+        }
+        return true;
+    }
+
+    ntrip_request request_parser::request() const noexcept
+    {
+        ntrip_request req{};
+        req.method = m_method;
+        req.mount = view(m_mount);
+        req.password = view(m_password);
+        req.authorization = view(m_authorization);
+        req.ntrip_version = view(m_ntrip_version);
+        req.ntrip_gga = view(m_ntrip_gga);
+        req.ntrip_str = view(m_ntrip_str);
+        req.transfer_encoding = view(m_transfer_encoding);
+        return req;
+    }
+
+    std::size_t request_parser::size() const noexcept
+    {
+        return m_state == state::done ? m_pos : 0;
+    }
+
+    void request_parser::reset() noexcept
+    {
+        *this = request_parser{};
+    }
+
+    request_parser::field request_parser::to_field(std::string_view part) const noexcept
+    {
+        field f{};
+        f.offset = static_cast<std::uint32_t>(part.data() - m_base);
+        f.length = static_cast<std::uint32_t>(part.size());
+        return f;
+    }
+
+    std::string_view request_parser::view(field f) const noexcept
+    {
+        if (f.length == 0) {
+            return std::string_view();
+        }
+        return std::string_view(m_base + f.offset, f.length);
+    }
+}
@@ -0,0 +1,138 @@
+#include <cstring>
+#include <netdb.h>
+
+#include "resolver.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    resolver::resolver(lookup_function lookup, resolver_settings settings) :
+        m_lookup{std::move(lookup)},
+        m_settings{settings},
+        m_worker{&resolver::run, this}
+    { }
+
+    resolver::~resolver()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_work.notify_all();
+        m_worker.join();
+    }
+
+    [[nodiscard]] io_status resolver::resolve(const std::string& host, int port,
+        std::vector<endpoint>& endpoints, std::chrono::milliseconds timeout)
+    {
+        std::string key = host + ':' + std::to_string(port);
+        clock::time_point now = clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        entry& e = m_cache[key];
+        if (e.host.empty()) {
+            e.host = host;
+            e.port = port;
+        }
+        if (now >= e.expires) {
+            schedule(key, e);
+        }
+        if (!e.endpoints.empty() && now < e.fresh_until + m_settings.max_stale) {
+            endpoints = e.endpoints;    // fresh, or stale while the refresh runs
+            return io_status::Success;
+        }
+        if (e.failed && now < e.expires) {
+            return io_status::Error;    // negative caching
+        }
+
+        std::uint64_t generation = e.generation;
+        m_done.wait_for(lock, timeout, [&e, generation] { return e.generation != generation; });
+        if (e.generation == generation) {
+            return io_status::InProgress;
+        }
+        if (e.failed) {
+            return io_status::Error;
+        }
+        endpoints = e.endpoints;
+        return io_status::Success;
+    }
+
+    std::uint64_t resolver::lookups() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lookups;
+    }
+
+    void resolver::schedule(const std::string& key, entry& e)
+    {
+        if (e.queued) {
+            return;
+        }
+        e.queued = true;
+        m_queue.push_back(key);
+        m_work.notify_one();
+    }
+
+    void resolver::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_work.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_stop) {
+                return;
+            }
+            std::string key = std::move(m_queue.front());
+            m_queue.pop_front();
+            std::string host = m_cache[key].host;
+            int port = m_cache[key].port;
+            ++m_lookups;
+
+            lock.unlock();
+            std::vector<endpoint> endpoints{};
+            io_status res = m_lookup(host, port, endpoints);
+            lock.lock();
+
+            entry& e = m_cache[key];
+            clock::time_point now = clock::now();
+            e.failed = res != io_status::Success || endpoints.empty();
+            if (e.failed) {
+                e.expires = now + m_settings.negative_ttl; // stale endpoints are kept
+            }
+            else {
+                e.endpoints = std::move(endpoints);
+                e.fresh_until = now + m_settings.ttl;
+                e.expires = e.fresh_until;
+            }
+            e.queued = false;
+            ++e.generation;
+            m_done.notify_all();
+        }
+    }
+
+    io_status resolver::system_lookup(const std::string& host, int port, std::vector<endpoint>& endpoints)
+    {
+        struct addrinfo hints;
+        ::memset(&hints, 0, sizeof(hints));
+        hints.ai_family     = AF_UNSPEC;    /* Allow IPv4 or IPv6 */
+        hints.ai_socktype   = SOCK_STREAM;  /* TCP socket */
+
+        struct addrinfo *result = nullptr;
+        std::string service = std::to_string(port);
+        if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0) {
+            return io_status::Error;
+        }
+        /* getaddrinfo() returns addresses sorted by RFC 6724 preference */
+        for (struct addrinfo* rp = result; rp != nullptr; rp = rp->ai_next) {
+            endpoint ep{};
+            ::memcpy(&ep.address, rp->ai_addr, rp->ai_addrlen);
+            ep.length = rp->ai_addrlen;
+            endpoints.push_back(ep);
+        }
+        freeaddrinfo(result);
+        return io_status::Success;
+    }
+
+    resolver& resolver::shared()
+    {
+        static resolver instance{};
+        return instance;
+    }
+}
@@ -0,0 +1,97 @@
+#include <charconv>
+#include <cstring>
+
+#include "response_parser.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    [[nodiscard]] io_status response_parser::parse(std::string_view buffer) noexcept
+    {
+        while (m_state == state::status_line || m_state == state::header) {
+            if (m_pos >= buffer.size()) {
+                return io_status::InProgress;
+            }
+            const void* lf = ::memchr(buffer.data() + m_pos, '\n', buffer.size() - m_pos);
+            if (lf == nullptr) {
+                m_pos = buffer.size();
+                if (m_pos > max_header) {
+                    m_state = state::error;
+                    break;
+                }
+                return io_status::InProgress;
+            }
+            std::size_t line_end = static_cast<const char*>(lf) - buffer.data();
+            std::string_view line = buffer.substr(m_line_start, line_end - m_line_start);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            m_pos = line_end + 1;
+            m_line_start = m_pos;
+
+            if (m_state == state::status_line) {
+                if (!parse_status_line(line)) {
+                    m_state = state::error;
+                }
+                else if (m_protocol != response_protocol::http || m_code < 200 || m_code > 299) {
+                    // v1 casters may or may not send the empty line, the body follows at once
+                    if (m_protocol == response_protocol::icy
+                            && buffer.substr(m_pos, 2) == std::string_view("\r\n")) {
+                        m_pos += 2;
+                    }
+                    m_state = state::done;
+                }
+                else {
+                    m_state = state::header;
+                }
+            }
+            else if (line.empty()) {
+                m_state = state::done;
+            }
+        }
+        return m_state == state::done ? io_status::Success : io_status::Error;
+    }
+
+    bool response_parser::parse_status_line(std::string_view line) noexcept
+    {
+        std::size_t space = line.find(' ');
+        if (space == std::string_view::npos) {
+            return false;
+        }
+        std::string_view protocol = line.substr(0, space);
+        if (protocol == "ICY") {
+            m_protocol = response_protocol::icy;
+        }
+        else if (protocol.substr(0, 5) == "HTTP/") {
+            m_protocol = response_protocol::http;
+        }
+        else if (protocol == "SOURCETABLE") {
+            m_protocol = response_protocol::sourcetable;
+        }
+        else {
+            return false;
+        }
+        std::string_view code = line.substr(space + 1, 3);
+        auto [end, ec] = std::from_chars(code.data(), code.data() + code.size(), m_code);
+        return ec == std::errc() && end == code.data() + code.size() && code.size() == 3;
+    }
+
+    int response_parser::code() const noexcept
+    {
+        return m_code;
+    }
+
+    response_protocol response_parser::protocol() const noexcept
+    {
+        return m_protocol;
+    }
+
+    std::size_t response_parser::size() const noexcept
+    {
+        return m_state == state::done ? m_pos : 0;
+    }
+
+    void response_parser::reset() noexcept
+    {
+        *this = response_parser{};
+    }
+}
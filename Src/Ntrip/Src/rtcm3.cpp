@@ -0,0 +1,132 @@
+#include <cmath>
+
+#include "rtcm3.hpp"
+
+namespace
+{
+    constexpr double wgs84_a = 6378137.0;
+    constexpr double wgs84_f = 1.0 / 298.257223563;
+    constexpr double wgs84_b = wgs84_a * (1.0 - wgs84_f);
+    constexpr double wgs84_e2 = wgs84_f * (2.0 - wgs84_f);     // first eccentricity squared
+    constexpr double wgs84_ep2 = wgs84_e2 / (1.0 - wgs84_e2);  // second eccentricity squared
+    constexpr double rad_to_deg = 180.0 / M_PI;
+
+    constexpr unsigned station_bits = 152;     // 1005 payload
+    constexpr unsigned height_bits = 16;       // added by 1006
+    constexpr unsigned msm_header_bits = 169;  // up to the cell mask
+    constexpr unsigned max_cells = 64;
+
+    inline unsigned popcount(std::uint64_t mask) noexcept
+    {
+        return static_cast<unsigned>(__builtin_popcountll(mask));
+    }
+}
+
+namespace VrsTunnel::Ntrip
+{
+    std::uint64_t rtcm3::getbitu(const std::uint8_t* data, std::size_t pos, unsigned len) noexcept
+    {
+        if (len == 0) {
+            return 0;
+        }
+        const std::uint8_t* p = data + (pos >> 3);
+        unsigned span = static_cast<unsigned>(pos & 7) + len;
+        unsigned bytes = (span + 7) >> 3;  // at most 8 for 57 bits
+        std::uint64_t value = 0;
+        for (unsigned i = 0; i < bytes; ++i) {
+            value = value << 8 | p[i];
+        }
+        value >>= bytes * 8 - span;
+        return value & (~std::uint64_t{0} >> (64 - len));
+    }
+
+    std::int64_t rtcm3::getbits(const std::uint8_t* data, std::size_t pos, unsigned len) noexcept
+    {
+        if (len == 0) {
+            return 0;
+        }
+        std::uint64_t value = getbitu(data, pos, len) << (64 - len);
+        return static_cast<std::int64_t>(value) >> (64 - len);
+    }
+
+    [[nodiscard]] bool rtcm3::decode_station(const rtcm3_frame& frame, station_position& position) noexcept
+    {
+        std::uint16_t type = frame.message_type();
+        std::size_t bits = frame.payload_size() * 8;
+        if ((type != 1005 && type != 1006) || bits < station_bits + (type == 1006 ? height_bits : 0)) {
+            return false;
+        }
+        const std::uint8_t* p = frame.payload();
+        std::size_t pos = 12;
+        position.station_id = static_cast<std::uint16_t>(getbitu(p, pos, 12));  pos += 12;
+        position.itrf_year = static_cast<std::uint8_t>(getbitu(p, pos, 6));     pos += 6;
+        position.gps = getbitu(p, pos, 1) != 0;         pos += 1;
+        position.glonass = getbitu(p, pos, 1) != 0;     pos += 1;
+        position.galileo = getbitu(p, pos, 1) != 0;     pos += 1;
+        pos += 1;   // reference station indicator
+        position.x = getbits(p, pos, 38) * 0.0001;      pos += 38;
+        pos += 2;   // single receiver oscillator indicator, reserved
+        position.y = getbits(p, pos, 38) * 0.0001;      pos += 38;
+        pos += 2;   // quarter cycle indicator
+        position.z = getbits(p, pos, 38) * 0.0001;      pos += 38;
+        position.antenna_height = type == 1006 ? getbitu(p, pos, 16) * 0.0001 : 0.0;
+        return true;
+    }
+
+    bool rtcm3::is_msm(std::uint16_t type) noexcept
+    {
+        // 1071-1077 GPS, 1081 GLONASS, 1091 Galileo, 1101 SBAS, 1111 QZSS, 1121 BeiDou, 1131 NavIC
+        return type >= 1071 && type <= 1137 && type % 10 >= 1 && type % 10 <= 7;
+    }
+
+    [[nodiscard]] bool rtcm3::decode_msm(const rtcm3_frame& frame, msm_header& header) noexcept
+    {
+        std::uint16_t type = frame.message_type();
+        std::size_t bits = frame.payload_size() * 8;
+        if (!is_msm(type) || bits < msm_header_bits) {
+            return false;
+        }
+        const std::uint8_t* p = frame.payload();
+        std::uint64_t satellite_mask = getbitu(p, 73, 32) << 32 | getbitu(p, 105, 32);
+        std::uint64_t signal_mask = getbitu(p, 137, 32);
+        unsigned satellites = popcount(satellite_mask);
+        unsigned signals = popcount(signal_mask);
+        unsigned cell_bits = satellites * signals;
+        if (cell_bits > max_cells || bits < msm_header_bits + cell_bits) {
+            return false;
+        }
+        std::uint64_t cell_mask = cell_bits > 32
+            ? getbitu(p, msm_header_bits, 32) << (cell_bits - 32) | getbitu(p, msm_header_bits + 32, cell_bits - 32)
+            : getbitu(p, msm_header_bits, cell_bits);
+
+        header.type = type;
+        header.station_id = static_cast<std::uint16_t>(getbitu(p, 12, 12));
+        header.system = static_cast<msm_system>((type - 1071) / 10);
+        header.epoch_time = static_cast<std::uint32_t>(getbitu(p, 24, 30));
+        header.multiple = getbitu(p, 54, 1) != 0;
+        header.satellites = static_cast<std::uint8_t>(satellites);
+        header.signals = static_cast<std::uint8_t>(signals);
+        header.cells = static_cast<std::uint8_t>(popcount(cell_mask));
+        return true;
+    }
+
+    location rtcm3::ecef_to_geodetic(double x, double y, double z) noexcept
+    {
+        // Bowring's formula, one step is sub-millimeter accurate near the Earth surface
+        double p = std::hypot(x, y);
+        if (p < 1e-9) {
+            double lat = z >= 0 ? 90.0 : -90.0;
+            return location{lat, 0.0, std::fabs(z) - wgs84_b};
+        }
+        double theta = std::atan2(z * wgs84_a, p * wgs84_b);
+        double st = std::sin(theta);
+        double ct = std::cos(theta);
+        double lat = std::atan2(z + wgs84_ep2 * wgs84_b * st * st * st, p - wgs84_e2 * wgs84_a * ct * ct * ct);
+        double lon = std::atan2(y, x);
+        double sl = std::sin(lat);
+        double n = wgs84_a / std::sqrt(1.0 - wgs84_e2 * sl * sl);
+        double cl = std::cos(lat);
+        double h = std::fabs(cl) > 1e-3 ? p / cl - n : std::fabs(z) / std::fabs(sl) - n * (1.0 - wgs84_e2);
+        return location{lat * rad_to_deg, lon * rad_to_deg, h};
+    }
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cstring>
+
+#include "rtcm3_framer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    namespace
+    {
+        using crc_table = std::array<std::array<std::uint32_t, 256>, 8>;
+
+        /**
+         * Slice-by-8 tables of CRC-24Q (polynomial 0x1864CFB), the register
+         * is kept in the upper 24 bits so that bytes are xored in without shifts.
+         * Table k gives the CRC of a byte followed by k zero bytes.
+         */
+        constexpr crc_table make_crc_table()
+        {
+            constexpr std::uint32_t poly = 0x864CFBU << 8;
+            crc_table table{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t c = i << 24;
+                for (int bit = 0; bit < 8; ++bit) {
+                    c = (c & 0x80000000U) ? (c << 1) ^ poly : c << 1;
+                }
+                table[0][i] = c;
+            }
+            for (std::size_t k = 1; k < table.size(); ++k) {
+                for (std::size_t i = 0; i < 256; ++i) {
+                    std::uint32_t prev = table[k - 1][i];
+                    table[k][i] = (prev << 8) ^ table[0][prev >> 24];
+                }
+            }
+            return table;
+        }
+
+        constexpr crc_table crc_tables = make_crc_table();
+
+        constexpr bool valid_header(const std::uint8_t* header) noexcept
+        {
+            return (header[1] & 0xFC) == 0;
+        }
+
+        constexpr std::size_t frame_size(const std::uint8_t* header) noexcept
+        {
+            return rtcm3_framer::header_size
+                + (static_cast<std::size_t>(header[1] & 0x03) << 8 | header[2])
+                + rtcm3_framer::crc_size;
+        }
+
+        bool valid_crc(const std::uint8_t* frame, std::size_t size) noexcept
+        {
+            const std::uint8_t* crc = frame + size - rtcm3_framer::crc_size;
+            std::uint32_t expected = static_cast<std::uint32_t>(crc[0]) << 16
+                | static_cast<std::uint32_t>(crc[1]) << 8 | crc[2];
+            return rtcm3_framer::crc24q(frame, size - rtcm3_framer::crc_size) == expected;
+        }
+    }
+
+    const std::uint8_t* rtcm3_frame::payload() const noexcept
+    {
+        return data + rtcm3_framer::header_size;
+    }
+
+    std::size_t rtcm3_frame::payload_size() const noexcept
+    {
+        return size - rtcm3_framer::header_size - rtcm3_framer::crc_size;
+    }
+
+    std::uint16_t rtcm3_frame::message_type() const noexcept
+    {
+        if (payload_size() < 2) {
+            return 0;
+        }
+        const std::uint8_t* p = payload();
+        return static_cast<std::uint16_t>(p[0] << 4 | p[1] >> 4);
+    }
+
+    void rtcm3_framer::feed(const std::uint8_t* data, std::size_t size) noexcept
+    {
+        m_input = data;
+        m_input_size = size;
+    }
+
+    void rtcm3_framer::feed(const char* data, std::size_t size) noexcept
+    {
+        feed(reinterpret_cast<const std::uint8_t*>(data), size);
+    }
+
+    [[nodiscard]] io_status rtcm3_framer::next(rtcm3_frame& frame) noexcept
+    {
+        for (;;) {
+            std::size_t buffered = m_end - m_begin;
+            if (buffered > 0) {
+                const std::uint8_t* p = m_partial.data() + m_begin;
+                if (buffered >= header_size && !valid_header(p)) {
+                    skip_partial();
+                    continue;
+                }
+                std::size_t want = buffered < header_size ? header_size : frame_size(p);
+                if (buffered < want) {
+                    if (m_input_size == 0) {
+                        return io_status::InProgress;
+                    }
+                    if (m_begin > 0) {
+                        std::memmove(m_partial.data(), p, buffered);
+                        m_begin = 0;
+                        m_end = buffered;
+                    }
+                    std::size_t part = std::min(want - buffered, m_input_size);
+                    std::memcpy(m_partial.data() + m_end, m_input, part);
+                    m_end += part;
+                    m_input += part;
+                    m_input_size -= part;
+                    continue;
+                }
+                if (!valid_crc(p, want)) {
+                    ++m_stats.crc_errors;
+                    skip_partial();
+                    continue;
+                }
+                frame.data = p;
+                frame.size = want;
+                m_begin += want;
+                if (m_begin == m_end) {
+                    m_begin = m_end = 0; // storage is reused only after the caller is done with the frame
+                }
+                ++m_stats.frames;
+                return io_status::Success;
+            }
+
+            auto start = static_cast<const std::uint8_t*>(std::memchr(m_input, preamble, m_input_size));
+            std::size_t skip = start ? static_cast<std::size_t>(start - m_input) : m_input_size;
+            m_stats.discarded_bytes += skip;
+            m_input += skip;
+            m_input_size -= skip;
+            if (m_input_size == 0) {
+                return io_status::InProgress;
+            }
+            if (m_input_size >= header_size && !valid_header(m_input)) {
+                ++m_stats.discarded_bytes;
+                ++m_input;
+                --m_input_size;
+                continue;
+            }
+            if (m_input_size < header_size || m_input_size < frame_size(m_input)) {
+                // the frame continues in the next buffer
+                std::memcpy(m_partial.data(), m_input, m_input_size);
+                m_begin = 0;
+                m_end = m_input_size;
+                m_input_size = 0;
+                return io_status::InProgress;
+            }
+            std::size_t size = frame_size(m_input);
+            if (!valid_crc(m_input, size)) {
+                ++m_stats.crc_errors;
+                ++m_stats.discarded_bytes;
+                ++m_input;
+                --m_input_size;
+                continue;
+            }
+            frame.data = m_input;
+            frame.size = size;
+            m_input += size;
+            m_input_size -= size;
+            ++m_stats.frames;
+            return io_status::Success;
+        }
+    }
+
+    void rtcm3_framer::reset() noexcept
+    {
+        m_stats.discarded_bytes += m_end - m_begin + m_input_size;
+        m_begin = m_end = 0;
+        m_input = nullptr;
+        m_input_size = 0;
+    }
+
+    rtcm3_stats rtcm3_framer::stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    void rtcm3_framer::skip_partial() noexcept
+    {
+        ++m_begin;
+        ++m_stats.discarded_bytes;
+        auto start = static_cast<const std::uint8_t*>(
+            std::memchr(m_partial.data() + m_begin, preamble, m_end - m_begin));
+        if (start == nullptr) {
+            m_stats.discarded_bytes += m_end - m_begin;
+            m_begin = m_end = 0;
+            return;
+        }
+        std::size_t next = static_cast<std::size_t>(start - m_partial.data());
+        m_stats.discarded_bytes += next - m_begin;
+        m_begin = next;
+    }
+
+    std::uint32_t rtcm3_framer::crc24q(const std::uint8_t* data, std::size_t size, std::uint32_t crc) noexcept
+    {
+        const auto& t = crc_tables;
+        std::uint32_t c = crc << 8;
+        while (size >= 8) {
+            std::uint32_t x = c ^ (static_cast<std::uint32_t>(data[0]) << 24
+                | static_cast<std::uint32_t>(data[1]) << 16
+                | static_cast<std::uint32_t>(data[2]) << 8 | data[3]);
+            c = t[7][x >> 24] ^ t[6][(x >> 16) & 0xFF] ^ t[5][(x >> 8) & 0xFF] ^ t[4][x & 0xFF]
+                ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+            data += 8;
+            size -= 8;
+        }
+        while (size-- > 0) {
+            c = (c << 8) ^ t[0][(c >> 24) ^ *data++];
+        }
+        return c >> 8;
+    }
+}
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "serial_sink.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    namespace
+    {
+        constexpr int bits_per_byte = 10;   // start, 8 data bits, stop
+    }
+
+    serial_sink::~serial_sink()
+    {
+        close();
+    }
+
+    [[nodiscard]] io_status serial_sink::open(const std::string& path, const serial_settings& settings)
+    {
+        close();
+        speed_t speed{};
+        if (!to_speed(settings.baud, speed)) {
+            return io_status::Error;
+        }
+        int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            return io_status::Error;
+        }
+        struct termios tio{};
+        if (::tcgetattr(fd, &tio) != 0) {
+            ::close(fd);
+            return io_status::Error;
+        }
+        ::cfmakeraw(&tio);
+        ::cfsetispeed(&tio, speed);
+        ::cfsetospeed(&tio, speed);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+        if (settings.flow == flow_control::rtscts) {
+            tio.c_cflag |= CRTSCTS;
+        }
+        else if (settings.flow == flow_control::xonxoff) {
+            tio.c_iflag |= IXON | IXOFF;
+        }
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        if (::tcsetattr(fd, TCSANOW, &tio) != 0) {
+            ::close(fd);
+            return io_status::Error;
+        }
+        ::tcflush(fd, TCIOFLUSH);
+
+        m_fd = fd;
+        m_settings = settings;
+        m_rate = static_cast<double>(settings.baud) / bits_per_byte;
+        m_backlog = 0;
+        m_drained = clock::now();
+        m_framer.reset();
+        m_output_size = 0;
+        m_failed = false;
+        m_stats = serial_stats{};
+        return io_status::Success;
+    }
+
+    void serial_sink::close() noexcept
+    {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    void serial_sink::reset() noexcept
+    {
+        m_framer.reset();
+    }
+
+    [[nodiscard]] io_status serial_sink::write(const char* data, std::size_t size) noexcept
+    {
+        if (m_fd < 0 || m_failed) {
+            return io_status::Error;
+        }
+        if (m_settings.rtcm_frames) {
+            m_framer.feed(data, size);
+            rtcm3_frame frame{};
+            while (m_framer.next(frame) == io_status::Success) {
+                std::uint16_t type = frame.message_type();
+                m_messages->count(type, frame.size);
+                if (!m_settings.filter.accepts(type)) {
+                    ++m_stats.filtered_frames;
+                    m_stats.filtered_bytes += frame.size;
+                    continue;
+                }
+                admit(reinterpret_cast<const char*>(frame.data), frame.size);
+            }
+        }
+        else {
+            while (size > 0) {
+                std::size_t part = std::min(size, rtcm3_framer::max_frame);
+                admit(data, part);
+                data += part;
+                size -= part;
+            }
+        }
+        return flush() == io_status::Error ? io_status::Error : io_status::Success;
+    }
+
+    void serial_sink::admit(const char* data, std::size_t size) noexcept
+    {
+        clock::time_point now = clock::now();
+        std::chrono::duration<double> elapsed = now - m_drained;
+        m_drained = now;
+        m_backlog = std::max(0.0, m_backlog - elapsed.count() * m_rate);
+
+        double limit = m_rate * std::chrono::duration<double>(m_settings.max_backlog).count();
+        if (m_backlog + size > limit) {
+            drop(size);
+            return;
+        }
+        if (m_output_size + size > m_output.size()
+                && (flush() != io_status::Success || m_output_size + size > m_output.size())) {
+            drop(size); // the port does not keep up with the modelled link
+            return;
+        }
+        m_backlog += size;
+        std::memcpy(m_output.data() + m_output_size, data, size);
+        m_output_size += size;
+        ++m_stats.frames;
+        m_stats.bytes += size;
+    }
+
+    void serial_sink::drop(std::size_t size) noexcept
+    {
+        ++m_stats.dropped_frames;
+        m_stats.dropped_bytes += size;
+    }
+
+    [[nodiscard]] io_status serial_sink::flush() noexcept
+    {
+        if (m_fd < 0 || m_failed) {
+            return io_status::Error;
+        }
+        std::size_t sent = 0;
+        io_status res = io_status::Success;
+        while (sent < m_output_size) {
+            ssize_t n = ::write(m_fd, m_output.data() + sent, m_output_size - sent);
+            if (n > 0) {
+                sent += n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // the driver queue is full, the rest of a cut frame goes first next time
+                res = io_status::InProgress;
+                break;
+            }
+            m_failed = true;
+            return io_status::Error;
+        }
+        std::memmove(m_output.data(), m_output.data() + sent, m_output_size - sent);
+        m_output_size -= sent;
+        return res;
+    }
+
+    bool serial_sink::blocked() const noexcept
+    {
+        return m_output_size > 0;
+    }
+
+    serial_stats serial_sink::stats() const noexcept
+    {
+        serial_stats stats = m_stats;
+        stats.discarded_bytes = m_framer.stats().discarded_bytes;
+        return stats;
+    }
+
+    const message_stats& serial_sink::messages() const noexcept
+    {
+        return *m_messages;
+    }
+
+    int serial_sink::get_fd() const noexcept
+    {
+        return m_fd;
+    }
+
+    bool serial_sink::to_speed(int baud, speed_t& speed) noexcept
+    {
+        switch (baud) {
+            case 1200: speed = B1200; return true;
+            case 2400: speed = B2400; return true;
+            case 4800: speed = B4800; return true;
+            case 9600: speed = B9600; return true;
+            case 19200: speed = B19200; return true;
+            case 38400: speed = B38400; return true;
+            case 57600: speed = B57600; return true;
+            case 115200: speed = B115200; return true;
+            case 230400: speed = B230400; return true;
+            case 460800: speed = B460800; return true;
+            case 921600: speed = B921600; return true;
+            default: return false;
+        }
+    }
+
+    bool serial_sink::parse(std::string_view name, flow_control& flow) noexcept
+    {
+        if (name == "none") {
+            flow = flow_control::none;
+        }
+        else if (name == "rtscts") {
+            flow = flow_control::rtscts;
+        }
+        else if (name == "xonxoff") {
+            flow = flow_control::xonxoff;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,33 @@
+#include <cstring>
+
+#include "shared_buffer.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    shared_buffer::shared_buffer(const char* data, std::size_t size) :
+        m_data{std::make_unique<char[]>(size)},
+        m_size{size}
+    {
+        ::memcpy(m_data.get(), data, size);
+    }
+
+    std::shared_ptr<const shared_buffer> shared_buffer::make(const char* data, std::size_t size)
+    {
+        return std::shared_ptr<const shared_buffer>(new shared_buffer(data, size));
+    }
+
+    const char* shared_buffer::data() const noexcept
+    {
+        return m_data.get();
+    }
+
+    std::size_t shared_buffer::size() const noexcept
+    {
+        return m_size;
+    }
+
+    std::string_view shared_buffer::view() const noexcept
+    {
+        return std::string_view(m_data.get(), m_size);
+    }
+}
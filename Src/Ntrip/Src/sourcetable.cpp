@@ -0,0 +1,125 @@
+#include <atomic>
+#include <cstdio>
+
+#include "sourcetable.hpp"
+
+namespace
+{
+    constexpr std::string_view str_prefix {"STR;"};
+    constexpr std::string_view table_end {"ENDSOURCETABLE\r\n"};
+    constexpr std::size_t latitude_field = 9;  // counted from "STR"
+}
+
+namespace VrsTunnel::Ntrip
+{
+    sourcetable::sourcetable()
+    {
+        render();
+    }
+
+    void sourcetable::add(std::string_view mount, std::string_view str)
+    {
+        std::string line{};
+        if (str.empty()) {
+            line.append(str_prefix).append(mount).append(";").append(mount)
+                .append(";;;0;;;;0.00;0.00;0;0;;none;N;N;0;");
+        }
+        else {
+            if (str.compare(0, str_prefix.size(), str_prefix) != 0) {
+                line.append(str_prefix);
+            }
+            line.append(str);
+        }
+        std::scoped_lock sl(m_mutex);
+        auto el = m_entries.find(mount);
+        if (el == m_entries.end()) {
+            m_entries.emplace(std::string(mount), std::move(line));
+        }
+        else if (el->second != line) {
+            el->second = std::move(line);
+        }
+        else {
+            return; // nothing changed
+        }
+        render();
+    }
+
+    bool sourcetable::set_position(std::string_view mount, const location& position)
+    {
+        char coordinates[64];
+        std::snprintf(coordinates, sizeof(coordinates), "%.6f;%.6f", position.Latitude, position.Longitude);
+        std::scoped_lock sl(m_mutex);
+        auto el = m_entries.find(mount);
+        if (el == m_entries.end()) {
+            return false;
+        }
+        std::string& line = el->second;
+        std::size_t begin = 0;
+        for (std::size_t field = 0; field < latitude_field && begin != std::string::npos; ++field) {
+            begin = line.find(';', begin);
+            begin = begin == std::string::npos ? begin : begin + 1;
+        }
+        if (begin == std::string::npos) {
+            return true; // truncated entry, nothing to replace
+        }
+        std::size_t end = line.find(';', begin);
+        end = end == std::string::npos ? end : line.find(';', end + 1);
+        std::size_t length = end == std::string::npos ? std::string::npos : end - begin;
+        if (line.compare(begin, length, coordinates) == 0) {
+            return true;
+        }
+        line.replace(begin, length, coordinates);
+        render();
+        return true;
+    }
+
+    bool sourcetable::remove(std::string_view mount)
+    {
+        std::scoped_lock sl(m_mutex);
+        auto el = m_entries.find(mount);
+        if (el == m_entries.end()) {
+            return false;
+        }
+        m_entries.erase(el);
+        render();
+        return true;
+    }
+
+    std::shared_ptr<const sourcetable::rendered> sourcetable::get() const
+    {
+        return std::atomic_load(&m_rendered);
+    }
+
+    void sourcetable::render()
+    {
+        std::size_t size = table_end.size();
+        for (const auto& el : m_entries) {
+            size += el.second.size() + 2;
+        }
+        std::string body{};
+        body.reserve(size);
+        for (const auto& el : m_entries) {
+            body.append(el.second).append("\r\n");
+        }
+        body.append(table_end);
+
+        std::string length = std::to_string(body.size());
+        std::string v1 = "SOURCETABLE 200 OK\r\n"
+            "Server: NTRIP VrsTunnel\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: " + length + "\r\n\r\n";
+        std::string v2 = "HTTP/1.1 200 OK\r\n"
+            "Ntrip-Version: Ntrip/2.0\r\n"
+            "Server: NTRIP VrsTunnel\r\n"
+            "Content-Type: gnss/sourcetable\r\n"
+            "Content-Length: " + length + "\r\n"
+            "Connection: close\r\n\r\n";
+
+        auto table = std::make_shared<rendered>();
+        table->version = ++m_version;
+        table->v1_header = shared_buffer::make(v1.data(), v1.size());
+        table->v2_header = shared_buffer::make(v2.data(), v2.size());
+        table->body = shared_buffer::make(body.data(), body.size());
+        std::atomic_store(&m_rendered, std::shared_ptr<const rendered>(std::move(table)));
+    }
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "spmc_ring.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+    spmc_ring::spmc_ring(std::size_t capacity) :
+        m_capacity{capacity},
+        m_slots{std::make_unique<slot[]>(capacity)}
+    {
+        if (capacity == 0) {
+            throw std::runtime_error("ring capacity is zero");
+        }
+    }
+
+    void spmc_ring::publish(const char* data, std::size_t size, std::uint32_t tag) noexcept
+    {
+        while (size > 0) {
+            std::size_t part = std::min(size, slot_size);
+            publish_slot(data, part, tag);
+            data += part;
+            size -= part;
+        }
+    }
+
+    void spmc_ring::publish_slot(const char* data, std::size_t size, std::uint32_t tag) noexcept
+    {
+        std::uint64_t n = m_head.load(std::memory_order_relaxed);
+        slot& sl = m_slots[n % m_capacity];
+        sl.seq.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        sl.size.store(static_cast<std::uint32_t>(size), std::memory_order_relaxed);
+        sl.tag.store(tag, std::memory_order_relaxed);
+        for (std::size_t w = 0; w * sizeof(std::uint64_t) < size; ++w) {
+            std::uint64_t word = 0;
+            std::size_t offset = w * sizeof(std::uint64_t);
+            ::memcpy(&word, data + offset, std::min(sizeof(word), size - offset));
+            sl.words[w].store(word, std::memory_order_relaxed);
+        }
+
+        sl.seq.store(2 * n + 2, std::memory_order_release);
+        m_head.store(n + 1, std::memory_order_release);
+    }
+
+    spmc_ring::cursor spmc_ring::subscribe() const noexcept
+    {
+        cursor cur{};
+        cur.next = m_head.load(std::memory_order_acquire);
+        return cur;
+    }
+
+    [[nodiscard]] ring_status spmc_ring::read(cursor& cur, char* data, std::size_t& size) const noexcept
+    {
+        std::uint32_t tag = 0;
+        return read(cur, data, size, tag);
+    }
+
+    [[nodiscard]] ring_status spmc_ring::read(cursor& cur, char* data, std::size_t& size, std::uint32_t& tag) const noexcept
+    {
+        auto resync = [this, &cur]() -> ring_status {
+            std::uint64_t head = m_head.load(std::memory_order_acquire);
+            ++cur.lapped;
+            cur.lost += head - cur.next;
+            cur.next = head;
+            return ring_status::Lapped;
+        };
+
+        const slot& sl = m_slots[cur.next % m_capacity];
+        const std::uint64_t expected = 2 * cur.next + 2;
+        std::uint64_t before = sl.seq.load(std::memory_order_acquire);
+        if (before < expected) {
+            return ring_status::Empty;
+        }
+        if (before > expected) {
+            return resync();
+        }
+
+        std::size_t n_bytes = std::min<std::size_t>(sl.size.load(std::memory_order_relaxed), slot_size);
+        std::uint32_t n_tag = sl.tag.load(std::memory_order_relaxed);
+        for (std::size_t w = 0; w * sizeof(std::uint64_t) < n_bytes; ++w) {
+            std::uint64_t word = sl.words[w].load(std::memory_order_relaxed);
+            std::size_t offset = w * sizeof(std::uint64_t);
+            ::memcpy(data + offset, &word, std::min(sizeof(word), n_bytes - offset));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sl.seq.load(std::memory_order_relaxed) != before) {
+            return resync(); // overwritten while being copied
+        }
+        size = n_bytes;
+        tag = n_tag;
+        ++cur.next;
+        return ring_status::Success;
+    }
+
+    std::uint64_t spmc_ring::lag(const cursor& cur) const noexcept
+    {
+        std::uint64_t head = m_head.load(std::memory_order_acquire);
+        return head > cur.next ? head - cur.next : 0;
+    }
+
+    std::size_t spmc_ring::capacity() const noexcept
+    {
+        return m_capacity;
+    }
+}
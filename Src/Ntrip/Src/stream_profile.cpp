@@ -0,0 +1,107 @@
+#include <array>
+#include <cstdio>
+
+#include "stream_profile.hpp"
+
+namespace
+{
+    /**
+     * GNSS system and the message numbers of its observations
+     */
+    struct gnss_messages
+    {
+        const char* name;
+        std::uint16_t first;
+        std::uint16_t last;
+    };
+
+    constexpr std::array<gnss_messages, 9> observation_messages {{
+        {"GPS", 1001, 1004},
+        {"GLONASS", 1009, 1012},
+        {"GPS", 1071, 1077},
+        {"GLONASS", 1081, 1087},
+        {"Galileo", 1091, 1097},
+        {"SBAS", 1101, 1107},
+        {"QZSS", 1111, 1117},
+        {"BeiDou", 1121, 1127},
+        {"NavIC", 1131, 1137},
+    }};
+}
+
+namespace VrsTunnel::Ntrip
+{
+    void stream_profile::add(const rtcm3_frame& frame) noexcept
+    {
+        std::uint16_t type = frame.message_type();
+        m_types.set(type);
+        if ((type == 1005 || type == 1006) && rtcm3::decode_station(frame, m_station)) {
+            m_has_position = true;
+        }
+    }
+
+    bool stream_profile::empty() const noexcept
+    {
+        return m_types.none();
+    }
+
+    bool stream_profile::has_position() const noexcept
+    {
+        return m_has_position;
+    }
+
+    location stream_profile::position() const noexcept
+    {
+        return rtcm3::ecef_to_geodetic(m_station.x, m_station.y, m_station.z);
+    }
+
+    const station_position& stream_profile::station() const noexcept
+    {
+        return m_station;
+    }
+
+    std::string stream_profile::str(std::string_view mount, const location& fallback) const
+    {
+        std::string details{};
+        for (std::size_t t = 1; t < m_types.size(); ++t) {
+            if (m_types.test(t)) {
+                details.append(details.empty() ? "" : ",").append(std::to_string(t));
+            }
+        }
+
+        std::string systems{};
+        bool observations = false;
+        auto add_system = [&systems](std::string_view name) {
+            if (systems.find(name) == std::string::npos) {
+                systems.append(systems.empty() ? "" : "+").append(name);
+            }
+        };
+        for (const auto& gnss : observation_messages) {
+            for (std::uint16_t t = gnss.first; t <= gnss.last; ++t) {
+                if (m_types.test(t)) {
+                    add_system(gnss.name);
+                    observations = true;
+                    break;
+                }
+            }
+        }
+        if (!observations && m_has_position) {
+            if (m_station.gps) add_system("GPS");
+            if (m_station.glonass) add_system("GLONASS");
+            if (m_station.galileo) add_system("Galileo");
+        }
+
+        location pos = m_has_position ? position() : fallback;
+        char coordinates[64];
+        std::snprintf(coordinates, sizeof(coordinates), "%.6f;%.6f", pos.Latitude, pos.Longitude);
+
+        // mountpoint;identifier;format;format-details;carrier;nav-system;network;country;latitude;longitude;
+        // nmea;solution;generator;compr-encryp;authentication;fee;bitrate;misc
+        std::string line{};
+        line.append(mount).append(";").append(mount)
+            .append(m_types.none() ? ";;" : ";RTCM 3;").append(details)
+            .append(observations ? ";2;" : ";0;").append(systems)
+            .append(";none;;").append(coordinates)
+            .append(";0;0;VrsTunnel;none;B;N;0;");
+        return line;
+    }
+}
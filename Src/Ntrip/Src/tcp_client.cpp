@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+
 #include "tcp_client.hpp"
+#include "resolver.hpp"
 
 namespace VrsTunnel::Ntrip
 {
@@ -13,50 +19,112 @@ namespace VrsTunnel::Ntrip
     
     [[nodiscard]] io_status tcp_client::connect(std::string address, int port)
     {
-        struct addrinfo hints;
-        ::memset(&hints, 0, sizeof(hints));
-        struct addrinfo *result = nullptr, *rp = nullptr;
-        int sfd;
+        return connect(address, port, default_timeout);
+    }
 
-        /* Obtain address(es) matching host/port */
-        // memset(&hints, 0, sizeof(struct addrinfo));
-        hints.ai_family     = AF_UNSPEC;    /* Allow IPv4 or IPv6 */
-        hints.ai_socktype   = SOCK_STREAM;  /* TCP socket */
-        hints.ai_flags      = 0;
-        hints.ai_protocol   = 0;            /* Any protocol */
+    [[nodiscard]] io_status tcp_client::connect(std::string address, int port,
+        std::chrono::milliseconds timeout, std::chrono::milliseconds attempt_delay)
+    {
+        /* name service is asked by the resolver thread, its cache answers most reconnects */
+        auto start = std::chrono::steady_clock::now();
+        std::vector<endpoint> endpoints{};
+        if (resolver::shared().resolve(address, port, endpoints, timeout) != io_status::Success) {
+            return io_status::Error;
+        }
+        auto left = timeout - std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        if (left.count() <= 0) {
+            return io_status::Error;
+        }
+        return connect(endpoints, left, attempt_delay);
+    }
 
-        constexpr int psize = 10;
-        char port_c[psize + 1] = { 0 };
-        snprintf(port_c, psize, "%d", port);
-        int s = getaddrinfo(address.c_str(), port_c, &hints, &result);
-        if (s != 0) {
+    [[nodiscard]] io_status tcp_client::connect(const std::vector<endpoint>& endpoints,
+        std::chrono::milliseconds timeout, std::chrono::milliseconds attempt_delay)
+    {
+        if (endpoints.empty()) {
             return io_status::Error;
         }
+        using clock = std::chrono::steady_clock;
+        clock::time_point now = clock::now();
+        clock::time_point deadline = now + timeout;
 
-        /* getaddrinfo() returns a list of address structures.
-        Try each address until we successfully connect(2).
-        If socket(2) (or connect(2)) fails, we (close the socket
-        and) try the next address. */
-        for (rp = result; rp != nullptr; rp = rp->ai_next) {
-            sfd = socket(rp->ai_family, rp->ai_socktype,
-                            rp->ai_protocol);
-            if (sfd == -1)
-                continue;
+        /* families are interleaved starting with the preferred one */
+        std::vector<const endpoint*> order{};
+        std::vector<const endpoint*> others{};
+        for (const auto& ep : endpoints) {
+            (ep.address.ss_family == endpoints.front().address.ss_family ? order : others).push_back(&ep);
+        }
+        for (std::size_t i = 0; i < others.size(); ++i) {
+            order.insert(order.begin() + std::min(order.size(), 2 * i + 1), others[i]);
+        }
 
-            if (::connect(sfd, rp->ai_addr, rp->ai_addrlen) != -1) {
-                break;                      /* Success */
+        std::vector<struct pollfd> attempts{};
+        std::size_t next = 0;
+        clock::time_point next_start = now;
+        int winner = -1;
+        while (winner < 0 && now < deadline) {
+            if (next < order.size() && (now >= next_start || attempts.empty())) {
+                const endpoint& ep = *order[next++];
+                next_start = now + attempt_delay;
+                int sfd = socket(ep.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (sfd == -1) {
+                    continue;
+                }
+                if (::connect(sfd, reinterpret_cast<const struct sockaddr*>(&ep.address), ep.length) == 0) {
+                    winner = sfd;
+                }
+                else if (errno == EINPROGRESS) {
+                    attempts.push_back(pollfd{sfd, POLLOUT, 0});
+                }
+                else {
+                    ::close(sfd);
+                    next_start = now;   /* refused at once, the next address is tried immediately */
+                }
+                now = clock::now();
+                continue;
+            }
+            if (attempts.empty()) {
+                break;                  /* No address succeeded */
             }
 
-            ::close(sfd);
+            clock::time_point wake = next < order.size() ? std::min(deadline, next_start) : deadline;
+            auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(wake - now);
+            struct timespec ts{};
+            ts.tv_sec = std::max<long long>(left.count(), 0) / 1000000000;
+            ts.tv_nsec = std::max<long long>(left.count(), 0) % 1000000000;
+            int n = ::ppoll(attempts.data(), attempts.size(), &ts, nullptr);
+            if (n < 0 && errno != EINTR) {
+                break;
+            }
+            for (auto it = attempts.begin(); n > 0 && it != attempts.end(); ) {
+                if (it->revents == 0) {
+                    ++it;
+                    continue;
+                }
+                int error = 0;
+                socklen_t len = sizeof(error);
+                if (::getsockopt(it->fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+                    winner = it->fd;
+                    it = attempts.erase(it);
+                    break;
+                }
+                ::close(it->fd);
+                it = attempts.erase(it);
+                next_start = clock::now(); /* failed attempt starts the next one */
+            }
+            now = clock::now();
         }
-        if (result != nullptr) {
-            freeaddrinfo(result);           /* No longer needed */
+        for (const auto& attempt : attempts) {
+            ::close(attempt.fd);        /* the race is over */
         }
-        if (rp == nullptr) {                /* No address succeeded */
+        if (winner < 0) {
             return io_status::Error;
         }
 
-        m_sockfd = sfd;
+        int flags = ::fcntl(winner, F_GETFL);
+        ::fcntl(winner, F_SETFL, flags & ~O_NONBLOCK);
+        m_sockfd = winner;
         return io_status::Success;
     }
 
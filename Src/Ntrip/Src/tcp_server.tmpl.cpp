@@ -6,5 +6,6 @@
 namespace VrsTunnel::Ntrip
 {
     template bool tcp_server::start(int, accept_listener&);
-    template void tcp_server::run_accepting(struct sockaddr*, int, accept_listener&);
-}
\ No newline at end of file
+    template bool tcp_server::start(int, std::vector<std::unique_ptr<accept_listener>>&);
+    template void tcp_server::run_accepting(reactor&, accept_listener&, int);
+}
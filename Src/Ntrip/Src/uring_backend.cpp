@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define VRS_TUNNEL_HAS_IO_URING
+#endif
+
+#include "uring_backend.hpp"
+
+namespace VrsTunnel::Ntrip
+{
+#if defined(VRS_TUNNEL_HAS_IO_URING) && defined(__NR_io_uring_setup)
+    namespace
+    {
+        constexpr unsigned ring_entries = 2;    /**< One send is in flight at a time */
+
+        template<typename T>
+        T* at(void* base, unsigned offset) noexcept
+        {
+            return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+        }
+    }
+
+    uring_backend::uring_backend(int sockfd) :
+        m_sockfd{sockfd}
+    {
+        struct io_uring_params params{};
+        ++m_syscalls;
+        m_ringfd = static_cast<int>(::syscall(__NR_io_uring_setup, ring_entries, &params));
+        if (m_ringfd < 0) {
+            m_ringfd = -1;
+            throw std::runtime_error("io_uring is not available");
+        }
+        m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+        }
+        m_sq_ring = ::mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, m_ringfd, IORING_OFF_SQ_RING);
+        if (m_sq_ring == MAP_FAILED) {
+            m_sq_ring = nullptr;
+            release();
+            throw std::runtime_error("io_uring submission queue not mapped");
+        }
+        if (single_mmap) {
+            m_cq_ring = m_sq_ring;
+        }
+        else {
+            m_cq_ring = ::mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, m_ringfd, IORING_OFF_CQ_RING);
+            if (m_cq_ring == MAP_FAILED) {
+                m_cq_ring = nullptr;
+                release();
+                throw std::runtime_error("io_uring completion queue not mapped");
+            }
+        }
+        m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, m_ringfd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            release();
+            throw std::runtime_error("io_uring entries not mapped");
+        }
+        m_sqes = static_cast<struct io_uring_sqe*>(sqes);
+        m_syscalls += single_mmap ? 2 : 3;
+
+        m_sq_tail = at<unsigned>(m_sq_ring, params.sq_off.tail);
+        m_sq_mask = at<unsigned>(m_sq_ring, params.sq_off.ring_mask);
+        m_sq_array = at<unsigned>(m_sq_ring, params.sq_off.array);
+        m_cq_head = at<unsigned>(m_cq_ring, params.cq_off.head);
+        m_cq_tail = at<unsigned>(m_cq_ring, params.cq_off.tail);
+        m_cq_mask = at<unsigned>(m_cq_ring, params.cq_off.ring_mask);
+        m_cqes = at<struct io_uring_cqe>(m_cq_ring, params.cq_off.cqes);
+    }
+
+    uring_backend::~uring_backend()
+    {
+        [[maybe_unused]] ssize_t res = end();
+        release();
+    }
+
+    void uring_backend::release() noexcept
+    {
+        if (m_sqes != nullptr) {
+            ::munmap(m_sqes, m_sqes_size);
+            m_sqes = nullptr;
+        }
+        if (m_cq_ring != nullptr && m_cq_ring != m_sq_ring) {
+            ::munmap(m_cq_ring, m_cq_ring_size);
+        }
+        m_cq_ring = nullptr;
+        if (m_sq_ring != nullptr) {
+            ::munmap(m_sq_ring, m_sq_ring_size);
+            m_sq_ring = nullptr;
+        }
+        if (m_ringfd != -1) {
+            ::close(m_ringfd);
+            m_ringfd = -1;
+        }
+    }
+
+    [[nodiscard]] io_status uring_backend::write(const struct iovec* iov, std::size_t count)
+    {
+        if (m_in_flight) {
+            return io_status::Error; // end() was not called
+        }
+        if (count > max_iov) {
+            return io_status::Error;
+        }
+        std::copy(iov, iov + count, m_iov.begin());
+        m_count = count;
+        m_first = advance(m_iov.data(), 0, m_count, 0);
+        m_sent = 0;
+        m_failed = false;
+        if (m_first < m_count) {
+            submit();
+        }
+        return m_failed ? io_status::Error : io_status::Success;
+    }
+
+    void uring_backend::submit() noexcept
+    {
+        unsigned tail = *m_sq_tail; // the only producer
+        unsigned index = tail & *m_sq_mask;
+        struct io_uring_sqe* sqe = &m_sqes[index];
+        ::memset(sqe, 0, sizeof(*sqe));
+        m_msg = {};
+        m_msg.msg_iov = m_iov.data() + m_first;
+        m_msg.msg_iovlen = m_count - m_first;
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = m_sockfd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&m_msg);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        m_sq_array[index] = index;
+        __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        int res = -1;
+        do {
+            ++m_syscalls;
+            res = static_cast<int>(::syscall(__NR_io_uring_enter, m_ringfd, 1, 0, 0, nullptr, 0));
+        } while (res < 0 && errno == EINTR);
+        if (res != 1) {
+            m_failed = true;
+            return;
+        }
+        m_in_flight = true;
+    }
+
+    void uring_backend::reap(bool wait) noexcept
+    {
+        unsigned head = *m_cq_head; // the only consumer
+        if (wait && head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+            ++m_syscalls;
+            if (::syscall(__NR_io_uring_enter, m_ringfd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+                    && errno != EINTR) {
+                m_in_flight = false; // the ring is broken
+                m_failed = true;
+                return;
+            }
+        }
+        if (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+            return;
+        }
+        int res = m_cqes[head & *m_cq_mask].res;
+        __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+        m_in_flight = false;
+        if (res == -EINTR || res == -EAGAIN) {
+            submit();
+        }
+        else if (res < 0) {
+            m_failed = true;
+        }
+        else {
+            m_sent += res;
+            m_first = advance(m_iov.data(), m_first, m_count, res);
+            if (m_first < m_count) {
+                submit(); // short write of a stream socket
+            }
+        }
+    }
+
+    [[nodiscard]] io_status uring_backend::check() noexcept
+    {
+        if (m_in_flight) {
+            reap(false);
+        }
+        if (m_failed) {
+            return io_status::Error;
+        }
+        return m_in_flight ? io_status::InProgress : io_status::Success;
+    }
+
+    [[nodiscard]] ssize_t uring_backend::end() noexcept
+    {
+        while (m_in_flight) {
+            reap(true); // the kernel must not touch the buffer after this
+        }
+        ssize_t res = m_failed ? -1 : static_cast<ssize_t>(m_sent);
+        m_count = 0;
+        m_first = 0;
+        m_sent = 0;
+        m_failed = false;
+        return res;
+    }
+#else
+    uring_backend::uring_backend(int sockfd) :
+        m_sockfd{sockfd}
+    {
+        throw std::runtime_error("io_uring is not supported by the build");
+    }
+
+    uring_backend::~uring_backend() = default;
+    void uring_backend::submit() noexcept { }
+    void uring_backend::reap(bool) noexcept { }
+    void uring_backend::release() noexcept { }
+    [[nodiscard]] io_status uring_backend::write(const struct iovec*, std::size_t) { return io_status::Error; }
+    [[nodiscard]] io_status uring_backend::check() noexcept { return io_status::Error; }
+    [[nodiscard]] ssize_t uring_backend::end() noexcept { return -1; }
+#endif
+
+    io_engine uring_backend::engine() const noexcept
+    {
+        return io_engine::io_uring;
+    }
+}
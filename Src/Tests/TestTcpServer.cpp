@@ -15,19 +15,25 @@
 class accept_listener_test
 {
 public:
-    void OnClientConnected(std::unique_ptr<VrsTunnel::Ntrip::tcp_client> client)
+    void OnClientConnected(const std::shared_ptr<VrsTunnel::Ntrip::connection>& client)
     {
         if (client) {
             --clinet_count;
         }
     };
+    void OnDataReceived(VrsTunnel::Ntrip::connection& client)
+    {
+        client.consume(client.input().size());
+    };
+    void OnClientDisconnected([[maybe_unused]] VrsTunnel::Ntrip::connection& client) { };
     std::atomic_int clinet_count{0};
 };
 
 namespace VrsTunnel::Ntrip
 {
     template bool tcp_server::start(int, accept_listener_test&);
-    template void tcp_server::run_accepting(struct sockaddr*, int, accept_listener_test&);
+    template bool tcp_server::start(int, std::vector<std::unique_ptr<accept_listener_test>>&);
+    template void tcp_server::run_accepting(reactor&, accept_listener_test&, int);
 }
 
 constexpr static int tcp_port = 2103;
@@ -64,6 +70,34 @@ TEST(TservTestGroup, ClientCountTest)
     ts.stop();
 };
 
+TEST(TservTestGroup, ShardedCountTest)
+{
+    constexpr int shards = 4;
+    std::vector<std::unique_ptr<accept_listener_test>> listeners{};
+    for (int i = 0; i < shards; ++i) {
+        listeners.emplace_back(std::make_unique<accept_listener_test>());
+    }
+    bool isOk = ts.start(tcp_port, listeners);
+    CHECK_TRUE(isOk);
+
+    auto connected = [&listeners]() -> int {
+        int sum = 0;
+        for (const auto& l : listeners) {
+            sum -= l->clinet_count;
+        }
+        return sum;
+    };
+    for(int i = 1; i <= total * shards; ++i) {
+        VrsTunnel::Ntrip::tcp_client tc{};
+        auto stat = tc.connect("localhost", tcp_port);
+        CHECK_TRUE(stat == VrsTunnel::Ntrip::io_status::Success);
+        tc.close();
+        while (i != connected()) { }
+    }
+    ts.stop();
+    CHECK_EQUAL(total * shards, connected());
+};
+
 
 TEST_GROUP(ServThTestGroup)
 {
@@ -79,30 +113,22 @@ TEST_GROUP(ServThTestGroup)
 
 TEST(ServThTestGroup, ThVecTest)
 {
+    // accept_listener belongs to its reactor thread, only the client registry is read concurrently
     VrsTunnel::Ntrip::accept_listener al{};
     constexpr int size = 111;
-    std::vector<std::future<void>> inserters{size};
-    std::vector<std::promise<void>> ready_elems;
-    std::promise<void> go{};
-    std::shared_future<void> ready(go.get_future());
-    for (int i = 0; i < size; ++i) {
-        ready_elems.emplace_back(std::promise<void>{});
-    }
-    for (int i = 0; i < size; ++i) {
-        inserters[i] = std::async(std::launch::async,
-            [ready, &al, i, &ready_elems] () -> void
-            {
-                ready_elems.at(i).set_value();
-                ready.wait();
-                al.OnClientConnected(std::make_unique<VrsTunnel::Ntrip::tcp_client>(-i));
-            });
-    }
-    for (int i = 0; i < size; ++i) {
-        ready_elems.at(i).get_future().wait();
-    }
-    go.set_value();
+    std::atomic<bool> done{false};
+    auto reader = std::async(std::launch::async, [&al, &done] () -> bool {
+        bool ok = true;
+        while (!done.load()) {
+            ok = ok && al.clients().size() <= static_cast<std::size_t>(size);
+        }
+        return ok;
+    });
     for (int i = 0; i < size; ++i) {
-        inserters.at(i).get();
+        al.OnClientConnected(std::make_shared<VrsTunnel::Ntrip::connection>(
+            std::make_unique<VrsTunnel::Ntrip::tcp_client>(-i)));
     }
-    CHECK_EQUAL(size, al.get_asyncs().size());
-}
\ No newline at end of file
+    done.store(true);
+    CHECK_TRUE(reader.get());
+    CHECK_EQUAL(size, al.get_connections().size());
+}
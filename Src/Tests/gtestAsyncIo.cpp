@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+
+#include "async_io.hpp"
+
+namespace
+{
+    /**
+     * Writes the block through the engine to a socket pair drained by another thread
+     */
+    void transfer(VrsTunnel::Ntrip::io_engine engine, const std::string& block)
+    {
+        using namespace VrsTunnel::Ntrip;
+        int fds[2];
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        std::string received{};
+        std::thread reader([&received, &block, fd = fds[1]] {
+            char buf[4096];
+            while (received.size() < block.size()) {
+                ssize_t n = ::read(fd, buf, sizeof(buf));
+                if (n <= 0) {
+                    break;
+                }
+                received.append(buf, n);
+            }
+        });
+        {
+            async_io aio{fds[0], engine};
+            ASSERT_EQ(io_status::Success, aio.write(block.data(), static_cast<int>(block.size())));
+            io_status res = io_status::InProgress;
+            while ((res = aio.check()) == io_status::InProgress) {
+                std::this_thread::yield();
+            }
+            EXPECT_EQ(io_status::Success, res);
+            EXPECT_EQ(static_cast<ssize_t>(block.size()), aio.end());
+            EXPECT_GT(aio.syscalls(), 0U);
+        }
+        reader.join();
+        EXPECT_EQ(block, received);
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+}
+
+TEST(testAsyncIo, allEngines)
+{
+    using namespace VrsTunnel::Ntrip;
+    std::string small{"$GPGGA,small\r\n"};
+    std::string large(1 << 20, 'x');
+    for (std::size_t i = 0; i < large.size(); i += 7) {
+        large[i] = static_cast<char>('a' + i % 26);
+    }
+    for (auto engine : {io_engine::posix_aio, io_engine::epoll, io_engine::io_uring}) {
+        transfer(engine, small);
+        transfer(engine, large);
+    }
+}
+
+TEST(testAsyncIo, brokenPipe)
+{
+    using namespace VrsTunnel::Ntrip;
+    for (auto engine : {io_engine::epoll, io_engine::io_uring}) {
+        int fds[2];
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        ::close(fds[1]);
+        async_io aio{fds[0], engine};
+        std::string block(100, 'x');
+        if (aio.write(block.data(), static_cast<int>(block.size())) == io_status::Success) {
+            io_status res = io_status::InProgress;
+            while ((res = aio.check()) == io_status::InProgress) { }
+            EXPECT_EQ(io_status::Error, res);
+        }
+        EXPECT_EQ(-1, aio.end());
+        ::close(fds[0]);
+    }
+}
+
+TEST(testAsyncIo, engineNames)
+{
+    using namespace VrsTunnel::Ntrip;
+    io_engine engine{io_engine::epoll};
+    EXPECT_TRUE(io_backend::parse("uring", engine));
+    EXPECT_EQ(io_engine::io_uring, engine);
+    EXPECT_TRUE(io_backend::parse("aio", engine));
+    EXPECT_EQ(io_engine::posix_aio, engine);
+    EXPECT_FALSE(io_backend::parse("kqueue", engine));
+    EXPECT_EQ(io_engine::posix_aio, engine);
+}
+
+TEST(testAsyncIo, gatherQueue)
+{
+    using namespace VrsTunnel::Ntrip;
+    for (auto engine : {io_engine::posix_aio, io_engine::epoll, io_engine::io_uring}) {
+        int fds[2];
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        std::vector<std::string> messages{};
+        std::string expected{};
+        for (int i = 0; i < 100; ++i) {
+            messages.emplace_back("message " + std::to_string(i) + ";");
+        }
+        async_io aio{fds[0], engine};
+        auto setup = aio.syscalls();
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            if (i % 2 == 0) {
+                aio.enqueue(messages[i].data(), messages[i].size());
+            }
+            else {
+                aio.enqueue(shared_buffer::make(messages[i].data(), messages[i].size()));
+            }
+            expected += messages[i];
+        }
+        EXPECT_EQ(expected.size(), aio.pending());
+        EXPECT_EQ(io_status::Success, aio.flush());
+        // a write before end() is queued behind, it does not replace anything
+        std::string tail{"tail"};
+        EXPECT_EQ(io_status::Success, aio.write(tail.data(), static_cast<int>(tail.size())));
+        expected += tail;
+        io_status res = io_status::InProgress;
+        while ((res = aio.check()) == io_status::InProgress) { }
+        EXPECT_EQ(io_status::Success, res);
+        EXPECT_EQ(0U, aio.pending());
+        EXPECT_EQ(static_cast<ssize_t>(expected.size()), aio.end());
+        if (engine != io_engine::posix_aio) {
+            // 64 buffers in the first gather write, the rest and the tail in the second one
+            EXPECT_EQ(2U, aio.syscalls() - setup);
+        }
+
+        std::string received(expected.size(), '\0');
+        std::size_t got = 0;
+        while (got < received.size()) {
+            ssize_t n = ::read(fds[1], received.data() + got, received.size() - got);
+            ASSERT_GT(n, 0);
+            got += n;
+        }
+        EXPECT_EQ(expected, received);
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+}
+
+TEST(testAsyncIo, receiveIntoBuffer)
+{
+    using namespace VrsTunnel::Ntrip;
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    async_io aio{fds[0]};
+    char buffer[8];
+    std::size_t received = 1;
+    EXPECT_EQ(io_status::InProgress, aio.receive(buffer, sizeof(buffer), received));
+    EXPECT_EQ(0U, received);
+
+    std::string data{"0123456789"};
+    ASSERT_EQ(static_cast<ssize_t>(data.size()), ::write(fds[1], data.data(), data.size()));
+    EXPECT_EQ(io_status::Success, aio.receive(buffer, sizeof(buffer), received));
+    EXPECT_EQ(std::string("01234567"), std::string(buffer, received));
+    EXPECT_EQ(io_status::Success, aio.receive(buffer, sizeof(buffer), received));
+    EXPECT_EQ(std::string("89"), std::string(buffer, received));
+    EXPECT_EQ(io_status::InProgress, aio.receive(buffer, sizeof(buffer), received));
+    EXPECT_FALSE(aio.eof());
+
+    ::close(fds[1]);
+    EXPECT_EQ(io_status::Error, aio.receive(buffer, sizeof(buffer), received));
+    EXPECT_EQ(0U, received);
+    EXPECT_TRUE(aio.eof());
+    ::close(fds[0]);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+
+#include "connection.hpp"
+
+namespace
+{
+    /**
+     * Connection over socket pair with small send buffer, the peer never reads
+     */
+    struct stalled_pair
+    {
+        std::unique_ptr<VrsTunnel::Ntrip::connection> caster{};
+        int rover{-1};
+
+        explicit stalled_pair(VrsTunnel::Ntrip::overflow_policy policy)
+        {
+            int fds[2];
+            EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+            int size = 4096;
+            ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+            caster = std::make_unique<VrsTunnel::Ntrip::connection>(
+                std::make_unique<VrsTunnel::Ntrip::tcp_client>(fds[0]));
+            rover = fds[1];
+            VrsTunnel::Ntrip::queue_limits limits{};
+            limits.high_bytes = (1 << 16) + 1000;
+            limits.high_frames = 4;
+            limits.low_bytes = 0;
+            limits.low_frames = 0;
+            limits.policy = policy;
+            limits.stall_timeout = std::chrono::milliseconds(50);
+            caster->set_limits(limits);
+        }
+        ~stalled_pair()
+        {
+            ::close(rover);
+        }
+
+        void fill()
+        {
+            std::string block(1 << 16, 'x');
+            while (caster->send(block.data(), block.size()) == VrsTunnel::Ntrip::io_status::Success) { }
+        }
+    };
+}
+
+TEST(testConnection, dropOldest)
+{
+    using namespace VrsTunnel::Ntrip;
+    stalled_pair sp{overflow_policy::drop_oldest};
+    sp.fill();
+    std::size_t head = sp.caster->pending();
+    std::string frame(100, 'f');
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(io_status::InProgress, sp.caster->send(frame.data(), frame.size()));
+    }
+    // partially sent head is kept, then at most 3 newest frames
+    EXPECT_EQ(head + 3 * frame.size(), sp.caster->pending());
+    EXPECT_EQ(7U, sp.caster->stats().dropped_frames);
+    EXPECT_EQ(700U, sp.caster->stats().dropped_bytes);
+    EXPECT_EQ(1U, sp.caster->stats().stalls);
+    EXPECT_TRUE(sp.caster->is_stalled());
+}
+
+TEST(testConnection, skipEpoch)
+{
+    using namespace VrsTunnel::Ntrip;
+    stalled_pair sp{overflow_policy::skip_epoch};
+    sp.fill();
+    std::size_t head = sp.caster->pending();
+    std::string frame(100, 'f');
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(io_status::InProgress, sp.caster->send(frame.data(), frame.size()));
+    }
+    // 3 frames dropped by the 4th one, the 5th is queued after it
+    EXPECT_EQ(head + 2 * frame.size(), sp.caster->pending());
+    EXPECT_EQ(3U, sp.caster->stats().dropped_frames);
+}
+
+TEST(testConnection, skipToNextEpoch)
+{
+    using namespace VrsTunnel::Ntrip;
+    stalled_pair sp{overflow_policy::skip_epoch};
+    sp.fill();
+    std::size_t head = sp.caster->pending();
+    auto epoch = shared_buffer::make(std::string(100, 'e').data(), 100);
+    auto frame = shared_buffer::make(std::string(100, 'f').data(), 100);
+    EXPECT_EQ(io_status::InProgress, sp.caster->send(epoch, true));
+    EXPECT_EQ(io_status::InProgress, sp.caster->send(frame));
+    EXPECT_EQ(io_status::InProgress, sp.caster->send(frame));
+    // the epoch is dropped, so are its later frames
+    EXPECT_EQ(io_status::InProgress, sp.caster->send(frame));
+    EXPECT_EQ(head, sp.caster->pending());
+    EXPECT_EQ(io_status::InProgress, sp.caster->send(frame));
+    EXPECT_EQ(head, sp.caster->pending());
+    EXPECT_EQ(5U, sp.caster->stats().dropped_frames);
+    // delivery resumes with the next epoch
+    EXPECT_EQ(io_status::InProgress, sp.caster->send(epoch, true));
+    EXPECT_EQ(head + 100, sp.caster->pending());
+}
+
+TEST(testConnection, disconnectAfterStall)
+{
+    using namespace VrsTunnel::Ntrip;
+    stalled_pair sp{overflow_policy::disconnect};
+    sp.fill();
+    std::string frame(100, 'f');
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(io_status::InProgress, sp.caster->send(frame.data(), frame.size()));
+    }
+    EXPECT_FALSE(sp.caster->disconnect_stalled(std::chrono::steady_clock::now()));
+    EXPECT_FALSE(sp.caster->is_closing());
+    // no more data, the timer closes the connection
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_TRUE(sp.caster->disconnect_stalled(std::chrono::steady_clock::now()));
+    EXPECT_TRUE(sp.caster->is_closing());
+    EXPECT_EQ(0U, sp.caster->pending());
+}
+
+TEST(testConnection, stallEndsAfterDrain)
+{
+    using namespace VrsTunnel::Ntrip;
+    stalled_pair sp{overflow_policy::drop_oldest};
+    sp.fill();
+    std::string frame(100, 'f');
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(io_status::InProgress, sp.caster->send(frame.data(), frame.size()));
+    }
+    EXPECT_TRUE(sp.caster->is_stalled());
+    char buf[4096];
+    while (sp.caster->flush() != io_status::Success) {
+        while (::read(sp.rover, buf, sizeof(buf)) > 0) { }
+    }
+    EXPECT_FALSE(sp.caster->is_stalled());
+}
+
+TEST(testConnection, vectoredSend)
+{
+    using namespace VrsTunnel::Ntrip;
+    stalled_pair sp{overflow_policy::drop_oldest};
+    std::string header(100, 'h');
+    std::string body(3 * 4096, 'b');
+    std::array<std::shared_ptr<const shared_buffer>, 2> chunks {
+        shared_buffer::make(header.data(), header.size()),
+        shared_buffer::make(body.data(), body.size()) };
+    // the rest of the body does not fit into the socket and is queued
+    EXPECT_EQ(io_status::InProgress, sp.caster->send(chunks.data(), chunks.size()));
+    EXPECT_GT(sp.caster->pending(), 0U);
+    EXPECT_LT(sp.caster->pending(), body.size());
+
+    std::string received{};
+    char buf[4096];
+    io_status res = io_status::InProgress;
+    while (res != io_status::Success) {
+        ssize_t n = 0;
+        while ((n = ::read(sp.rover, buf, sizeof(buf))) > 0) {
+            received.append(buf, n);
+        }
+        res = sp.caster->flush();
+    }
+    ssize_t n = 0;
+    while ((n = ::read(sp.rover, buf, sizeof(buf))) > 0) {
+        received.append(buf, n);
+    }
+    EXPECT_EQ(header + body, received);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "epoch_assembler.hpp"
+#include "reactor.hpp"
+#include "accept_listener.hpp"
+
+namespace
+{
+    using namespace VrsTunnel::Ntrip;
+    using ms = std::chrono::milliseconds;
+
+    /**
+     * Frame with the message number and a tag byte, CRC is not checked here
+     */
+    struct test_frame
+    {
+        std::vector<std::uint8_t> bytes;
+        rtcm3_frame frame() const { return rtcm3_frame{bytes.data(), bytes.size()}; }
+    };
+
+    test_frame make(std::uint16_t type, std::uint8_t tag)
+    {
+        return test_frame{{0xD3, 0x00, 0x03, static_cast<std::uint8_t>(type >> 4),
+            static_cast<std::uint8_t>((type & 0xF) << 4), tag, 0, 0, 0}};
+    }
+
+    msm_header msm(msm_system system, std::uint32_t epoch, bool multiple)
+    {
+        msm_header h{};
+        h.system = system;
+        h.epoch_time = epoch;
+        h.multiple = multiple;
+        return h;
+    }
+
+    struct plain_listener
+    {
+        void OnClientConnected(const std::shared_ptr<connection>&) { }
+        void OnDataReceived(connection&) { }
+        void OnClientDisconnected(connection&) { }
+    };
+}
+
+TEST(testEpochAssembler, completeEpoch)
+{
+    epoch_assembler bundle{ms(50)};
+    auto t = epoch_assembler::clock::time_point{} + ms(1000);
+    EXPECT_FALSE(bundle.is_open());
+    EXPECT_EQ(epoch_assembler::clock::time_point::max(), bundle.deadline());
+
+    auto f1005 = make(1005, 1);
+    EXPECT_EQ(io_status::InProgress, bundle.add(f1005.frame(), nullptr, t));
+    EXPECT_FALSE(bundle.is_open());     // a message between epochs does not start one
+
+    auto gps = msm(msm_system::gps, 5000, true);
+    auto glonass = msm(msm_system::glonass, (5000 + 3 * 3'600'000 - 18'000), true);
+    auto galileo = msm(msm_system::galileo, 5000, false);
+    auto f1077 = make(1077, 2), f1087 = make(1087, 3), f1097 = make(1097, 4);
+    EXPECT_EQ(io_status::InProgress, bundle.add(f1077.frame(), &gps, t));
+    EXPECT_TRUE(bundle.is_open());
+    EXPECT_EQ(t + ms(50), bundle.deadline());
+    EXPECT_FALSE(bundle.other_epoch(glonass));
+    EXPECT_EQ(io_status::InProgress, bundle.add(f1087.frame(), &glonass, t + ms(5)));
+    EXPECT_EQ(t + ms(50), bundle.deadline());
+    EXPECT_EQ(io_status::Success, bundle.add(f1097.frame(), &galileo, t + ms(6)));
+
+    std::string_view bytes = bundle.batch().bytes();
+    ASSERT_EQ(4 * f1005.bytes.size(), bytes.size());
+    EXPECT_EQ(1, bytes[5]);
+    EXPECT_EQ(4, bytes[3 * 9 + 5]);
+
+    bundle.clear();
+    EXPECT_TRUE(bundle.batch().empty());
+    EXPECT_FALSE(bundle.is_open());
+    EXPECT_EQ(epoch_assembler::clock::time_point::max(), bundle.deadline());
+}
+
+TEST(testEpochAssembler, lostLastMessage)
+{
+    epoch_assembler bundle{ms(20)};
+    auto t = epoch_assembler::clock::time_point{};
+    auto first = msm(msm_system::gps, 1000, true);
+    auto next = msm(msm_system::gps, 2000, true);
+    auto f1077 = make(1077, 1);
+    EXPECT_EQ(io_status::InProgress, bundle.add(f1077.frame(), &first, t));
+    EXPECT_FALSE(bundle.other_epoch(first));
+    EXPECT_TRUE(bundle.other_epoch(next));
+    EXPECT_EQ(t + ms(20), bundle.deadline());
+
+    bundle.clear();     // sent by the deadline or before the next epoch
+    EXPECT_FALSE(bundle.other_epoch(next));
+    EXPECT_EQ(io_status::InProgress, bundle.add(f1077.frame(), &next, t + ms(1000)));
+    EXPECT_EQ(t + ms(1020), bundle.deadline());
+}
+
+TEST(testEpochAssembler, reactorTimerDetection)
+{
+    EXPECT_FALSE(has_timer<plain_listener>::value);
+    EXPECT_TRUE(has_timer<accept_listener>::value);
+}
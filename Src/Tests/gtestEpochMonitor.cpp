@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "epoch_monitor.hpp"
+
+namespace
+{
+    using VrsTunnel::Ntrip::epoch_monitor;
+    using VrsTunnel::Ntrip::msm_header;
+    using VrsTunnel::Ntrip::msm_system;
+    using ms = std::chrono::milliseconds;
+
+    msm_header msm(msm_system system, std::uint32_t epoch, bool multiple, std::uint8_t satellites, std::uint8_t cells)
+    {
+        msm_header h{};
+        h.system = system;
+        h.epoch_time = epoch;
+        h.multiple = multiple;
+        h.satellites = satellites;
+        h.cells = cells;
+        return h;
+    }
+
+    /**
+     * Epoch of GPS, GLONASS and BeiDou messages, the time is GPS milliseconds of the week
+     */
+    void add_epoch(epoch_monitor& monitor, std::uint32_t gps_tow, epoch_monitor::clock::time_point arrival)
+    {
+        const std::uint32_t day = 86'400'000;
+        std::uint32_t dow = gps_tow / day;
+        std::uint32_t glonass_tod = (gps_tow % day + 3 * 3'600'000 - 18'000) % day;
+        monitor.add(msm(msm_system::gps, gps_tow, true, 10, 28), arrival);
+        monitor.add(msm(msm_system::glonass, dow << 27 | glonass_tod, true, 7, 14), arrival);
+        monitor.add(msm(msm_system::beidou, gps_tow - 14'000, false, 12, 30), arrival);
+    }
+}
+
+TEST(testEpochMonitor, dayTime)
+{
+    EXPECT_EQ(3'600'000U, epoch_monitor::day_time(msm(msm_system::gps, 86'400'000 * 2 + 3'600'000, false, 0, 0)));
+    EXPECT_EQ(3'600'000U, epoch_monitor::day_time(msm(msm_system::galileo, 3'600'000, false, 0, 0)));
+    EXPECT_EQ(3'600'000U, epoch_monitor::day_time(msm(msm_system::beidou, 3'586'000, false, 0, 0)));
+    EXPECT_EQ(3'600'000U, epoch_monitor::day_time(msm(msm_system::glonass, 5U << 27 | 14'382'000, false, 0, 0)));
+    // Moscow day starts 3 hours before GPS one
+    EXPECT_EQ(86'400'000U - 10'782'000U, epoch_monitor::day_time(msm(msm_system::glonass, 0, false, 0, 0)));
+}
+
+TEST(testEpochMonitor, epochsOfSeveralSystems)
+{
+    epoch_monitor monitor{};
+    EXPECT_EQ(0U, monitor.metrics().epochs);
+    auto t = epoch_monitor::clock::time_point{} + ms(1'000'000);
+    std::uint32_t tow = 86'400'000 * 3 - 2'000; // crosses GPS midnight
+    for (int i = 0; i < 5; ++i) {
+        add_epoch(monitor, tow + i * 1000, t + ms(i * 1000));
+    }
+    auto m = monitor.metrics();
+    EXPECT_EQ(5U, m.epochs);
+    EXPECT_EQ(29U, m.satellites);
+    EXPECT_EQ(72U, m.signals);
+    EXPECT_EQ(1000U, m.interval_ms);
+    EXPECT_EQ(0U, m.jitter_us);
+    EXPECT_EQ(0U, m.gaps);
+}
+
+TEST(testEpochMonitor, jitterAndGaps)
+{
+    epoch_monitor monitor{};
+    auto t = epoch_monitor::clock::time_point{};
+    add_epoch(monitor, 1000, t);
+    add_epoch(monitor, 2000, t + ms(1016));     // 16 ms late: J = 16 / 16
+    EXPECT_EQ(1000U, monitor.metrics().jitter_us);
+    add_epoch(monitor, 3000, t + ms(2000));     // 16 ms early
+    EXPECT_EQ(1937U, monitor.metrics().jitter_us);
+    EXPECT_EQ(0U, monitor.metrics().gaps);
+    add_epoch(monitor, 5000, t + ms(4000));     // one epoch lost
+    auto m = monitor.metrics();
+    EXPECT_EQ(4U, m.epochs);
+    EXPECT_EQ(2000U, m.interval_ms);
+    EXPECT_EQ(1U, m.gaps);
+    EXPECT_EQ(1816U, m.jitter_us);
+}
+
+TEST(testEpochMonitor, lostLastMessage)
+{
+    epoch_monitor monitor{};
+    auto t = epoch_monitor::clock::time_point{};
+    monitor.add(msm(msm_system::gps, 1000, true, 10, 20), t);
+    monitor.add(msm(msm_system::galileo, 1000, true, 8, 16), t);
+    EXPECT_EQ(0U, monitor.metrics().epochs);
+    // the next epoch closes the previous one
+    monitor.add(msm(msm_system::gps, 2000, true, 11, 22), t + ms(1000));
+    auto m = monitor.metrics();
+    EXPECT_EQ(1U, m.epochs);
+    EXPECT_EQ(18U, m.satellites);
+    EXPECT_EQ(36U, m.signals);
+}
+
+TEST(testEpochMonitor, multipleBitClearedPerSystem)
+{
+    epoch_monitor monitor{};
+    auto t = epoch_monitor::clock::time_point{};
+    for (std::uint32_t tow : {1000U, 2000U}) {
+        monitor.add(msm(msm_system::gps, tow, false, 10, 20), t + ms(tow));
+        monitor.add(msm(msm_system::galileo, tow, false, 8, 16), t + ms(tow));
+    }
+    auto m = monitor.metrics();
+    EXPECT_EQ(2U, m.epochs);
+    EXPECT_EQ(18U, m.satellites);
+    EXPECT_EQ(36U, m.signals);
+    EXPECT_EQ(1000U, m.interval_ms);
+}
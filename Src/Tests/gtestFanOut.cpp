@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+
+#include "fan_out.hpp"
+
+namespace
+{
+    /**
+     * Rover connection with the caster end wrapped into connection object
+     */
+    struct rover_pair
+    {
+        std::shared_ptr<VrsTunnel::Ntrip::connection> caster{};
+        int rover{-1};
+
+        rover_pair()
+        {
+            int fds[2];
+            EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+            caster = std::make_shared<VrsTunnel::Ntrip::connection>(
+                std::make_unique<VrsTunnel::Ntrip::tcp_client>(fds[0]));
+            rover = fds[1];
+        }
+        ~rover_pair()
+        {
+            ::close(rover);
+        }
+        rover_pair(const rover_pair&) = delete;
+        rover_pair& operator=(const rover_pair&) = delete;
+
+        std::string received()
+        {
+            char buf[256];
+            ssize_t n = ::read(rover, buf, sizeof(buf));
+            return n > 0 ? std::string(buf, n) : std::string();
+        }
+    };
+}
+
+TEST(testFanOut, publishToSubscribers)
+{
+    using namespace VrsTunnel::Ntrip;
+    fan_out fo{};
+    std::vector<rover_pair> rovers(3);
+    fo.subscribe("RTCM3", rovers[0].caster);
+    fo.subscribe("RTCM3", rovers[1].caster);
+    fo.subscribe("CMR", rovers[2].caster);
+    EXPECT_EQ(2UL, fo.subscribers("RTCM3"));
+
+    const std::string frame {"\xD3\x00\x13", 3};
+    auto chunk = shared_buffer::make(frame.data(), frame.size());
+    EXPECT_EQ(2UL, fo.publish("RTCM3", chunk));
+    EXPECT_EQ(frame, rovers[0].received());
+    EXPECT_EQ(frame, rovers[1].received());
+    EXPECT_EQ("", rovers[2].received());
+    EXPECT_EQ(0UL, fo.publish("NONE", "abc", 3));
+}
+
+TEST(testFanOut, queueSharesBuffer)
+{
+    using namespace VrsTunnel::Ntrip;
+    fan_out fo{};
+    std::vector<rover_pair> rovers(2);
+    for (auto& r : rovers) {
+        int size = 4096;
+        ::setsockopt(r.caster->get_sockfd(), SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+        fo.subscribe("RTCM3", r.caster);
+    }
+    std::string big(1 << 20, 'x');
+    auto chunk = shared_buffer::make(big.data(), big.size());
+    EXPECT_EQ(2UL, fo.publish("RTCM3", chunk));
+    // both rovers are stalled, their queues reference the same buffer
+    EXPECT_EQ(3L, chunk.use_count());
+    EXPECT_GT(rovers[0].caster->pending(), 0UL);
+    EXPECT_LT(rovers[0].caster->pending(), big.size());
+}
+
+TEST(testFanOut, unsubscribe)
+{
+    using namespace VrsTunnel::Ntrip;
+    fan_out fo{};
+    std::vector<rover_pair> rovers(2);
+    fo.subscribe("RTCM3", rovers[0].caster);
+    fo.subscribe("RTCM3", rovers[1].caster);
+    fo.unsubscribe(*rovers[0].caster);
+    EXPECT_EQ(1UL, fo.subscribers("RTCM3"));
+    rovers[1].caster.reset();
+    EXPECT_EQ(0UL, fo.publish("RTCM3", "abc", 3));
+    EXPECT_EQ(0UL, fo.subscribers("RTCM3"));
+}
+
+namespace
+{
+    /**
+     * @return RTCM3 frame of the message type with a short payload
+     */
+    std::string rtcm_frame(std::uint16_t type)
+    {
+        std::string f {"\xD3\x00\x04", 3};
+        f.push_back(static_cast<char>(type >> 4));
+        f.push_back(static_cast<char>((type & 0x0F) << 4));
+        f.append("pp");
+        std::uint32_t crc = VrsTunnel::Ntrip::rtcm3_framer::crc24q(
+            reinterpret_cast<const std::uint8_t*>(f.data()), f.size());
+        f.push_back(static_cast<char>(crc >> 16));
+        f.push_back(static_cast<char>(crc >> 8));
+        f.push_back(static_cast<char>(crc));
+        return f;
+    }
+}
+
+TEST(testFanOut, filteredSubscribers)
+{
+    using namespace VrsTunnel::Ntrip;
+    fan_out fo{};
+    std::vector<rover_pair> rovers(4);
+    auto msm = std::make_shared<message_filter>();
+    ASSERT_TRUE(message_filter::parse("1005,1074-1077", *msm));
+    auto no_ephemeris = std::make_shared<message_filter>();
+    ASSERT_TRUE(message_filter::parse("!1019", *no_ephemeris));
+    fo.subscribe("RTCM3", rovers[0].caster);
+    fo.subscribe("RTCM3", rovers[1].caster, msm);
+    fo.subscribe("RTCM3", rovers[2].caster, msm);
+    fo.subscribe("RTCM3", rovers[3].caster, no_ephemeris);
+    EXPECT_TRUE(fo.filtered("RTCM3"));
+
+    std::string f1005 = rtcm_frame(1005), f1019 = rtcm_frame(1019), f1077 = rtcm_frame(1077), f1230 = rtcm_frame(1230);
+    std::string stream = f1005 + f1019 + f1077 + f1230;
+    rtcm3_framer framer{};
+    frame_batch batch{};
+    framer.feed(stream.data(), stream.size());
+    rtcm3_frame frame{};
+    while (framer.next(frame) == io_status::Success) {
+        batch.add(frame);
+    }
+    EXPECT_EQ(4UL, fo.publish("RTCM3", stream.data(), stream.size(), batch));
+    EXPECT_EQ(stream, rovers[0].received());
+    EXPECT_EQ(f1005 + f1077, rovers[1].received());
+    EXPECT_EQ(f1005 + f1077, rovers[2].received());
+    EXPECT_EQ(f1005 + f1077 + f1230, rovers[3].received());
+
+    // mount point filter applies to every rover
+    auto no_glonass = std::make_shared<message_filter>();
+    ASSERT_TRUE(message_filter::parse("!1230", *no_glonass));
+    fo.set_filter("RTCM3", no_glonass);
+    EXPECT_EQ(4UL, fo.publish("RTCM3", stream.data(), stream.size(), batch));
+    EXPECT_EQ(f1005 + f1019 + f1077, rovers[0].received());
+    EXPECT_EQ(f1005 + f1077, rovers[3].received());
+
+    fo.set_filter("RTCM3", nullptr);
+    fo.unsubscribe(*rovers[1].caster);
+    fo.unsubscribe(*rovers[2].caster);
+    fo.unsubscribe(*rovers[3].caster);
+    EXPECT_FALSE(fo.filtered("RTCM3"));
+}
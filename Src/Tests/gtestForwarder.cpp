@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "forwarder.hpp"
+
+namespace
+{
+    /**
+     * Caster socket pair and output pipe
+     */
+    struct forward_path
+    {
+        int caster{-1};
+        int rover{-1};
+        int out[2]{-1, -1};
+
+        forward_path()
+        {
+            int fds[2];
+            EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+            caster = fds[0];
+            rover = fds[1];
+            EXPECT_EQ(0, ::pipe2(out, O_NONBLOCK));
+        }
+        ~forward_path()
+        {
+            ::close(caster);
+            ::close(rover);
+            ::close(out[0]);
+            ::close(out[1]);
+        }
+
+        std::string output()
+        {
+            std::string result{};
+            char buf[4096];
+            ssize_t n = 0;
+            while ((n = ::read(out[0], buf, sizeof(buf))) > 0) {
+                result.append(buf, n);
+            }
+            return result;
+        }
+    };
+}
+
+TEST(testForwarder, splicedToPipe)
+{
+    using namespace VrsTunnel::Ntrip;
+    forward_path fp{};
+    forwarder fw{fp.out[1]};
+    EXPECT_TRUE(fw.spliced());
+    std::size_t moved = 0;
+    EXPECT_EQ(io_status::InProgress, fw.forward(fp.rover, moved));
+    EXPECT_EQ(0U, moved);
+
+    std::string frame(1000, '\xD3');
+    ASSERT_EQ(1000, ::write(fp.caster, frame.data(), frame.size()));
+    EXPECT_EQ(io_status::Success, fw.forward(fp.rover, moved));
+    EXPECT_EQ(1000U, moved);
+    EXPECT_EQ(frame, fp.output());
+    EXPECT_TRUE(fw.spliced());
+
+    ::shutdown(fp.caster, SHUT_WR);
+    EXPECT_EQ(io_status::Error, fw.forward(fp.rover, moved));
+}
+
+TEST(testForwarder, bufferMode)
+{
+    using namespace VrsTunnel::Ntrip;
+    forward_path fp{};
+    forwarder fw{fp.out[1], false};
+    EXPECT_FALSE(fw.spliced());
+    EXPECT_EQ(io_status::Success, fw.write("hdr", 3));
+    std::string frame(3 * forwarder::buffer_capacity / 2, 'x');
+    ASSERT_EQ(static_cast<ssize_t>(frame.size()), ::write(fp.caster, frame.data(), frame.size()));
+    std::size_t moved = 0;
+    EXPECT_EQ(io_status::Success, fw.forward(fp.rover, moved));
+    EXPECT_EQ(frame.size(), moved);
+    EXPECT_EQ("hdr" + frame, fp.output());
+}
+
+TEST(testForwarder, fallbackWhenOutputRefusesSplice)
+{
+    using namespace VrsTunnel::Ntrip;
+    // splice into a file opened for appending fails with EINVAL
+    char path[] = "/tmp/gtestForwarderXXXXXX";
+    int file = ::mkstemp(path);
+    ASSERT_GE(file, 0);
+    ::unlink(path);
+    ASSERT_EQ(0, ::fcntl(file, F_SETFL, O_APPEND));
+
+    forward_path fp{};
+    forwarder fw{file};
+    std::string frame(100, 'r');
+    ASSERT_EQ(100, ::write(fp.caster, frame.data(), frame.size()));
+    std::size_t moved = 0;
+    EXPECT_EQ(io_status::Success, fw.forward(fp.rover, moved));
+    EXPECT_EQ(100U, moved);
+    EXPECT_FALSE(fw.spliced());
+    ASSERT_EQ(100, ::write(fp.caster, frame.data(), frame.size()));
+    EXPECT_EQ(io_status::Success, fw.forward(fp.rover, moved));
+    EXPECT_EQ(100U, moved);
+
+    std::string received(300, '\0');
+    EXPECT_EQ(200, ::pread(file, received.data(), received.size(), 0));
+    received.resize(200);
+    EXPECT_EQ(frame + frame, received);
+    ::close(file);
+}
+
+TEST(testForwarder, blockedOutputKeepsBytes)
+{
+    using namespace VrsTunnel::Ntrip;
+    for (bool use_splice : {true, false}) {
+        forward_path fp{};
+        ASSERT_EQ(4096, ::fcntl(fp.out[1], F_SETPIPE_SZ, 4096));
+        forwarder fw{fp.out[1], use_splice};
+        std::string frame(10000, '\0');
+        for (std::size_t i = 0; i < frame.size(); ++i) {
+            frame[i] = static_cast<char>(i * 7);
+        }
+        ASSERT_EQ(static_cast<ssize_t>(frame.size()), ::write(fp.caster, frame.data(), frame.size()));
+        std::size_t moved = 0;
+        EXPECT_EQ(io_status::Success, fw.forward(fp.rover, moved));
+        EXPECT_GT(moved, 0U);
+        EXPECT_TRUE(fw.blocked());
+        std::size_t first = moved;
+        EXPECT_EQ(io_status::InProgress, fw.forward(fp.rover, moved));
+        EXPECT_EQ(0U, moved);
+        EXPECT_EQ(io_status::Success, fw.write("tail", 4));
+
+        std::string received = fp.output();
+        io_status res{};
+        while ((res = fw.flush()) == io_status::InProgress) {
+            received += fp.output();
+        }
+        EXPECT_EQ(io_status::Success, res);
+        EXPECT_FALSE(fw.blocked());
+        // the rest of the stream follows once the output takes the backlog
+        while ((res = fw.forward(fp.rover, moved)) == io_status::Success || fw.blocked()) {
+            ASSERT_NE(io_status::Error, res);
+            received += fp.output();
+        }
+        received += fp.output();
+        EXPECT_EQ(frame.substr(0, first) + "tail" + frame.substr(first), received);
+    }
+}
+
+TEST(testForwarder, blockingTcpSocket)
+{
+    using namespace VrsTunnel::Ntrip;
+    // tcp_client::connect leaves the socket blocking, splice() would wait on it
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(0, ::bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+    ASSERT_EQ(0, ::listen(listener, 1));
+    ASSERT_EQ(0, ::getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &len));
+    int rover = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(0, ::connect(rover, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+    int caster = ::accept(listener, nullptr, nullptr);
+    ASSERT_GE(caster, 0);
+    int out[2];
+    ASSERT_EQ(0, ::pipe2(out, O_NONBLOCK));
+
+    for (bool use_splice : {true, false}) {
+        ASSERT_EQ(0, ::fcntl(rover, F_SETFL, ::fcntl(rover, F_GETFL) & ~O_NONBLOCK));
+        forwarder fw{out[1], use_splice};
+        ASSERT_EQ(5, ::write(caster, "hello", 5));
+        struct pollfd pfd{rover, POLLIN, 0};
+        ASSERT_EQ(1, ::poll(&pfd, 1, 1000));
+        std::size_t moved = 0;
+        EXPECT_EQ(io_status::Success, fw.forward(rover, moved));
+        EXPECT_EQ(5U, moved);
+        EXPECT_EQ(io_status::InProgress, fw.forward(rover, moved));
+        char buf[16];
+        EXPECT_EQ(5, ::read(out[0], buf, sizeof(buf)));
+        EXPECT_EQ("hello", std::string(buf, 5));
+    }
+    ::close(out[0]);
+    ::close(out[1]);
+    ::close(caster);
+    ::close(rover);
+    ::close(listener);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+
+#include "handshake.hpp"
+#include "response_parser.hpp"
+
+namespace
+{
+    /**
+     * Caster side of a socket pair, it answers the request once it is complete
+     */
+    struct caster_pair
+    {
+        int client{-1};
+        int caster{-1};
+        std::string request{};
+
+        caster_pair()
+        {
+            int fds[2];
+            EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+            client = fds[0];
+            caster = fds[1];
+        }
+        ~caster_pair()
+        {
+            ::close(client);
+            ::close(caster);
+        }
+
+        std::thread reply(std::string response)
+        {
+            return std::thread([this, response] {
+                char buf[512];
+                while (request.find("\r\n\r\n") == std::string::npos) {
+                    ssize_t n = ::read(caster, buf, sizeof(buf));
+                    if (n <= 0) {
+                        return;
+                    }
+                    request.append(buf, n);
+                }
+                EXPECT_EQ(static_cast<ssize_t>(response.size()),
+                    ::write(caster, response.data(), response.size()));
+            });
+        }
+    };
+
+    const std::string get_request {"GET /RTCM3 HTTP/1.0\r\nAccept: */*\r\n\r\n"};
+}
+
+TEST(testResponseParser, icyWithBody)
+{
+    using namespace VrsTunnel::Ntrip;
+    std::string resp {"ICY 200 OK\r\n\r\n\xD3\x01\x13"};
+    response_parser parser{};
+    EXPECT_EQ(io_status::Success, parser.parse(resp));
+    EXPECT_EQ(200, parser.code());
+    EXPECT_EQ(response_protocol::icy, parser.protocol());
+    EXPECT_EQ(14U, parser.size());
+}
+
+TEST(testResponseParser, httpByteByByte)
+{
+    using namespace VrsTunnel::Ntrip;
+    std::string resp {"HTTP/1.1 200 OK\r\n"
+        "Ntrip-Version: Ntrip/2.0\r\n"
+        "Content-Type: gnss/data\r\n"
+        "\r\n"};
+    response_parser parser{};
+    for (std::size_t i = 1; i < resp.size(); ++i) {
+        ASSERT_EQ(io_status::InProgress, parser.parse(std::string_view(resp.data(), i)));
+    }
+    EXPECT_EQ(io_status::Success, parser.parse(resp));
+    EXPECT_EQ(200, parser.code());
+    EXPECT_EQ(resp.size(), parser.size());
+}
+
+TEST(testResponseParser, failureAtStatusLine)
+{
+    using namespace VrsTunnel::Ntrip;
+    response_parser parser{};
+    EXPECT_EQ(io_status::InProgress, parser.parse("HTTP/1.1 401 Unauth"));
+    EXPECT_EQ(io_status::Success, parser.parse("HTTP/1.1 401 Unauthorized\r\nWWW-Auth"));
+    EXPECT_EQ(401, parser.code());
+
+    parser.reset();
+    EXPECT_EQ(io_status::Success, parser.parse("SOURCETABLE 200 OK\r\n"));
+    EXPECT_EQ(response_protocol::sourcetable, parser.protocol());
+}
+
+TEST(testResponseParser, malformed)
+{
+    using namespace VrsTunnel::Ntrip;
+    response_parser parser{};
+    EXPECT_EQ(io_status::Error, parser.parse("220 smtp ready\r\n"));
+    parser.reset();
+    EXPECT_EQ(io_status::Error, parser.parse("HTTP/1.1 OK\r\n"));
+    parser.reset();
+    EXPECT_EQ(io_status::Error, parser.parse(std::string(response_parser::max_header + 1, 'H')));
+}
+
+TEST(testHandshake, bodyAfterHeader)
+{
+    using namespace VrsTunnel::Ntrip;
+    caster_pair cp{};
+    std::thread caster = cp.reply("ICY 200 OK\r\n\r\n\xD3\x01\x13");
+    async_io aio{cp.client};
+    handshake hs{handshake_timeouts{}};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(io_status::Success, hs.run(aio, cp.client, get_request.data(), get_request.size()));
+    // no fixed sleep step, the reply is handled as soon as it arrives
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    caster.join();
+    EXPECT_EQ(get_request, cp.request);
+    EXPECT_EQ(200, hs.response().code());
+    EXPECT_EQ(std::string_view("\xD3\x01\x13", 3), hs.body());
+    EXPECT_EQ(static_cast<ssize_t>(get_request.size()), aio.end());
+}
+
+TEST(testHandshake, responseDeadline)
+{
+    using namespace VrsTunnel::Ntrip;
+    caster_pair cp{};
+    async_io aio{cp.client};
+    handshake_timeouts timeouts{};
+    timeouts.response = std::chrono::milliseconds(30);
+    handshake hs{timeouts};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(io_status::Error, hs.run(aio, cp.client, get_request.data(), get_request.size()));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(30));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+    [[maybe_unused]] ssize_t res = aio.end();
+}
+
+TEST(testHandshake, closedBeforeResponse)
+{
+    using namespace VrsTunnel::Ntrip;
+    caster_pair cp{};
+    ::shutdown(cp.caster, SHUT_WR);
+    async_io aio{cp.client};
+    handshake hs{handshake_timeouts{}};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(io_status::Error, hs.run(aio, cp.client, get_request.data(), get_request.size()));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    [[maybe_unused]] ssize_t res = aio.end();
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "message_filter.hpp"
+
+TEST(testMessageFilter, parseAllowList)
+{
+    using namespace VrsTunnel::Ntrip;
+    message_filter filter{};
+    EXPECT_TRUE(filter.accepts_all());
+    ASSERT_TRUE(message_filter::parse("1005,1033,1074-1077", filter));
+    EXPECT_FALSE(filter.accepts_all());
+    EXPECT_TRUE(filter.accepts(1005));
+    EXPECT_TRUE(filter.accepts(1033));
+    EXPECT_TRUE(filter.accepts(1074));
+    EXPECT_TRUE(filter.accepts(1077));
+    EXPECT_FALSE(filter.accepts(1078));
+    EXPECT_FALSE(filter.accepts(1019));
+    EXPECT_FALSE(filter.accepts(0));
+}
+
+TEST(testMessageFilter, parseDenyList)
+{
+    using namespace VrsTunnel::Ntrip;
+    message_filter filter{};
+    ASSERT_TRUE(message_filter::parse("!1019,1020,4000-4095", filter));
+    EXPECT_FALSE(filter.accepts(1019));
+    EXPECT_FALSE(filter.accepts(1020));
+    EXPECT_FALSE(filter.accepts(4095));
+    EXPECT_TRUE(filter.accepts(1005));
+    EXPECT_TRUE(filter.accepts(3999));
+}
+
+TEST(testMessageFilter, parseErrorsKeepFilter)
+{
+    using namespace VrsTunnel::Ntrip;
+    message_filter filter{};
+    ASSERT_TRUE(message_filter::parse("1005", filter));
+    for (const char* spec : {"", "!", "1005,", "abc", "4096", "1077-1074", "1005;1006", "1005-"}) {
+        EXPECT_FALSE(message_filter::parse(spec, filter)) << spec;
+    }
+    EXPECT_TRUE(filter.accepts(1005));
+    EXPECT_FALSE(filter.accepts(1006));
+}
+
+TEST(testMessageFilter, statsPerType)
+{
+    using namespace VrsTunnel::Ntrip;
+    auto stats = std::make_unique<message_stats>();
+    stats->count(1077, 300);
+    stats->count(1077, 200);
+    stats->count(1005, 25);
+    EXPECT_EQ(2U, stats->frames(1077));
+    EXPECT_EQ(500U, stats->bytes(1077));
+    EXPECT_EQ(1U, stats->frames(1005));
+    EXPECT_EQ(0U, stats->frames(1006));
+}
+
+TEST(testMessageFilter, batchSelect)
+{
+    using namespace VrsTunnel::Ntrip;
+    const std::uint8_t f1005[] {0xD3, 0x00, 0x02, 0x3E, 0xD0, 1, 2, 3};
+    const std::uint8_t f1077[] {0xD3, 0x00, 0x02, 0x43, 0x50, 4, 5, 6};
+    frame_batch batch{};
+    EXPECT_TRUE(batch.empty());
+    batch.add(rtcm3_frame{f1005, sizeof(f1005)});
+    batch.add(rtcm3_frame{f1077, sizeof(f1077)});
+
+    message_filter only_1005{};
+    ASSERT_TRUE(message_filter::parse("1005", only_1005));
+    message_filter no_1005{};
+    ASSERT_TRUE(message_filter::parse("!1005", no_1005));
+
+    auto all = batch.select(nullptr, nullptr);
+    ASSERT_TRUE(all);
+    EXPECT_EQ(16U, all->size());
+    auto first = batch.select(&only_1005, nullptr);
+    ASSERT_TRUE(first);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(f1005), sizeof(f1005)), std::string(first->view()));
+    EXPECT_FALSE(batch.select(&only_1005, &no_1005));
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+}
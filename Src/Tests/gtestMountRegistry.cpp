@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+
+#include "accept_listener.hpp"
+#include "mount_registry.hpp"
+
+namespace
+{
+    /**
+     * Client connection with the caster end wrapped into connection object
+     */
+    struct client_pair
+    {
+        std::shared_ptr<VrsTunnel::Ntrip::connection> caster{};
+        int peer{-1};
+
+        client_pair()
+        {
+            int fds[2];
+            EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+            caster = std::make_shared<VrsTunnel::Ntrip::connection>(
+                std::make_unique<VrsTunnel::Ntrip::tcp_client>(fds[0]));
+            peer = fds[1];
+        }
+        ~client_pair()
+        {
+            ::close(peer);
+        }
+        client_pair(const client_pair&) = delete;
+        client_pair& operator=(const client_pair&) = delete;
+
+        /**
+         * Sends the bytes to the listener as the reactor would
+         */
+        void send(VrsTunnel::Ntrip::accept_listener& listener, const std::string& data)
+        {
+            EXPECT_EQ(static_cast<ssize_t>(data.size()), ::write(peer, data.data(), data.size()));
+            EXPECT_EQ(VrsTunnel::Ntrip::io_status::Success, caster->receive());
+            listener.OnDataReceived(*caster);
+        }
+
+        std::string received()
+        {
+            char buf[4096];
+            ssize_t n = ::read(peer, buf, sizeof(buf));
+            return n > 0 ? std::string(buf, n) : std::string();
+        }
+    };
+
+    /**
+     * @return RTCM3 frame of the message with a payload of four bytes
+     */
+    std::string make_frame(std::uint16_t type, std::uint8_t tag)
+    {
+        using VrsTunnel::Ntrip::rtcm3_framer;
+        std::vector<std::uint8_t> frame {0xD3, 0x00, 0x04, static_cast<std::uint8_t>(type >> 4),
+            static_cast<std::uint8_t>((type & 0x0F) << 4), tag, tag};
+        std::uint32_t crc = rtcm3_framer::crc24q(frame.data(), frame.size());
+        frame.push_back(static_cast<std::uint8_t>(crc >> 16));
+        frame.push_back(static_cast<std::uint8_t>(crc >> 8));
+        frame.push_back(static_cast<std::uint8_t>(crc));
+        return std::string(frame.begin(), frame.end());
+    }
+
+    const std::string source_request {"SOURCE secret /BASE\r\nSource-Agent: NTRIP test\r\n\r\n"};
+    const std::string rover_ok {"ICY 200 OK\r\n\r\n"};
+}
+
+TEST(testMountRegistry, addFindRemove)
+{
+    using namespace VrsTunnel::Ntrip;
+    mount_registry mounts{2};
+    auto stream = mounts.add("BASE", 0, "");
+    ASSERT_NE(nullptr, stream);
+    EXPECT_EQ(0UL, stream->shard);
+    EXPECT_NE(nullptr, stream->ring);
+    EXPECT_EQ(nullptr, mounts.add("BASE", 1, ""));
+    EXPECT_EQ(stream, mounts.find("BASE"));
+    EXPECT_NE(std::string::npos, mounts.table().get()->body->view().find("STR;BASE;"));
+
+    mounts.remove("BASE");
+    EXPECT_EQ(nullptr, mounts.find("BASE"));
+    EXPECT_TRUE(stream->closed.load());
+    EXPECT_EQ(std::string::npos, mounts.table().get()->body->view().find("STR;BASE;"));
+    EXPECT_THROW(mount_registry{0}, std::runtime_error);
+    EXPECT_THROW(mount_registry{mount_registry::max_shards + 1}, std::runtime_error);
+}
+
+TEST(testMountRegistry, singleShardHasNoRing)
+{
+    using namespace VrsTunnel::Ntrip;
+    mount_registry mounts{1};
+    auto stream = mounts.add("BASE", 0, "");
+    ASSERT_NE(nullptr, stream);
+    EXPECT_EQ(nullptr, stream->ring);
+}
+
+TEST(testMountRegistry, notifyReaders)
+{
+    using namespace VrsTunnel::Ntrip;
+    mount_registry mounts{3};
+    auto stream = mounts.add("BASE", 0, "");
+    // other shards may have rovers waiting for the mount point
+    EXPECT_FALSE(mounts.notified(0));
+    EXPECT_TRUE(mounts.notified(1));
+    EXPECT_TRUE(mounts.notified(2));
+    EXPECT_FALSE(mounts.notified(1));
+
+    stream->readers.fetch_or(1U << 2);
+    mounts.notify(*stream);
+    EXPECT_FALSE(mounts.notified(1));
+    EXPECT_TRUE(mounts.notified(2));
+    EXPECT_FALSE(mounts.notified(2));
+}
+
+TEST(testMountRegistry, roverOfOtherShard)
+{
+    using namespace VrsTunnel::Ntrip;
+    auto mounts = std::make_shared<mount_registry>(2);
+    accept_listener first{mounts, 0};
+    accept_listener second{mounts, 1};
+    EXPECT_THROW(accept_listener(mounts, 2), std::runtime_error);
+
+    client_pair source{};
+    first.OnClientConnected(source.caster);
+    source.send(first, source_request);
+    EXPECT_EQ(rover_ok, source.received());
+
+    client_pair rover{};
+    second.OnClientConnected(rover.caster);
+    rover.send(second, "GET /BASE HTTP/1.0\r\n\r\n");
+    EXPECT_EQ(rover_ok, rover.received());
+
+    // the base station shard hands the frames over, the rover shard sends them on its timer
+    std::string frames = make_frame(1230, 1) + make_frame(1230, 2);
+    source.send(first, frames);
+    EXPECT_EQ("", rover.received());
+    second.OnTimer(std::chrono::steady_clock::now());
+    EXPECT_EQ(frames, rover.received());
+
+    // a mount point has one base station on all the shards
+    client_pair rival{};
+    second.OnClientConnected(rival.caster);
+    rival.send(second, source_request);
+    EXPECT_EQ("HTTP/1.1 409 Conflict\r\n\r\n", rival.received());
+}
+
+TEST(testMountRegistry, filteredRoverOfOtherShard)
+{
+    using namespace VrsTunnel::Ntrip;
+    auto mounts = std::make_shared<mount_registry>(2);
+    accept_listener first{mounts, 0};
+    accept_listener second{mounts, 1};
+
+    client_pair source{};
+    first.OnClientConnected(source.caster);
+    source.send(first, source_request);
+
+    client_pair rover{};
+    second.OnClientConnected(rover.caster);
+    rover.send(second, "GET /BASE?msg=1033 HTTP/1.0\r\n\r\n");
+    EXPECT_EQ(rover_ok, rover.received());
+
+    std::string wanted = make_frame(1033, 3);
+    source.send(first, make_frame(1230, 1) + wanted + make_frame(1230, 2));
+    second.OnTimer(std::chrono::steady_clock::now());
+    EXPECT_EQ(wanted, rover.received());
+}
+
+TEST(testMountRegistry, roverWaitsForNextBaseStation)
+{
+    using namespace VrsTunnel::Ntrip;
+    auto mounts = std::make_shared<mount_registry>(2);
+    accept_listener first{mounts, 0};
+    accept_listener second{mounts, 1};
+
+    auto base = std::make_unique<client_pair>();
+    first.OnClientConnected(base->caster);
+    base->send(first, source_request);
+
+    client_pair rover{};
+    second.OnClientConnected(rover.caster);
+    rover.send(second, "GET /BASE HTTP/1.0\r\n\r\n");
+    EXPECT_EQ(rover_ok, rover.received());
+
+    // frames sent before the base station left still reach the rover
+    std::string last = make_frame(1230, 1);
+    base->send(first, last);
+    first.OnClientDisconnected(*base->caster);
+    base.reset();
+    EXPECT_EQ(nullptr, mounts->find("BASE"));
+    second.OnTimer(std::chrono::steady_clock::now());
+    EXPECT_EQ(last, rover.received());
+
+    // the next base station of the mount point comes to the rover shard
+    client_pair next{};
+    second.OnClientConnected(next.caster);
+    next.send(second, source_request);
+    std::string frame = make_frame(1230, 2);
+    next.send(second, frame);
+    EXPECT_EQ(frame, rover.received());
+    second.OnTimer(std::chrono::steady_clock::now());
+    EXPECT_EQ("", rover.received());
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <cmath>
 #include <string>
 
 #include "nmea.hpp"
@@ -78,4 +79,115 @@ TEST(testNmea, TestGGA_5)
 };
 
 // $GPGGA,115739.00,4158.8441367,N,09147.4416929,W,4,13,0.9,255.747,M,-32.00,M,01,0000*6E 
-// $GPGGA,172814.0,3723.46587704,N,12202.26957864,W,2,6,1.2,18.893,M,-25.669,M,2.0,0031*4F
\ No newline at end of file
+// $GPGGA,172814.0,3723.46587704,N,12202.26957864,W,2,6,1.2,18.893,M,-25.669,M,2.0,0031*4F
+
+TEST(testNmea, checksumWords)
+{
+    using namespace VrsTunnel::Ntrip;
+    EXPECT_EQ(0U, nmea::checksum(""));
+    EXPECT_EQ(0x41U, nmea::checksum("A"));
+    std::string text{"GNGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"};
+    for (std::size_t len = 0; len <= text.size(); ++len) {
+        uint8_t expected = 0;
+        for (std::size_t i = 0; i < len; ++i) {
+            expected ^= static_cast<uint8_t>(text[i]);
+        }
+        EXPECT_EQ(expected, nmea::checksum(std::string_view{text.data(), len}));
+    }
+}
+
+TEST(testNmea, parseGGA)
+{
+    using namespace VrsTunnel::Ntrip;
+    gga_fix fix{};
+    ASSERT_TRUE(nmea::parseGGA("$GPGGA,115739.00,4158.8441367,N,09147.4416929,W,4,13,0.9,255.747,M,-32.00,M,01,0000*6E\r\n", fix));
+    EXPECT_NEAR(41.0 + 58.8441367 / 60, fix.position.Latitude, 1e-12);
+    EXPECT_NEAR(-(91.0 + 47.4416929 / 60), fix.position.Longitude, 1e-12);
+    EXPECT_DOUBLE_EQ(255.747, fix.position.Elevation);
+    EXPECT_EQ(4, fix.quality);
+    EXPECT_EQ(13, fix.satellites);
+    EXPECT_DOUBLE_EQ(0.9, fix.hdop);
+    EXPECT_EQ(std::chrono::milliseconds((11 * 3600 + 57 * 60 + 39) * 1000), fix.time);
+
+    // the sentence of getGGA comes back
+    std::chrono::system_clock::time_point time{};
+    time += std::chrono::hours(3) + std::chrono::minutes(24) + std::chrono::milliseconds(59150);
+    auto gga = std::get<std::string>(nmea::getGGA(location(-1.821, -179.56654789, 46.5), time));
+    ASSERT_TRUE(nmea::parseGGA(gga, fix));
+    EXPECT_NEAR(-1.821, fix.position.Latitude, 1e-9);
+    EXPECT_NEAR(-179.56654789, fix.position.Longitude, 1e-9);
+    EXPECT_EQ(std::chrono::milliseconds((3 * 3600 + 24 * 60 + 59) * 1000 + 150), fix.time);
+
+    // other talker, lower case checksum, empty optional fields, no line end
+    ASSERT_TRUE(nmea::parseGGA("$GNGGA,000000,0000.000,S,00000.000,E,1,,,,M,,M,,*5f", fix));
+    EXPECT_EQ(0.0, fix.position.Latitude);
+    EXPECT_EQ(0, fix.satellites);
+    EXPECT_EQ(std::chrono::milliseconds(0), fix.time);
+}
+
+TEST(testNmea, parseGGARejects)
+{
+    using namespace VrsTunnel::Ntrip;
+    gga_fix fix{};
+    fix.quality = 7;
+    EXPECT_FALSE(nmea::parseGGA("", fix));
+    EXPECT_FALSE(nmea::parseGGA("$GPGGA,115739.00,4158.8441367,N,09147.4416929,W,4,13,0.9,255.747,M,-32.00,M,01,0000*6F", fix));
+    EXPECT_FALSE(nmea::parseGGA("$GPGGA,115739.00,4158.8441367,N,09147.4416929,W,4,13,0.9,255.747,M,-32.00,M,01,0000", fix));
+    EXPECT_FALSE(nmea::parseGGA("$GPRMC,115739.00,A,4158.8441367,N,09147.4416929,W,0.0,0.0,010120,,*2B", fix));
+    EXPECT_FALSE(nmea::parseGGA("GPGGA,115739.00,4158.8441367,N,09147.4416929,W,4,13,0.9,255.747,M,-32.00,M,01,0000*6E", fix));
+
+    auto sentence = [](std::string body) {
+        char cs[8];
+        std::snprintf(cs, sizeof(cs), "*%02X", nmea::checksum(body));
+        return "$" + body + cs;
+    };
+    ASSERT_TRUE(nmea::parseGGA(sentence("GPGGA,115739.00,4158.84,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,,,,,,0,00,99.99,,,,,,"), fix));             // no fix
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,4158.84,N,09147.44,W,0,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,9158.84,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,4160.84,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,41nan,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,4158.84,X,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,4158.84,N,18147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,245739.00,4158.84,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,4158.84,N,09147.44,W,1,05,1.5,1x0,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("GPGGA,115739.00,4158.84,N,09147.44,W,1,05"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("gpGGA,115739.00,4158.84,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence("G1GGA,115739.00,4158.84,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_FALSE(nmea::parseGGA(sentence(",PGGA,115739.00,4158.84,N,09147.44,W,1,05,1.5,10,M,0,M,,"), fix));
+    EXPECT_EQ(1, fix.quality);  // left as the last valid sentence set it
+}
+
+TEST(testNmea, formatGGA)
+{
+    using namespace VrsTunnel::Ntrip;
+    std::chrono::system_clock::time_point time{};
+    time += std::chrono::hours(11) + std::chrono::minutes(57) + std::chrono::seconds(39);
+    char buf[nmea::max_gga];
+    std::size_t size = nmea::formatGGA(location{41.980735612, -91.790694882, 255.74749}, time, buf, sizeof(buf));
+    EXPECT_EQ("$GPGGA,115739.00,4158.84413672,N,09147.44169292,W,4,12,0.9,255.747,M,255.747,M,0,0000*74\r\n",
+        std::string(buf, size));
+
+    // minutes which round up to 60 carry into degrees
+    size = nmea::formatGGA(location{10.9999999999999, 0.0, -0.25}, time, buf, sizeof(buf));
+    EXPECT_EQ("$GPGGA,115739.00,1100.00000000,N,00000.00000000,E,4,12,0.9,-0.250,M,-0.250,M,0,0000*",
+        std::string(buf, size - 4));
+
+    // checksum is always two digits
+    for (int i = 0; i < 200; ++i) {
+        size = nmea::formatGGA(location{i * 0.45, i * -0.89, i * 1.5}, time, buf, sizeof(buf));
+        ASSERT_GT(size, 5U);
+        std::string_view sentence{buf, size};
+        ASSERT_EQ('*', sentence[size - 5]);
+        gga_fix fix{};
+        ASSERT_TRUE(nmea::parseGGA(sentence, fix)) << sentence;
+        EXPECT_NEAR(i * 0.45, fix.position.Latitude, 1e-9);
+        EXPECT_NEAR(i * -0.89, fix.position.Longitude, 1e-9);
+        EXPECT_NEAR(i * 1.5, fix.position.Elevation, 1e-3);
+    }
+
+    EXPECT_EQ(0U, nmea::formatGGA(location{}, time, buf, nmea::max_gga - 1));
+    EXPECT_EQ(0U, nmea::formatGGA(location{0, 0, 1e12}, time, buf, sizeof(buf)));
+    EXPECT_EQ(0U, nmea::formatGGA(location{91, 0, 0}, time, buf, sizeof(buf)));
+    EXPECT_EQ(0U, nmea::formatGGA(location{0, std::nan(""), 0}, time, buf, sizeof(buf)));
+}
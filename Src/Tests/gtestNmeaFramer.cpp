@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "nmea_framer.hpp"
+
+namespace
+{
+    using VrsTunnel::Ntrip::io_status;
+    using VrsTunnel::Ntrip::nmea_framer;
+
+    const std::string gga{"$GPGGA,115739.00,4158.8441367,N,09147.4416929,W,4,13,0.9,255.747,M,-32.00,M,01,0000*6E"};
+    const std::string gsa{"$GNGSA,A,3,80,71,73,79,69,,,,,,,,1.83,1.09,1.47*17"};
+
+    std::vector<std::string> feed_all(nmea_framer& framer, const std::string& data)
+    {
+        std::vector<std::string> out{};
+        framer.feed(data.data(), data.size());
+        std::string_view sentence{};
+        while (framer.next(sentence) == io_status::Success) {
+            out.emplace_back(sentence);
+        }
+        return out;
+    }
+}
+
+TEST(testNmeaFramer, inPlaceSentences)
+{
+    nmea_framer framer{};
+    std::string data = "noise" + gga + "\r\n" + gsa + "\n\r\n" + gga + "\r\n";
+    auto out = feed_all(framer, data);
+    ASSERT_EQ(3U, out.size());
+    EXPECT_EQ(gga, out[0]);
+    EXPECT_EQ(gsa, out[1]);
+    EXPECT_EQ(gga, out[2]);
+    EXPECT_EQ(3U, framer.stats().sentences);
+    EXPECT_EQ(7U, framer.stats().discarded_bytes);
+}
+
+TEST(testNmeaFramer, splitAtEveryByte)
+{
+    std::string data = gga + "\r\n" + gsa + "\r\n";
+    for (std::size_t cut = 0; cut <= data.size(); ++cut) {
+        nmea_framer framer{};
+        auto out = feed_all(framer, data.substr(0, cut));
+        auto rest = feed_all(framer, data.substr(cut));
+        out.insert(out.end(), rest.begin(), rest.end());
+        ASSERT_EQ(2U, out.size()) << "cut at " << cut;
+        EXPECT_EQ(gga, out[0]);
+        EXPECT_EQ(gsa, out[1]);
+    }
+}
+
+TEST(testNmeaFramer, byteByByte)
+{
+    std::string data = gga + "\r\n" + gsa + "\r\n";
+    nmea_framer framer{};
+    std::vector<std::string> out{};
+    for (char c : data) {
+        auto got = feed_all(framer, std::string(1, c));
+        out.insert(out.end(), got.begin(), got.end());
+    }
+    ASSERT_EQ(2U, out.size());
+    EXPECT_EQ(gsa, out[1]);
+}
+
+TEST(testNmeaFramer, overlongLines)
+{
+    std::string overlong = "$" + std::string(nmea_framer::max_sentence, 'A') + "\r\n";
+    nmea_framer framer{};
+    auto out = feed_all(framer, overlong + gga + "\r\n");
+    ASSERT_EQ(1U, out.size());
+    EXPECT_EQ(gga, out[0]);
+    EXPECT_EQ(overlong.size(), framer.stats().discarded_bytes);
+
+    // the long line is split between buffers
+    out = feed_all(framer, overlong.substr(0, 100));
+    EXPECT_TRUE(out.empty());
+    out = feed_all(framer, overlong.substr(100, 100));
+    EXPECT_TRUE(out.empty());
+    out = feed_all(framer, overlong.substr(200) + gsa + "\n");
+    ASSERT_EQ(1U, out.size());
+    EXPECT_EQ(gsa, out[0]);
+
+    framer.feed(gga.data(), 20);
+    std::string_view sentence{};
+    EXPECT_EQ(io_status::InProgress, framer.next(sentence));
+    framer.reset();
+    out = feed_all(framer, gga.substr(20) + "\r\n" + gsa + "\r\n");
+    ASSERT_EQ(1U, out.size());
+    EXPECT_EQ(gsa, out[0]);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "reconnect_policy.hpp"
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    VrsTunnel::Ntrip::backoff_settings no_jitter()
+    {
+        VrsTunnel::Ntrip::backoff_settings settings{};
+        settings.initial = 1s;
+        settings.ceiling = 10s;
+        settings.jitter = 0.0;
+        return settings;
+    }
+}
+
+TEST(testReconnectPolicy, immediateRetryThenExponential)
+{
+    using namespace VrsTunnel::Ntrip;
+    reconnect_policy policy{no_jitter(), 1};
+    EXPECT_EQ(0ms, policy.next_delay(status::error));
+    EXPECT_EQ(1s, policy.next_delay(status::error));
+    EXPECT_EQ(2s, policy.next_delay(status::error));
+    EXPECT_EQ(4s, policy.next_delay(status::nomount));
+    EXPECT_EQ(8s, policy.next_delay(status::error));
+    EXPECT_EQ(10s, policy.next_delay(status::error));
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(10s, policy.next_delay(status::error));
+    }
+    EXPECT_EQ(106U, policy.stats().attempts);
+}
+
+TEST(testReconnectPolicy, jitterShortensDelay)
+{
+    using namespace VrsTunnel::Ntrip;
+    backoff_settings settings = no_jitter();
+    settings.jitter = 0.5;
+    reconnect_policy policy{settings, 7};
+    EXPECT_EQ(0ms, policy.next_delay(status::error));
+    bool varies = false;
+    std::chrono::milliseconds previous{0};
+    for (int i = 0; i < 20; ++i) {
+        auto delay = policy.next_delay(status::error);
+        auto base = std::min<std::chrono::milliseconds>(settings.ceiling, settings.initial * (1LL << std::min(i, 20)));
+        EXPECT_LE(delay, base);
+        EXPECT_GE(delay, base / 2);
+        varies = varies || (i > 5 && delay != previous);
+        previous = delay;
+    }
+    EXPECT_TRUE(varies);
+}
+
+TEST(testReconnectPolicy, authFailureWaitsLong)
+{
+    using namespace VrsTunnel::Ntrip;
+    backoff_settings settings = no_jitter();
+    settings.auth_delay = 5min;
+    reconnect_policy policy{settings, 1};
+    EXPECT_EQ(5min, policy.next_delay(status::authfailure));
+    EXPECT_EQ(1s, policy.next_delay(status::error));
+}
+
+TEST(testReconnectPolicy, authFailureJitterNeverShortens)
+{
+    using namespace VrsTunnel::Ntrip;
+    backoff_settings settings = no_jitter();
+    settings.auth_delay = 5min;
+    settings.jitter = 0.5;
+    reconnect_policy policy{settings, 3};
+    for (int i = 0; i < 50; ++i) {
+        auto delay = policy.next_delay(status::authfailure);
+        EXPECT_GE(delay, settings.auth_delay);
+        EXPECT_LE(delay, settings.auth_delay * 3 / 2);
+    }
+}
+
+TEST(testReconnectPolicy, stableSessionResetsBackoff)
+{
+    using namespace VrsTunnel::Ntrip;
+    backoff_settings settings = no_jitter();
+    settings.stable = 20ms;
+    reconnect_policy policy{settings, 1};
+    EXPECT_EQ(0ms, policy.next_delay(status::error));
+    EXPECT_EQ(1s, policy.next_delay(status::error));
+    policy.connected();
+    // flapping session keeps backing off
+    EXPECT_EQ(2s, policy.next_delay(status::error));
+    policy.connected();
+    std::this_thread::sleep_for(25ms);
+    EXPECT_EQ(0ms, policy.next_delay(status::error));
+}
+
+TEST(testReconnectPolicy, outageMetrics)
+{
+    using namespace VrsTunnel::Ntrip;
+    reconnect_policy policy{no_jitter(), 1};
+    policy.connected();
+    EXPECT_EQ(0U, policy.stats().reconnects);
+    EXPECT_EQ(0ms, policy.next_delay(status::error));
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(1s, policy.next_delay(status::error));
+    policy.connected();
+    auto stats = policy.stats();
+    EXPECT_EQ(1U, stats.reconnects);
+    EXPECT_EQ(1U, stats.attempts);
+    EXPECT_GE(stats.last_outage, 20ms);
+    EXPECT_LT(stats.last_outage, 1s);
+    EXPECT_EQ(stats.last_outage, stats.max_outage);
+    EXPECT_EQ(stats.last_outage, stats.total_outage);
+}
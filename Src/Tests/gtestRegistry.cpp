@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "registry.hpp.cpp"
+
+namespace VrsTunnel::Ntrip
+{
+    template class registry<int>;
+}
+
+TEST(testRegistry, insertFindErase)
+{
+    VrsTunnel::Ntrip::registry<int> reg{};
+    EXPECT_TRUE(reg.insert(5, 50));
+    EXPECT_FALSE(reg.insert(5, 51));
+    EXPECT_TRUE(reg.insert(-3, 30));
+    EXPECT_EQ(50, reg.find(5));
+    EXPECT_EQ(0, reg.find(7));
+    EXPECT_EQ(2U, reg.size());
+    EXPECT_TRUE(reg.erase(5));
+    EXPECT_FALSE(reg.erase(5));
+    EXPECT_EQ(1U, reg.size());
+}
+
+TEST(testRegistry, replaceKeepsSnapshots)
+{
+    VrsTunnel::Ntrip::registry<int> reg{};
+    EXPECT_FALSE(reg.replace(4, 40));
+    EXPECT_TRUE(reg.insert(4, 40));
+    auto before = reg.snapshot();
+    EXPECT_TRUE(reg.replace(4, 41));
+    EXPECT_EQ(41, reg.find(4));
+    EXPECT_EQ(1U, reg.size());
+    int old_value = 0;
+    before.for_each([&old_value](int value) { old_value = value; });
+    EXPECT_EQ(40, old_value);
+    int new_value = 0;
+    reg.snapshot().for_each([&new_value](int value) { new_value = value; });
+    EXPECT_EQ(41, new_value);
+}
+
+TEST(testRegistry, snapshotIsImmutable)
+{
+    VrsTunnel::Ntrip::registry<int> reg{};
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_TRUE(reg.insert(i, i));
+    }
+    auto before = reg.snapshot();
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(reg.erase(i));
+    }
+    auto after = reg.snapshot();
+    EXPECT_EQ(200U, before.size());
+    EXPECT_EQ(100U, after.size());
+    int sum = 0;
+    after.for_each([&sum](int value) { sum += value; });
+    EXPECT_EQ((100 + 199) * 100 / 2, sum);
+}
+
+TEST(testRegistry, concurrentSnapshots)
+{
+    constexpr int writers = 4;
+    constexpr int per_writer = 5000;
+    VrsTunnel::Ntrip::registry<int> reg{};
+    std::atomic<bool> done{false};
+    std::thread reader([&reg, &done] {
+        std::size_t last = 0;
+        while (!done.load()) {
+            std::size_t size = reg.snapshot().size();
+            EXPECT_LE(size, static_cast<std::size_t>(writers * per_writer));
+            last = size;
+        }
+        EXPECT_GE(reg.snapshot().size(), last);
+    });
+    std::vector<std::thread> threads{};
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&reg, w] {
+            for (int i = 0; i < per_writer; ++i) {
+                EXPECT_TRUE(reg.insert(w * per_writer + i, i));
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    done.store(true);
+    reader.join();
+    EXPECT_EQ(static_cast<std::size_t>(writers * per_writer), reg.snapshot().size());
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "resolver.hpp"
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    /**
+     * Name service stub, it answers with 127.0.0.<octet> until it is broken
+     */
+    struct stub_service
+    {
+        std::atomic<bool> broken{false};
+        std::atomic<int> octet{1};
+        std::chrono::milliseconds delay{0};
+
+        VrsTunnel::Ntrip::resolver::lookup_function function()
+        {
+            return [this](const std::string&, int port, std::vector<VrsTunnel::Ntrip::endpoint>& endpoints) {
+                std::this_thread::sleep_for(delay);
+                if (broken) {
+                    return VrsTunnel::Ntrip::io_status::Error;
+                }
+                VrsTunnel::Ntrip::endpoint ep{};
+                auto* addr = reinterpret_cast<struct sockaddr_in*>(&ep.address);
+                addr->sin_family = AF_INET;
+                addr->sin_port = htons(port);
+                addr->sin_addr.s_addr = htonl((127 << 24) | octet);
+                ep.length = sizeof(struct sockaddr_in);
+                endpoints.push_back(ep);
+                return VrsTunnel::Ntrip::io_status::Success;
+            };
+        }
+    };
+
+    int last_octet(const std::vector<VrsTunnel::Ntrip::endpoint>& endpoints)
+    {
+        return ntohl(reinterpret_cast<const struct sockaddr_in*>(&endpoints.at(0).address)->sin_addr.s_addr) & 0xFF;
+    }
+}
+
+TEST(testResolver, cachedWithinTtl)
+{
+    using namespace VrsTunnel::Ntrip;
+    stub_service stub{};
+    resolver res{stub.function()};
+    std::vector<endpoint> endpoints{};
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 1s));
+    EXPECT_EQ(1, last_octet(endpoints));
+    endpoints.clear();
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 0ms));
+    EXPECT_EQ(1U, endpoints.size());
+    EXPECT_EQ(1U, res.lookups());
+    // other port is other entry
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2102, endpoints, 1s));
+    EXPECT_EQ(2U, res.lookups());
+}
+
+TEST(testResolver, staleServedDuringRefresh)
+{
+    using namespace VrsTunnel::Ntrip;
+    stub_service stub{};
+    resolver_settings settings{};
+    settings.ttl = 20ms;
+    resolver res{stub.function(), settings};
+    std::vector<endpoint> endpoints{};
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 1s));
+
+    std::this_thread::sleep_for(30ms);
+    stub.octet = 2;
+    endpoints.clear();
+    // expired entry is returned at once, the refresh runs in background
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 0ms));
+    EXPECT_EQ(1, last_octet(endpoints));
+    for (int i = 0; i < 100 && res.lookups() < 2; ++i) {
+        std::this_thread::sleep_for(1ms);
+    }
+    std::this_thread::sleep_for(5ms);
+    endpoints.clear();
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 0ms));
+    EXPECT_EQ(2, last_octet(endpoints));
+}
+
+TEST(testResolver, staleServedWhenServiceFails)
+{
+    using namespace VrsTunnel::Ntrip;
+    stub_service stub{};
+    resolver_settings settings{};
+    settings.ttl = 10ms;
+    settings.negative_ttl = 10ms;
+    resolver res{stub.function(), settings};
+    std::vector<endpoint> endpoints{};
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 1s));
+
+    stub.broken = true;
+    for (int i = 0; i < 5; ++i) {
+        std::this_thread::sleep_for(15ms);
+        endpoints.clear();
+        EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 0ms));
+        EXPECT_EQ(1, last_octet(endpoints));
+    }
+    EXPECT_GT(res.lookups(), 2U);
+}
+
+TEST(testResolver, negativeCaching)
+{
+    using namespace VrsTunnel::Ntrip;
+    stub_service stub{};
+    stub.broken = true;
+    resolver res{stub.function()};
+    std::vector<endpoint> endpoints{};
+    EXPECT_EQ(io_status::Error, res.resolve("nowhere", 2101, endpoints, 1s));
+    EXPECT_EQ(io_status::Error, res.resolve("nowhere", 2101, endpoints, 1s));
+    EXPECT_EQ(1U, res.lookups());
+    EXPECT_TRUE(endpoints.empty());
+}
+
+TEST(testResolver, slowServiceDoesNotBlock)
+{
+    using namespace VrsTunnel::Ntrip;
+    stub_service stub{};
+    stub.delay = 100ms;
+    resolver res{stub.function()};
+    std::vector<endpoint> endpoints{};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(io_status::InProgress, res.resolve("caster", 2101, endpoints, 10ms));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 80ms);
+    // the lookup started by the first call is awaited, not repeated
+    EXPECT_EQ(io_status::Success, res.resolve("caster", 2101, endpoints, 1s));
+    EXPECT_EQ(1U, res.lookups());
+}
+
+TEST(testResolver, hostsFile)
+{
+    using namespace VrsTunnel::Ntrip;
+    resolver res{};
+    std::vector<endpoint> endpoints{};
+    ASSERT_EQ(io_status::Success, res.resolve("localhost", 2101, endpoints, 5s));
+    EXPECT_FALSE(endpoints.empty());
+    EXPECT_EQ(io_status::Error, res.resolve("name.invalid", 2101, endpoints, 5s));
+}
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "rtcm3.hpp"
+#include "stream_profile.hpp"
+
+namespace
+{
+    using bytes = std::vector<std::uint8_t>;
+
+    void setbitu(bytes& data, std::size_t pos, unsigned len, std::uint64_t value)
+    {
+        for (unsigned i = 0; i < len; ++i, ++pos) {
+            std::uint8_t mask = static_cast<std::uint8_t>(0x80 >> (pos & 7));
+            if ((value >> (len - 1 - i)) & 1) {
+                data[pos >> 3] |= mask;
+            }
+            else {
+                data[pos >> 3] &= static_cast<std::uint8_t>(~mask);
+            }
+        }
+    }
+
+    void setbits(bytes& data, std::size_t pos, unsigned len, std::int64_t value)
+    {
+        setbitu(data, pos, len, static_cast<std::uint64_t>(value));
+    }
+
+    /**
+     * @return payload of 1005 or 1006 for the ECEF point
+     */
+    bytes station_payload(std::uint16_t type, double x, double y, double z, double height = 0)
+    {
+        bytes p(type == 1006 ? 21 : 19, 0);
+        setbitu(p, 0, 12, type);
+        setbitu(p, 12, 12, 2301);   // station
+        setbitu(p, 24, 6, 20);      // ITRF2020
+        setbitu(p, 30, 1, 1);       // GPS
+        setbitu(p, 31, 1, 1);       // GLONASS
+        setbitu(p, 32, 1, 0);       // Galileo
+        setbits(p, 34, 38, std::llround(x * 10000));
+        setbits(p, 74, 38, std::llround(y * 10000));
+        setbits(p, 114, 38, std::llround(z * 10000));
+        if (type == 1006) {
+            setbitu(p, 152, 16, std::llround(height * 10000));
+        }
+        return p;
+    }
+
+    /**
+     * @return MSM payload with the header and cell mask, observation fields zeroed
+     */
+    bytes msm_payload(std::uint16_t type, std::uint32_t epoch, bool multiple,
+        std::uint64_t satellites, std::uint32_t signals, std::uint64_t cells, unsigned cell_bits)
+    {
+        bytes p(64, 0);
+        setbitu(p, 0, 12, type);
+        setbitu(p, 12, 12, 2301);
+        setbitu(p, 24, 30, epoch);
+        setbitu(p, 54, 1, multiple ? 1 : 0);
+        setbitu(p, 73, 32, satellites >> 32);
+        setbitu(p, 105, 32, satellites & 0xFFFFFFFF);
+        setbitu(p, 137, 32, signals);
+        setbitu(p, 169, cell_bits, cells);
+        return p;
+    }
+
+    bytes make_frame(const bytes& payload)
+    {
+        bytes f{0xD3, static_cast<std::uint8_t>(payload.size() >> 8), static_cast<std::uint8_t>(payload.size() & 0xFF)};
+        f.insert(f.end(), payload.begin(), payload.end());
+        std::uint32_t crc = VrsTunnel::Ntrip::rtcm3_framer::crc24q(f.data(), f.size());
+        f.push_back(static_cast<std::uint8_t>(crc >> 16));
+        f.push_back(static_cast<std::uint8_t>(crc >> 8));
+        f.push_back(static_cast<std::uint8_t>(crc));
+        return f;
+    }
+
+    /**
+     * WGS84 geodetic to ECEF, degrees and meters
+     */
+    void to_ecef(double lat, double lon, double h, double& x, double& y, double& z)
+    {
+        const double a = 6378137.0, f = 1.0 / 298.257223563, e2 = f * (2 - f);
+        double la = lat * M_PI / 180, lo = lon * M_PI / 180;
+        double n = a / std::sqrt(1 - e2 * std::sin(la) * std::sin(la));
+        x = (n + h) * std::cos(la) * std::cos(lo);
+        y = (n + h) * std::cos(la) * std::sin(lo);
+        z = (n * (1 - e2) + h) * std::sin(la);
+    }
+}
+
+TEST(testRtcm3, bitFields)
+{
+    using VrsTunnel::Ntrip::rtcm3;
+    const std::uint8_t data[] {0x3E, 0xD0, 0xFF, 0x80, 0x00, 0x01, 0x23, 0x45, 0x67, 0x89};
+    EXPECT_EQ(1005U, rtcm3::getbitu(data, 0, 12));
+    EXPECT_EQ(0U, rtcm3::getbitu(data, 12, 4));
+    EXPECT_EQ(0xFFU, rtcm3::getbitu(data, 16, 8));
+    EXPECT_EQ(1U, rtcm3::getbitu(data, 24, 1));
+    EXPECT_EQ(-1, rtcm3::getbits(data, 16, 9));
+    EXPECT_EQ(-1, rtcm3::getbits(data, 17, 8));
+    EXPECT_EQ(-128, rtcm3::getbits(data, 24, 8));
+    EXPECT_EQ(0U, rtcm3::getbitu(data, 3, 0));
+    EXPECT_EQ(0x0123456789ULL, rtcm3::getbitu(data, 40, 40));
+    EXPECT_EQ(0x3ED0FF80000123ULL, rtcm3::getbitu(data, 0, 56));
+
+    bytes buf(8, 0);
+    setbits(buf, 5, 38, -123456789012LL);
+    EXPECT_EQ(-123456789012LL, rtcm3::getbits(buf.data(), 5, 38));
+    setbits(buf, 5, 38, 98765432101LL);
+    EXPECT_EQ(98765432101LL, rtcm3::getbits(buf.data(), 5, 38));
+}
+
+TEST(testRtcm3, decodeStation)
+{
+    using namespace VrsTunnel::Ntrip;
+    bytes f1005 = make_frame(station_payload(1005, 3163974.4186, 1865126.2243, -4980271.5113));
+    station_position pos{};
+    ASSERT_TRUE(rtcm3::decode_station(rtcm3_frame{f1005.data(), f1005.size()}, pos));
+    EXPECT_EQ(2301, pos.station_id);
+    EXPECT_EQ(20, pos.itrf_year);
+    EXPECT_TRUE(pos.gps);
+    EXPECT_TRUE(pos.glonass);
+    EXPECT_FALSE(pos.galileo);
+    EXPECT_NEAR(3163974.4186, pos.x, 1e-6);
+    EXPECT_NEAR(1865126.2243, pos.y, 1e-6);
+    EXPECT_NEAR(-4980271.5113, pos.z, 1e-6);
+    EXPECT_EQ(0.0, pos.antenna_height);
+
+    bytes f1006 = make_frame(station_payload(1006, 1, -2, 3, 1.5432));
+    ASSERT_TRUE(rtcm3::decode_station(rtcm3_frame{f1006.data(), f1006.size()}, pos));
+    EXPECT_NEAR(-2.0, pos.y, 1e-9);
+    EXPECT_NEAR(1.5432, pos.antenna_height, 1e-9);
+
+    bytes short_payload = station_payload(1006, 1, 2, 3);
+    short_payload.pop_back();
+    bytes truncated = make_frame(short_payload);
+    EXPECT_FALSE(rtcm3::decode_station(rtcm3_frame{truncated.data(), truncated.size()}, pos));
+    bytes other = make_frame(station_payload(1033, 1, 2, 3));
+    EXPECT_FALSE(rtcm3::decode_station(rtcm3_frame{other.data(), other.size()}, pos));
+}
+
+TEST(testRtcm3, ecefToGeodetic)
+{
+    using VrsTunnel::Ntrip::rtcm3;
+    struct point { double lat, lon, h; };
+    for (point p : {point{50.450001, 30.523333, 180.0}, point{-33.8688, 151.2093, 58.2},
+            point{0.0, -179.9, 0.0}, point{89.99, 10.0, 3000.0}, point{-45.0, 0.0, -30.0}}) {
+        double x, y, z;
+        to_ecef(p.lat, p.lon, p.h, x, y, z);
+        auto loc = rtcm3::ecef_to_geodetic(x, y, z);
+        EXPECT_NEAR(p.lat, loc.Latitude, 1e-9);
+        EXPECT_NEAR(p.lon, loc.Longitude, 1e-9);
+        EXPECT_NEAR(p.h, loc.Elevation, 1e-3);
+    }
+    auto pole = rtcm3::ecef_to_geodetic(0, 0, 6356752.3142 + 10);
+    EXPECT_NEAR(90.0, pole.Latitude, 1e-9);
+    EXPECT_NEAR(10.0, pole.Elevation, 1e-3);
+}
+
+TEST(testRtcm3, streamProfileStr)
+{
+    using namespace VrsTunnel::Ntrip;
+    stream_profile profile{};
+    EXPECT_TRUE(profile.empty());
+    EXPECT_EQ("KYIV;KYIV;;;0;;none;;50.000000;30.000000;0;0;VrsTunnel;none;B;N;0;",
+        profile.str("KYIV", location{50, 30, 0}));
+
+    double x, y, z;
+    to_ecef(50.450001, 30.523333, 180.0, x, y, z);
+    bytes f1005 = make_frame(station_payload(1005, x, y, z));
+    bytes f1077 = make_frame(bytes{0x43, 0x50, 0, 0});
+    bytes f1087 = make_frame(bytes{0x43, 0xF0, 0, 0});
+    for (const auto* f : {&f1077, &f1087, &f1005}) {
+        profile.add(rtcm3_frame{f->data(), f->size()});
+    }
+    EXPECT_FALSE(profile.empty());
+    ASSERT_TRUE(profile.has_position());
+    EXPECT_NEAR(50.450001, profile.position().Latitude, 1e-8);
+    EXPECT_EQ("KYIV;KYIV;RTCM 3;1005,1077,1087;2;GPS+GLONASS;none;;50.450001;30.523333;0;0;VrsTunnel;none;B;N;0;",
+        profile.str("KYIV", location{}));
+}
+
+TEST(testRtcm3, msmHeader)
+{
+    using namespace VrsTunnel::Ntrip;
+    EXPECT_TRUE(rtcm3::is_msm(1077));
+    EXPECT_TRUE(rtcm3::is_msm(1084));
+    EXPECT_TRUE(rtcm3::is_msm(1127));
+    EXPECT_TRUE(rtcm3::is_msm(1071));
+    EXPECT_FALSE(rtcm3::is_msm(1070));
+    EXPECT_FALSE(rtcm3::is_msm(1078));
+    EXPECT_FALSE(rtcm3::is_msm(1005));
+    EXPECT_FALSE(rtcm3::is_msm(1230));
+
+    // 8 GPS satellites (two above bit 32), 3 signals, 22 of 24 cells
+    std::uint64_t sats = 0x8000000100000000ULL | 0x0000000080C01101ULL;
+    bytes f1077 = make_frame(msm_payload(1077, 345'600'000, true, sats, 0x40040100U,
+        0xFFFFFFULL & ~0x41ULL, 24));
+    msm_header header{};
+    ASSERT_TRUE(rtcm3::decode_msm(rtcm3_frame{f1077.data(), f1077.size()}, header));
+    EXPECT_EQ(1077, header.type);
+    EXPECT_EQ(2301, header.station_id);
+    EXPECT_EQ(msm_system::gps, header.system);
+    EXPECT_EQ(345'600'000U, header.epoch_time);
+    EXPECT_TRUE(header.multiple);
+    EXPECT_EQ(8, header.satellites);
+    EXPECT_EQ(3, header.signals);
+    EXPECT_EQ(22, header.cells);
+
+    // 16 x 4 cells use the whole 64-bit cell mask
+    bytes f1124 = make_frame(msm_payload(1124, 1000, false, 0xFFFF, 0xF, ~0ULL, 64));
+    ASSERT_TRUE(rtcm3::decode_msm(rtcm3_frame{f1124.data(), f1124.size()}, header));
+    EXPECT_EQ(msm_system::beidou, header.system);
+    EXPECT_FALSE(header.multiple);
+    EXPECT_EQ(16, header.satellites);
+    EXPECT_EQ(4, header.signals);
+    EXPECT_EQ(64, header.cells);
+
+    bytes too_many = make_frame(msm_payload(1087, 0, false, 0x1FFFF, 0xF, 0, 0));
+    EXPECT_FALSE(rtcm3::decode_msm(rtcm3_frame{too_many.data(), too_many.size()}, header));
+    bytes short_msm = msm_payload(1097, 0, false, 1, 1, 1, 1);
+    short_msm.resize(21);   // 168 bits, the signal mask is cut
+    bytes truncated = make_frame(short_msm);
+    EXPECT_FALSE(rtcm3::decode_msm(rtcm3_frame{truncated.data(), truncated.size()}, header));
+    bytes f1005 = make_frame(station_payload(1005, 1, 2, 3));
+    EXPECT_FALSE(rtcm3::decode_msm(rtcm3_frame{f1005.data(), f1005.size()}, header));
+}
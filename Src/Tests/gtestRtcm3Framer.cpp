@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rtcm3_framer.hpp"
+
+namespace
+{
+    using bytes = std::vector<std::uint8_t>;
+
+    /**
+     * Bit by bit CRC-24Q for comparison
+     */
+    std::uint32_t crc24q_reference(const std::uint8_t* data, std::size_t size)
+    {
+        std::uint32_t crc = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            crc ^= static_cast<std::uint32_t>(data[i]) << 16;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc <<= 1;
+                if (crc & 0x1000000U) {
+                    crc ^= 0x1864CFBU;
+                }
+            }
+        }
+        return crc & 0xFFFFFFU;
+    }
+
+    /**
+     * @return RTCM3 frame of message type with payload of the given size
+     */
+    bytes make_frame(std::uint16_t type, std::size_t size, std::uint8_t fill = 0x55)
+    {
+        bytes f{0xD3, static_cast<std::uint8_t>((size >> 8) & 0x03), static_cast<std::uint8_t>(size & 0xFF)};
+        bytes payload(size, fill);
+        if (size >= 2) {
+            payload[0] = static_cast<std::uint8_t>(type >> 4);
+            payload[1] = static_cast<std::uint8_t>((type & 0x0F) << 4);
+        }
+        f.insert(f.end(), payload.begin(), payload.end());
+        std::uint32_t crc = crc24q_reference(f.data(), f.size());
+        f.push_back(static_cast<std::uint8_t>(crc >> 16));
+        f.push_back(static_cast<std::uint8_t>(crc >> 8));
+        f.push_back(static_cast<std::uint8_t>(crc));
+        return f;
+    }
+
+    bytes operator+(bytes a, const bytes& b)
+    {
+        a.insert(a.end(), b.begin(), b.end());
+        return a;
+    }
+
+    /**
+     * Feeds the stream in chunks of the given size
+     * @return frames found, in order
+     */
+    std::vector<bytes> split(VrsTunnel::Ntrip::rtcm3_framer& framer, const bytes& stream, std::size_t chunk)
+    {
+        using namespace VrsTunnel::Ntrip;
+        std::vector<bytes> frames{};
+        for (std::size_t pos = 0; pos < stream.size(); pos += chunk) {
+            framer.feed(stream.data() + pos, std::min(chunk, stream.size() - pos));
+            rtcm3_frame frame{};
+            while (framer.next(frame) == io_status::Success) {
+                frames.emplace_back(frame.data, frame.data + frame.size);
+            }
+        }
+        return frames;
+    }
+}
+
+TEST(testRtcm3Framer, crcCheckValue)
+{
+    using VrsTunnel::Ntrip::rtcm3_framer;
+    std::string check = "123456789";
+    EXPECT_EQ(0xCDE703U, rtcm3_framer::crc24q(reinterpret_cast<const std::uint8_t*>(check.data()), check.size()));
+
+    bytes data(100);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::uint8_t>(i * 37 + 11);
+    }
+    for (std::size_t size = 0; size <= data.size(); ++size) {
+        std::uint32_t expected = crc24q_reference(data.data(), size);
+        ASSERT_EQ(expected, rtcm3_framer::crc24q(data.data(), size)) << size;
+        std::size_t half = size / 3;
+        ASSERT_EQ(expected, rtcm3_framer::crc24q(data.data() + half, size - half,
+            rtcm3_framer::crc24q(data.data(), half))) << size;
+    }
+}
+
+TEST(testRtcm3Framer, framesInPlace)
+{
+    using namespace VrsTunnel::Ntrip;
+    bytes stream = make_frame(1005, 19) + make_frame(1077, 400) + make_frame(0, 0);
+    rtcm3_framer framer{};
+    framer.feed(stream.data(), stream.size());
+    rtcm3_frame frame{};
+    ASSERT_EQ(io_status::Success, framer.next(frame));
+    EXPECT_EQ(stream.data(), frame.data);
+    EXPECT_EQ(25U, frame.size);
+    EXPECT_EQ(19U, frame.payload_size());
+    EXPECT_EQ(1005, frame.message_type());
+    ASSERT_EQ(io_status::Success, framer.next(frame));
+    EXPECT_EQ(stream.data() + 25, frame.data);
+    EXPECT_EQ(1077, frame.message_type());
+    ASSERT_EQ(io_status::Success, framer.next(frame));
+    EXPECT_EQ(0U, frame.payload_size());
+    EXPECT_EQ(0, frame.message_type());
+    EXPECT_EQ(io_status::InProgress, framer.next(frame));
+    EXPECT_EQ(3U, framer.stats().frames);
+    EXPECT_EQ(0U, framer.stats().discarded_bytes);
+}
+
+TEST(testRtcm3Framer, splitAcrossFeeds)
+{
+    using namespace VrsTunnel::Ntrip;
+    bytes f1 = make_frame(1074, 1023);
+    bytes f2 = make_frame(1033, 30);
+    bytes f3 = make_frame(1230, 8);
+    bytes stream = f1 + f2 + f3 + f2;
+    for (std::size_t chunk : {1U, 2U, 3U, 7U, 100U, 1024U, 1029U, 5000U}) {
+        rtcm3_framer framer{};
+        auto frames = split(framer, stream, chunk);
+        ASSERT_EQ(4U, frames.size()) << chunk;
+        EXPECT_EQ(f1, frames[0]);
+        EXPECT_EQ(f2, frames[1]);
+        EXPECT_EQ(f3, frames[2]);
+        EXPECT_EQ(f2, frames[3]);
+    }
+}
+
+TEST(testRtcm3Framer, resyncAfterCorruption)
+{
+    using namespace VrsTunnel::Ntrip;
+    bytes f1 = make_frame(1005, 19);
+    bytes f2 = make_frame(1124, 60);
+    bytes broken = f2;
+    broken[20] ^= 0x10;
+    bytes noise{0x01, 0xD3, 0xFF, 0x02};
+    bytes stream = noise + broken + f1 + f2;
+    for (std::size_t chunk : {1U, 5U, 64U, 4096U}) {
+        rtcm3_framer framer{};
+        auto frames = split(framer, stream, chunk);
+        ASSERT_EQ(2U, frames.size()) << chunk;
+        EXPECT_EQ(f1, frames[0]);
+        EXPECT_EQ(f2, frames[1]);
+        EXPECT_EQ(1U, framer.stats().crc_errors);
+        EXPECT_EQ(noise.size() + broken.size(), framer.stats().discarded_bytes);
+    }
+}
+
+TEST(testRtcm3Framer, frameInsideFalseCandidate)
+{
+    using namespace VrsTunnel::Ntrip;
+    // a stray preamble announces 64 bytes and swallows the real frames
+    bytes stray{0xD3, 0x00, 0x40};
+    bytes f1 = make_frame(1006, 21);
+    bytes f2 = make_frame(1094, 200);
+    bytes stream = stray + f1 + f2;
+    for (std::size_t chunk : {1U, 4U, 30U, 1000U}) {
+        rtcm3_framer framer{};
+        auto frames = split(framer, stream, chunk);
+        ASSERT_EQ(2U, frames.size()) << chunk;
+        EXPECT_EQ(f1, frames[0]);
+        EXPECT_EQ(f2, frames[1]);
+        EXPECT_EQ(3U, framer.stats().discarded_bytes);
+    }
+}
+
+TEST(testRtcm3Framer, reset)
+{
+    using namespace VrsTunnel::Ntrip;
+    bytes f1 = make_frame(1005, 19);
+    rtcm3_framer framer{};
+    framer.feed(f1.data(), 10);
+    rtcm3_frame frame{};
+    EXPECT_EQ(io_status::InProgress, framer.next(frame));
+    framer.reset();
+    EXPECT_EQ(10U, framer.stats().discarded_bytes);
+    framer.feed(f1.data(), f1.size());
+    ASSERT_EQ(io_status::Success, framer.next(frame));
+    EXPECT_EQ(f1.data(), frame.data);
+}
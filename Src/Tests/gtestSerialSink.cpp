@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "serial_sink.hpp"
+
+namespace
+{
+    /**
+     * Pseudo terminal pair, the sink opens the slave side,
+     * the test reads what a receiver would get from the master
+     */
+    struct pty_pair
+    {
+        int master{-1};
+        std::string slave{};
+
+        pty_pair()
+        {
+            master = ::posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+            EXPECT_GE(master, 0);
+            EXPECT_EQ(0, ::grantpt(master));
+            EXPECT_EQ(0, ::unlockpt(master));
+            slave = ::ptsname(master);
+        }
+        ~pty_pair()
+        {
+            ::close(master);
+        }
+
+        std::string received()
+        {
+            std::string result{};
+            char buf[4096];
+            struct pollfd pfd{master, POLLIN, 0};
+            while (::poll(&pfd, 1, 50) > 0) {
+                ssize_t n = ::read(master, buf, sizeof(buf));
+                if (n <= 0) {
+                    break;
+                }
+                result.append(buf, n);
+            }
+            return result;
+        }
+    };
+
+    /**
+     * @return RTCM3 frame with payload of the given size
+     */
+    std::string frame(std::size_t payload, char fill = 'p')
+    {
+        std::string f{};
+        f.push_back('\xD3');
+        f.push_back(static_cast<char>((payload >> 8) & 0x03));
+        f.push_back(static_cast<char>(payload & 0xFF));
+        f.append(payload, fill);
+        std::uint32_t crc = VrsTunnel::Ntrip::rtcm3_framer::crc24q(
+            reinterpret_cast<const std::uint8_t*>(f.data()), f.size());
+        f.push_back(static_cast<char>(crc >> 16));
+        f.push_back(static_cast<char>(crc >> 8));
+        f.push_back(static_cast<char>(crc));
+        return f;
+    }
+}
+
+TEST(testSerialSink, openConfiguresPort)
+{
+    using namespace VrsTunnel::Ntrip;
+    pty_pair pty{};
+    serial_sink sink{};
+    serial_settings settings{};
+    settings.baud = 9600;
+    settings.flow = flow_control::rtscts;
+    ASSERT_EQ(io_status::Success, sink.open(pty.slave, settings));
+    struct termios tio{};
+    ASSERT_EQ(0, ::tcgetattr(sink.get_fd(), &tio));
+    EXPECT_EQ(static_cast<speed_t>(B9600), ::cfgetospeed(&tio));
+    EXPECT_NE(0U, tio.c_cflag & CRTSCTS);
+    EXPECT_EQ(0U, tio.c_lflag & ICANON);
+
+    settings.baud = 12345;
+    EXPECT_EQ(io_status::Error, sink.open(pty.slave, settings));
+    EXPECT_EQ(-1, sink.get_fd());
+    EXPECT_EQ(io_status::Error, sink.open("/nonexistent/tty", serial_settings{}));
+}
+
+TEST(testSerialSink, parseFlowControl)
+{
+    using namespace VrsTunnel::Ntrip;
+    flow_control flow{};
+    EXPECT_TRUE(serial_sink::parse("xonxoff", flow));
+    EXPECT_EQ(flow_control::xonxoff, flow);
+    EXPECT_TRUE(serial_sink::parse("none", flow));
+    EXPECT_EQ(flow_control::none, flow);
+    EXPECT_FALSE(serial_sink::parse("cts", flow));
+}
+
+TEST(testSerialSink, wholeFramesOnly)
+{
+    using namespace VrsTunnel::Ntrip;
+    pty_pair pty{};
+    serial_sink sink{};
+    ASSERT_EQ(io_status::Success, sink.open(pty.slave, serial_settings{}));
+
+    std::string f = frame(100);
+    for (std::size_t i = 0; i + 1 < f.size(); ++i) {
+        ASSERT_EQ(io_status::Success, sink.write(f.data() + i, 1));
+    }
+    EXPECT_EQ("", pty.received());
+    ASSERT_EQ(io_status::Success, sink.write(f.data() + f.size() - 1, 1));
+    EXPECT_EQ(f, pty.received());
+    EXPECT_EQ(1U, sink.stats().frames);
+    EXPECT_EQ(f.size(), sink.stats().bytes);
+}
+
+TEST(testSerialSink, discardsBytesOutsideFrames)
+{
+    using namespace VrsTunnel::Ntrip;
+    pty_pair pty{};
+    serial_sink sink{};
+    ASSERT_EQ(io_status::Success, sink.open(pty.slave, serial_settings{}));
+
+    std::string f1 = frame(10, 'a');
+    std::string f2 = frame(0);
+    // a preamble byte with reserved bits set is noise, so is a frame with broken CRC
+    std::string broken = f1;
+    broken[5] ^= 1;
+    std::string stream = "noise" + f1 + std::string("\xD3\xFF", 2) + broken + f2;
+    ASSERT_EQ(io_status::Success, sink.write(stream.data(), stream.size()));
+    EXPECT_EQ(f1 + f2, pty.received());
+    EXPECT_EQ(2U, sink.stats().frames);
+    EXPECT_EQ(7U + broken.size(), sink.stats().discarded_bytes);
+
+    std::string half = frame(20).substr(0, 10);
+    ASSERT_EQ(io_status::Success, sink.write(half.data(), half.size()));
+    sink.reset();
+    ASSERT_EQ(io_status::Success, sink.write(f1.data(), f1.size()));
+    EXPECT_EQ(f1, pty.received());
+    EXPECT_EQ(17U + broken.size(), sink.stats().discarded_bytes);
+}
+
+TEST(testSerialSink, dropsFramesOverLinkBandwidth)
+{
+    using namespace VrsTunnel::Ntrip;
+    pty_pair pty{};
+    serial_sink sink{};
+    serial_settings settings{};
+    settings.baud = 9600;                           // 960 bytes per second
+    settings.max_backlog = std::chrono::milliseconds(250); // 240 bytes
+    ASSERT_EQ(io_status::Success, sink.open(pty.slave, settings));
+
+    std::string f = frame(94);  // 100 bytes
+    std::string burst = f + f + f;
+    ASSERT_EQ(io_status::Success, sink.write(burst.data(), burst.size()));
+    EXPECT_EQ(f + f, pty.received());
+    EXPECT_EQ(2U, sink.stats().frames);
+    EXPECT_EQ(1U, sink.stats().dropped_frames);
+    EXPECT_EQ(100U, sink.stats().dropped_bytes);
+
+    ::usleep(300 * 1000);   // the link drained
+    ASSERT_EQ(io_status::Success, sink.write(f.data(), f.size()));
+    EXPECT_EQ(f, pty.received());
+    EXPECT_EQ(1U, sink.stats().dropped_frames);
+}
+
+TEST(testSerialSink, blockedPortKeepsWholeFrames)
+{
+    using namespace VrsTunnel::Ntrip;
+    pty_pair pty{};
+    serial_sink sink{};
+    serial_settings settings{};
+    settings.baud = 921600;
+    settings.max_backlog = std::chrono::seconds(10);   // the link model never drops here
+    ASSERT_EQ(io_status::Success, sink.open(pty.slave, settings));
+
+    std::string f = frame(997);
+    for (int i = 0; i < 1000 && !sink.blocked(); ++i) {
+        ASSERT_EQ(io_status::Success, sink.write(f.data(), f.size()));
+    }
+    ASSERT_TRUE(sink.blocked());
+    // a full output drops whole frames instead of waiting for the port
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_EQ(io_status::Success, sink.write(f.data(), f.size()));
+    }
+    EXPECT_GT(sink.stats().dropped_frames, 0U);
+
+    std::string received{};
+    io_status res{};
+    while ((res = sink.flush()) == io_status::InProgress) {
+        received += pty.received();
+    }
+    EXPECT_EQ(io_status::Success, res);
+    EXPECT_FALSE(sink.blocked());
+    received += pty.received();
+    ASSERT_EQ(sink.stats().bytes, received.size());
+    ASSERT_EQ(0U, received.size() % f.size());
+    for (std::size_t pos = 0; pos < received.size(); pos += f.size()) {
+        ASSERT_EQ(f, received.substr(pos, f.size()));
+    }
+}
+
+TEST(testSerialSink, passThrough)
+{
+    using namespace VrsTunnel::Ntrip;
+    pty_pair pty{};
+    serial_sink sink{};
+    serial_settings settings{};
+    settings.rtcm_frames = false;
+    ASSERT_EQ(io_status::Success, sink.open(pty.slave, settings));
+    std::string cmr = "\x02\x01\x93 not rtcm";
+    ASSERT_EQ(io_status::Success, sink.write(cmr.data(), cmr.size()));
+    EXPECT_EQ(cmr, pty.received());
+}
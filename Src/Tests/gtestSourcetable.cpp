@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "sourcetable.hpp"
+#include "mount_point.hpp"
+#include "ntrip_client.hpp"
+
+namespace
+{
+    std::string response(const VrsTunnel::Ntrip::sourcetable::rendered& table)
+    {
+        return std::string(table.v1_header->view()) + std::string(table.body->view());
+    }
+}
+
+TEST(testSourcetable, emptyTable)
+{
+    VrsTunnel::Ntrip::sourcetable st{};
+    auto table = st.get();
+    ASSERT_NE(nullptr, table);
+    EXPECT_EQ("ENDSOURCETABLE\r\n", table->body->view());
+    EXPECT_NE(std::string::npos, table->v1_header->view().find("Content-Length: 16\r\n"));
+    EXPECT_EQ(0U, table->v2_header->view().find("HTTP/1.1 200 OK\r\n"));
+}
+
+TEST(testSourcetable, parsedByClient)
+{
+    VrsTunnel::Ntrip::sourcetable st{};
+    st.add("MNT1", "MNT1;Kyiv;RTCM 3;1004(1),1005(5);2;GPS+GLONASS;VrsTunnel;UKR;50.45;30.52;0;0;VrsTunnel;none;B;N;9600;;");
+    st.add("MNT2", "");
+    auto table = st.get();
+    std::string raw = response(*table);
+
+    VrsTunnel::Ntrip::ntrip_client nc{};
+    EXPECT_TRUE(nc.hasTableEnding(raw));
+    auto mounts = VrsTunnel::Ntrip::mount_point::parse_table(raw);
+    ASSERT_EQ(2U, mounts.size());
+    EXPECT_EQ("MNT1", mounts[0].name);
+    EXPECT_EQ("RTCM 3", mounts[0].type);
+    EXPECT_DOUBLE_EQ(50.45, mounts[0].reference.Latitude);
+    EXPECT_DOUBLE_EQ(30.52, mounts[0].reference.Longitude);
+    EXPECT_EQ("MNT2", mounts[1].name);
+    std::string length = "Content-Length: " + std::to_string(table->body->size()) + "\r\n";
+    EXPECT_NE(std::string::npos, table->v2_header->view().find(length));
+}
+
+TEST(testSourcetable, renderedOnChangeOnly)
+{
+    VrsTunnel::Ntrip::sourcetable st{};
+    st.add("MNT1", "");
+    auto first = st.get();
+    EXPECT_EQ(first, st.get());
+    st.add("MNT1", "");
+    EXPECT_EQ(first, st.get());     // same entry, nothing rendered
+
+    st.add("MNT2", "");
+    auto second = st.get();
+    EXPECT_GT(second->version, first->version);
+    EXPECT_EQ(std::string::npos, first->body->view().find("MNT2"));   // old snapshot is immutable
+
+    EXPECT_TRUE(st.remove("MNT2"));
+    EXPECT_FALSE(st.remove("MNT2"));
+    EXPECT_GT(st.get()->version, second->version);
+    EXPECT_EQ(first->body->view(), st.get()->body->view());
+}
+
+TEST(testSourcetable, positionFromStream)
+{
+    VrsTunnel::Ntrip::sourcetable st{};
+    st.add("MNT1", "MNT1;Kyiv;RTCM 3;1004(1),1005(5);2;GPS+GLONASS;VrsTunnel;UKR;0.00;0.00;0;0;VrsTunnel;none;B;N;9600;;");
+    auto before = st.get();
+    EXPECT_TRUE(st.set_position("MNT1", VrsTunnel::Ntrip::location{50.450001, 30.523333, 180}));
+    auto after = st.get();
+    EXPECT_GT(after->version, before->version);
+    EXPECT_NE(std::string::npos, after->body->view().find(";UKR;50.450001;30.523333;0;0;VrsTunnel;"));
+    EXPECT_TRUE(st.set_position("MNT1", VrsTunnel::Ntrip::location{50.4500012, 30.5233331, 181}));
+    EXPECT_EQ(after, st.get());     // same after rounding
+    EXPECT_FALSE(st.set_position("MNT2", VrsTunnel::Ntrip::location{}));
+
+    auto mounts = VrsTunnel::Ntrip::mount_point::parse_table(response(*st.get()));
+    ASSERT_EQ(1U, mounts.size());
+    EXPECT_DOUBLE_EQ(50.450001, mounts[0].reference.Latitude);
+}
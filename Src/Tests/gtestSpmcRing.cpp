@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spmc_ring.hpp"
+
+TEST(testSpmcRing, publishAndRead)
+{
+    using namespace VrsTunnel::Ntrip;
+    spmc_ring ring{8};
+    auto first = ring.subscribe();
+    ring.publish("abc", 3);
+    auto second = ring.subscribe();
+    ring.publish("defg", 4);
+
+    char buf[spmc_ring::slot_size];
+    std::size_t size = 0;
+    EXPECT_EQ(ring_status::Success, ring.read(first, buf, size));
+    EXPECT_EQ("abc", std::string(buf, size));
+    EXPECT_EQ(ring_status::Success, ring.read(first, buf, size));
+    EXPECT_EQ("defg", std::string(buf, size));
+    EXPECT_EQ(ring_status::Empty, ring.read(first, buf, size));
+
+    EXPECT_EQ(1U, ring.lag(second));
+    EXPECT_EQ(ring_status::Success, ring.read(second, buf, size));
+    EXPECT_EQ("defg", std::string(buf, size));
+    EXPECT_EQ(ring_status::Empty, ring.read(second, buf, size));
+}
+
+TEST(testSpmcRing, largeChunkIsSplit)
+{
+    using namespace VrsTunnel::Ntrip;
+    spmc_ring ring{8};
+    auto cur = ring.subscribe();
+    std::string big(spmc_ring::slot_size + 10, 'x');
+    ring.publish(big.data(), big.size());
+    EXPECT_EQ(2U, ring.lag(cur));
+
+    char buf[spmc_ring::slot_size];
+    std::size_t size = 0;
+    EXPECT_EQ(ring_status::Success, ring.read(cur, buf, size));
+    EXPECT_EQ(spmc_ring::slot_size, size);
+    EXPECT_EQ(ring_status::Success, ring.read(cur, buf, size));
+    EXPECT_EQ(10U, size);
+}
+
+TEST(testSpmcRing, tagsFollowChunks)
+{
+    using namespace VrsTunnel::Ntrip;
+    spmc_ring ring{8};
+    auto cur = ring.subscribe();
+    ring.publish("abc", 3, 1);
+    std::string big(spmc_ring::slot_size + 10, 'x');
+    ring.publish(big.data(), big.size(), 2);
+
+    char buf[spmc_ring::slot_size];
+    std::size_t size = 0;
+    std::uint32_t tag = 0;
+    EXPECT_EQ(ring_status::Success, ring.read(cur, buf, size, tag));
+    EXPECT_EQ(1U, tag);
+    EXPECT_EQ(ring_status::Success, ring.read(cur, buf, size, tag));
+    EXPECT_EQ(2U, tag);
+    EXPECT_EQ(ring_status::Success, ring.read(cur, buf, size, tag));
+    EXPECT_EQ(2U, tag);
+    EXPECT_EQ(10U, size);
+}
+
+TEST(testSpmcRing, slowConsumerIsLapped)
+{
+    using namespace VrsTunnel::Ntrip;
+    spmc_ring ring{4};
+    auto cur = ring.subscribe();
+    for (int i = 0; i < 10; ++i) {
+        ring.publish(reinterpret_cast<const char*>(&i), sizeof(i));
+    }
+    char buf[spmc_ring::slot_size];
+    std::size_t size = 0;
+    EXPECT_EQ(ring_status::Lapped, ring.read(cur, buf, size));
+    EXPECT_EQ(1U, cur.lapped);
+    EXPECT_EQ(10U, cur.lost);
+    EXPECT_EQ(ring_status::Empty, ring.read(cur, buf, size));
+
+    int value = 10;
+    ring.publish(reinterpret_cast<const char*>(&value), sizeof(value));
+    EXPECT_EQ(ring_status::Success, ring.read(cur, buf, size));
+    int received = 0;
+    ::memcpy(&received, buf, sizeof(received));
+    EXPECT_EQ(10, received);
+}
+
+TEST(testSpmcRing, concurrentConsumers)
+{
+    using namespace VrsTunnel::Ntrip;
+    spmc_ring ring{64};
+    constexpr std::uint64_t total = 200000;
+    constexpr int n_consumers = 3;
+    std::vector<spmc_ring::cursor> cursors(n_consumers, ring.subscribe());
+    std::vector<std::uint64_t> received(n_consumers, 0);
+    std::vector<bool> ordered(n_consumers, true);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> consumers{};
+    for (int c = 0; c < n_consumers; ++c) {
+        consumers.emplace_back([&, c]() {
+            char buf[spmc_ring::slot_size];
+            std::size_t size = 0;
+            std::uint64_t last = 0;
+            for (;;) {
+                bool finished = done.load();
+                auto res = ring.read(cursors[c], buf, size);
+                if (res == ring_status::Success) {
+                    // every chunk repeats its number, torn copies would differ
+                    std::uint64_t value[4];
+                    ::memcpy(value, buf, sizeof(value));
+                    if (size != sizeof(value) || value[0] != value[3] || value[0] <= last) {
+                        ordered[c] = false;
+                    }
+                    last = value[0];
+                    ++received[c];
+                }
+                else if (res == ring_status::Empty && finished) {
+                    break;
+                }
+            }
+        });
+    }
+    for (std::uint64_t i = 1; i <= total; ++i) {
+        std::uint64_t value[4] = {i, i, i, i};
+        ring.publish(reinterpret_cast<const char*>(value), sizeof(value));
+    }
+    done.store(true);
+    for (auto& th : consumers) {
+        th.join();
+    }
+    for (int c = 0; c < n_consumers; ++c) {
+        EXPECT_TRUE(ordered[c]);
+        EXPECT_EQ(total, received[c] + cursors[c].lost);
+    }
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "tcp_client.hpp"
+
+namespace
+{
+    /**
+     * Listening socket on a loopback ephemeral port
+     */
+    struct loopback_listener
+    {
+        int fd{-1};
+        std::vector<int> backlog{};  /**< Connections never accepted */
+
+        explicit loopback_listener(bool stalled = false)
+        {
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            struct sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            EXPECT_EQ(0, ::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+            EXPECT_EQ(0, ::listen(fd, 0));
+            if (stalled) {
+                // once the accept queue is full new SYNs are dropped like by a blackhole
+                for (int i = 0; i < 4; ++i) {
+                    int c = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+                    struct sockaddr_storage ep = address().address;
+                    ::connect(c, reinterpret_cast<struct sockaddr*>(&ep), sizeof(struct sockaddr_in));
+                    backlog.push_back(c);
+                }
+            }
+        }
+        ~loopback_listener()
+        {
+            for (int c : backlog) {
+                ::close(c);
+            }
+            ::close(fd);
+        }
+
+        VrsTunnel::Ntrip::endpoint address() const
+        {
+            VrsTunnel::Ntrip::endpoint ep{};
+            ep.length = sizeof(struct sockaddr_in);
+            ::getsockname(fd, reinterpret_cast<struct sockaddr*>(&ep.address), &ep.length);
+            return ep;
+        }
+    };
+
+    int peer_port(int sockfd)
+    {
+        struct sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        ::getpeername(sockfd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        return ntohs(addr.sin_port);
+    }
+
+    int port_of(const VrsTunnel::Ntrip::endpoint& ep)
+    {
+        return ntohs(reinterpret_cast<const struct sockaddr_in*>(&ep.address)->sin_port);
+    }
+}
+
+TEST(testTcpClient, stalledAddressIsOvertaken)
+{
+    using namespace VrsTunnel::Ntrip;
+    using namespace std::chrono_literals;
+    loopback_listener stalled{true};
+    loopback_listener alive{};
+    tcp_client tc{};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(io_status::Success, tc.connect({stalled.address(), alive.address()}, 5s, 50ms));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, 50ms);
+    EXPECT_LT(elapsed, 1s);
+    EXPECT_EQ(port_of(alive.address()), peer_port(tc.get_sockfd()));
+}
+
+TEST(testTcpClient, refusedAddressIsSkipped)
+{
+    using namespace VrsTunnel::Ntrip;
+    using namespace std::chrono_literals;
+    endpoint refused{};
+    {
+        loopback_listener closed{};
+        refused = closed.address();
+    }
+    loopback_listener alive{};
+    tcp_client tc{};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(io_status::Success, tc.connect({refused, alive.address()}, 5s, 1s));
+    // the next address does not wait for the attempt delay
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+    EXPECT_EQ(port_of(alive.address()), peer_port(tc.get_sockfd()));
+}
+
+TEST(testTcpClient, overallDeadline)
+{
+    using namespace VrsTunnel::Ntrip;
+    using namespace std::chrono_literals;
+    loopback_listener stalled{true};
+    tcp_client tc{};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(io_status::Error, tc.connect({stalled.address()}, 100ms, 50ms));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, 100ms);
+    EXPECT_LT(elapsed, 1s);
+    EXPECT_EQ(-1, tc.get_sockfd());
+}
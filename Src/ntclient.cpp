@@ -2,17 +2,29 @@
 #include <limits>
 #include <iomanip>
 #include <algorithm>
+#include <array>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 #include "cli.hpp"
 #include "ntrip_client.hpp"
+#include "reconnect_policy.hpp"
+#include "forwarder.hpp"
+#include "serial_sink.hpp"
+#include "message_filter.hpp"
+#include "rtcm3_framer.hpp"
+#include "epoch_assembler.hpp"
 
 int print_usage() 
 {
     std::cerr << "Usage: ntclient PARAMETERS..." << std::endl;
-    std::cerr << "'ntclient' writes RTK correction to standard output." << std::endl << std::endl;
+    std::cerr << "'ntclient' writes RTK correction to standard output or to a serial port." << std::endl << std::endl;
     std::cerr << "Examples:" << std::endl;
     std::cerr << "    ntclient -a rtk.ua -p 2101 -m mymount -u myname -pw myword -la 30 -lo -50" << std::endl;
     std::cerr << "    ntclient --address rtk.ua --port 2101 --mount CMR --user myname --password myword --latitude 30.32 --longitude -52.65" << std::endl;
+    std::cerr << "    ntclient -a rtk.ua -p 2101 -m mymount -u myname -pw myword -la 30 -lo -50 -s /dev/ttyUSB0 -b 115200 -fc rtscts" << std::endl;
     std::cerr << "    ntclient -a rtk.ua -p 2101 -g y" << std::endl;
     std::cerr << "    ntclient --address rtk.ua --port 2101 --user myname --password myword --get yes" << std::endl << std::endl;
     std::cerr << "Parameters:" << std::endl;
@@ -24,6 +36,14 @@ int print_usage()
     std::cerr << "    -la, --latitude LATITUDE      user location latitude" << std::endl;
     std::cerr << "    -lo, --longitude LONGITUDE    user location longitude" << std::endl;
     std::cerr << "    -g,  --get (y/n, yes/no)      retrieve mount points" << std::endl;
+    std::cerr << "    -io, --io (aio/epoll/uring)   write engine, epoll by default" << std::endl;
+    std::cerr << "    -to, --timeout MILLISECONDS   connect, request and response deadline, 5000 by default" << std::endl;
+    std::cerr << "    -rc, --retry-ceiling SECONDS  longest delay between reconnects, 60 by default" << std::endl;
+    std::cerr << "    -s,  --serial DEVICE          write whole RTCM3 frames to serial port instead of standard output" << std::endl;
+    std::cerr << "    -b,  --baud RATE              serial port baud rate, 115200 by default" << std::endl;
+    std::cerr << "    -fc, --flow (none/rtscts/xonxoff) serial port flow control, none by default" << std::endl;
+    std::cerr << "    -mf, --messages LIST          RTCM3 messages to output: 1005,1033,1074-1077 or all except: !1019,1020" << std::endl;
+    std::cerr << "    -ew, --epoch-wait MILLISECONDS write every RTCM3 epoch to standard output at once, holding it up to the time" << std::endl;
     return 1;
 }
 
@@ -59,21 +79,111 @@ int showMountPoints(std::string address, int port, std::string username, std::st
     return 0;
 }
 
-void output_correction(VrsTunnel::Ntrip::ntrip_login login)
+/**
+ * File descriptor closed when it goes out of scope
+ */
+class scoped_fd
+{
+public:
+    explicit scoped_fd(int fd) noexcept : m_fd{fd} { }
+    ~scoped_fd()
+    {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+    scoped_fd(const scoped_fd&) = delete;
+    scoped_fd& operator=(const scoped_fd&) = delete;
+    int get() const noexcept
+    {
+        return m_fd;
+    }
+
+private:
+    int m_fd;
+};
+
+/**
+ * @return periodic monotonic timerfd, negative on error
+ */
+int make_timer(std::chrono::seconds period)
+{
+    int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        return fd;
+    }
+    struct itimerspec spec{};
+    spec.it_value.tv_sec = period.count();
+    spec.it_interval.tv_sec = period.count();
+    if (::timerfd_settime(fd, 0, &spec, nullptr) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Arms or disarms one-shot timerfd
+ * @param delay zero disarms the timer
+ */
+bool arm_timer(int fd, std::chrono::milliseconds delay)
+{
+    struct itimerspec spec{};
+    spec.it_value.tv_sec = delay.count() / 1000;
+    spec.it_value.tv_nsec = delay.count() % 1000 * 1000000;
+    return ::timerfd_settime(fd, 0, &spec, nullptr) == 0;
+}
+
+/**
+ * Registers descriptor in epoll instance
+ */
+bool watch(int epollfd, int fd, std::uint32_t events)
+{
+    struct epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    return ::epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+/**
+ * Acknowledges timer expiration
+ * @return number of expirations since the last call
+ */
+std::uint64_t expired(int timerfd)
+{
+    std::uint64_t count = 0;
+    if (::read(timerfd, &count, sizeof(count)) != sizeof(count)) {
+        return 0;
+    }
+    return count;
+}
+
+/**
+ * @param serial port to write correction to, standard output is used if it is nullptr
+ * @param filter RTCM3 messages written to standard output, the serial port has its own
+ * @param epoch_wait the longest time an epoch is held for standard output, zero writes frames as they come
+ */
+VrsTunnel::Ntrip::status output_correction(VrsTunnel::Ntrip::ntrip_login login,
+    VrsTunnel::Ntrip::reconnect_policy& policy, VrsTunnel::Ntrip::serial_sink* serial,
+    const VrsTunnel::Ntrip::message_filter& filter, std::chrono::milliseconds epoch_wait)
 {
     VrsTunnel::Ntrip::ntrip_client nc{};
     auto res = nc.connect(login);
     if (res == VrsTunnel::Ntrip::status::authfailure) {
         std::cerr << "ntclient: authentication failure." << std::endl;
-        return;
+        return res;
     }
     else if (res == VrsTunnel::Ntrip::status::error) {
         std::cerr << "ntclient: connection error." << std::endl;
-        return;
+        return res;
     }
     else if (res == VrsTunnel::Ntrip::status::nomount) {
         std::cerr << "ntclient: mount point not found." << std::endl;
-        return;
+        return res;
+    }
+    policy.connected();
+    if (policy.stats().reconnects > 0) {
+        std::cerr << "ntclient: reconnected after " << policy.stats().last_outage.count() << " ms." << std::endl;
     }
 
     auto sendgga = [&nc, &login]() -> bool { // return error occured
@@ -87,13 +197,6 @@ void output_correction(VrsTunnel::Ntrip::ntrip_login login)
         return false;
     };
     auto gga_timeout = [&sendgga, &nc]() -> bool { // return error occured
-        constexpr int timeout = 100; // 10 seconds (100 times 100ms)
-        static int tick = 0;
-        tick++;
-        if (tick < timeout) { // wait for 10 seconds before proceeding
-            return false;
-        }
-        tick = 0;
         if (nc.get_status() != VrsTunnel::Ntrip::status::ready) {
             std::cerr << "ntclient: NMEA GGA send timeout." << std::endl;
             nc.disconnect();
@@ -110,13 +213,6 @@ void output_correction(VrsTunnel::Ntrip::ntrip_login login)
         }
     };
     auto status_timeout = [&nc](bool& available) -> bool { // return error occured
-        constexpr int timeout = 300; // 30 seconds (300 times 100ms)
-        static int tick = 0;
-        ++tick;
-        if (tick < timeout) { // wait for 30 seconds before proceeding
-            return false;
-        }
-        tick = 0;
         if (!available) { // correction did not arrive in 30 seconds
             std::cerr << "ntclient: no correction available." << std::endl;
             nc.disconnect();
@@ -138,24 +234,198 @@ void output_correction(VrsTunnel::Ntrip::ntrip_login login)
         }
     };
 
-    sendgga();
+    // the loop sleeps in epoll_wait until correction arrives or a deadline expires
+    scoped_fd epollfd{::epoll_create1(EPOLL_CLOEXEC)};
+    scoped_fd gga_timer{make_timer(std::chrono::seconds(10))};
+    scoped_fd status_timer{make_timer(std::chrono::seconds(30))};
+    scoped_fd epoch_timer{::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)};
+    if (epollfd.get() < 0 || gga_timer.get() < 0 || status_timer.get() < 0 || epoch_timer.get() < 0
+            || !watch(epollfd.get(), nc.get_sockfd(), EPOLLIN | EPOLLRDHUP)
+            || !watch(epollfd.get(), gga_timer.get(), EPOLLIN)
+            || !watch(epollfd.get(), status_timer.get(), EPOLLIN)
+            || !watch(epollfd.get(), epoch_timer.get(), EPOLLIN)) {
+        std::cerr << "ntclient: event loop error." << std::endl;
+        nc.disconnect();
+        return VrsTunnel::Ntrip::status::error;
+    }
+
+    if (sendgga()) {
+        return VrsTunnel::Ntrip::status::error;
+    }
     bool data_available = true;
-    for (;;) {
-        if (gga_timeout()) {
-            return;
+    // correction goes from the socket to stdout through a pipe, not through user space
+    VrsTunnel::Ntrip::forwarder output{STDOUT_FILENO};
+    auto closed = [&nc]() -> bool { // return error occured
+        std::cerr << "ntclient: connection closed." << std::endl;
+        nc.disconnect();
+        return true;
+    };
+    std::array<char, VrsTunnel::Ntrip::ntrip_client::receive_chunk> buffer{};
+    bool bundled = serial == nullptr && epoch_wait.count() > 0;
+    bool framed = serial == nullptr && (!filter.accepts_all() || bundled);
+    VrsTunnel::Ntrip::rtcm3_framer framer{};
+    VrsTunnel::Ntrip::epoch_assembler bundle{epoch_wait};
+    // the whole epoch goes out with one write
+    auto write_epoch = [&output, &bundle, &filter, &epoch_timer]() {
+        const auto& frames = bundle.batch();
+        auto res = VrsTunnel::Ntrip::io_status::Success;
+        if (filter.accepts_all()) {
+            std::string_view bytes = frames.bytes();
+            res = bytes.empty() ? res : output.write(bytes.data(), bytes.size());
         }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        int avail = nc.available();
-        if (avail > 0) {
-            auto corr = nc.receive(avail);
-            fwrite(corr.get(), avail, 1, stdout);
-            fflush(stdout);
+        else if (auto selected = frames.select(&filter, nullptr)) {
+            res = output.write(selected->data(), selected->size());
+        }
+        bundle.clear();
+        arm_timer(epoch_timer.get(), std::chrono::milliseconds(0));
+        return res;
+    };
+    auto write_out = [&output, &serial, &framed, &bundled, &framer, &filter, &bundle, &write_epoch, &epoch_timer, &epoch_wait]
+            (const char* data, std::size_t size) {
+        if (serial) {
+            return serial->write(data, size);
+        }
+        if (!framed) {
+            return output.write(data, size);
+        }
+        framer.feed(data, size);
+        auto now = VrsTunnel::Ntrip::epoch_assembler::clock::now();
+        VrsTunnel::Ntrip::rtcm3_frame frame{};
+        VrsTunnel::Ntrip::msm_header msm{};
+        while (framer.next(frame) == VrsTunnel::Ntrip::io_status::Success) {
+            if (!bundled) {
+                if (filter.accepts(frame.message_type())
+                        && output.write(reinterpret_cast<const char*>(frame.data), frame.size) != VrsTunnel::Ntrip::io_status::Success) {
+                    return VrsTunnel::Ntrip::io_status::Error;
+                }
+                continue;
+            }
+            bool is_msm = VrsTunnel::Ntrip::rtcm3::is_msm(frame.message_type())
+                && VrsTunnel::Ntrip::rtcm3::decode_msm(frame, msm);
+            if (is_msm && bundle.other_epoch(msm) && write_epoch() != VrsTunnel::Ntrip::io_status::Success) {
+                return VrsTunnel::Ntrip::io_status::Error;
+            }
+            bool was_open = bundle.is_open();
+            if (bundle.add(frame, is_msm ? &msm : nullptr, now) == VrsTunnel::Ntrip::io_status::Success) {
+                if (write_epoch() != VrsTunnel::Ntrip::io_status::Success) {
+                    return VrsTunnel::Ntrip::io_status::Error;
+                }
+            }
+            else if (!was_open && bundle.is_open()) {
+                arm_timer(epoch_timer.get(), epoch_wait);
+            }
+        }
+        if (bundled && !bundle.is_open()) {
+            return write_epoch();   // frames between epochs
+        }
+        return VrsTunnel::Ntrip::io_status::Success;
+    };
+    // serial port and message filter need whole frames, so correction passes through the buffer
+    auto drain = [&nc, &write_out, &buffer, &data_available, &output]() -> VrsTunnel::Ntrip::io_status {
+        std::size_t received = 0;
+        auto rd_res = VrsTunnel::Ntrip::io_status::Success;
+        // blocked standard output is not fed more, the serial sink drops frames itself
+        while (!output.blocked()
+                && (rd_res = nc.receive(buffer.data(), buffer.size(), received)) == VrsTunnel::Ntrip::io_status::Success) {
             data_available = true;
+            if (write_out(buffer.data(), received) != VrsTunnel::Ntrip::io_status::Success) {
+                std::cerr << "ntclient: output error." << std::endl;
+                return VrsTunnel::Ntrip::io_status::Error;
+            }
         }
-
-        if (status_timeout(data_available)) {
-            return;
+        return rd_res;
+    };
+    auto forward = [&nc, &output, &serial, &framed, &data_available, &closed, &drain]() -> bool { // return error occured
+        if (serial || framed) {
+            return drain() == VrsTunnel::Ntrip::io_status::Error && closed();
+        }
+        std::size_t moved = 0;
+        auto res = output.forward(nc.get_sockfd(), moved);
+        if (moved > 0) {
+            data_available = true;
+        }
+        return res == VrsTunnel::Ntrip::io_status::Error && closed();
+    };
+    // a blocked output is watched until it is writable, blocked standard output stops socket reads
+    int out_fd = serial ? serial->get_fd() : STDOUT_FILENO;
+    bool out_watched = false;
+    auto follow_output = [&nc, &serial, &output, &epollfd, &out_fd, &out_watched]() -> bool { // return error occured
+        bool blocked = serial ? serial->blocked() : output.blocked();
+        if (blocked == out_watched) {
+            return false;
+        }
+        out_watched = blocked;
+        bool ok = blocked ? watch(epollfd.get(), out_fd, EPOLLOUT)
+            : ::epoll_ctl(epollfd.get(), EPOLL_CTL_DEL, out_fd, nullptr) == 0;
+        if (ok && !serial) {
+            ok = blocked ? ::epoll_ctl(epollfd.get(), EPOLL_CTL_DEL, nc.get_sockfd(), nullptr) == 0
+                : watch(epollfd.get(), nc.get_sockfd(), EPOLLIN | EPOLLRDHUP);
+        }
+        if (!ok) {
+            std::cerr << "ntclient: event loop error." << std::endl;
+            nc.disconnect();
+            return true;
+        }
+        return false;
+    };
+    auto output_ready = [&nc, &serial, &output, &follow_output]() -> bool { // return error occured
+        auto res = serial ? serial->flush() : output.flush();
+        if (res == VrsTunnel::Ntrip::io_status::Error) {
+            std::cerr << "ntclient: output error." << std::endl;
+            nc.disconnect();
+            return true;
+        }
+        return follow_output();
+    };
+    if (serial) {
+        serial->reset(); // a frame cut by the previous connection is never completed
+    }
+    // correction may have arrived together with the response header
+    if ((drain() == VrsTunnel::Ntrip::io_status::Error && closed()) || follow_output()) {
+        return VrsTunnel::Ntrip::status::error;
+    }
+    std::array<struct epoll_event, 5> events{};
+    for (;;) {
+        int n_events = ::epoll_wait(epollfd.get(), events.data(), events.size(), -1);
+        if (n_events < 0 && errno != EINTR) {
+            std::cerr << "ntclient: event loop error." << std::endl;
+            nc.disconnect();
+            return VrsTunnel::Ntrip::status::error;
+        }
+        for (int i = 0; i < n_events; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == gga_timer.get()) {
+                if (expired(fd) > 0 && gga_timeout()) {
+                    return VrsTunnel::Ntrip::status::error;
+                }
+            }
+            else if (fd == status_timer.get()) {
+                if (expired(fd) > 0 && status_timeout(data_available)) {
+                    return VrsTunnel::Ntrip::status::error;
+                }
+            }
+            else if (fd == epoch_timer.get()) {
+                // the last message of the epoch is late or lost
+                if (expired(fd) > 0 && bundle.is_open() && write_epoch() != VrsTunnel::Ntrip::io_status::Success) {
+                    std::cerr << "ntclient: output error." << std::endl;
+                    nc.disconnect();
+                    return VrsTunnel::Ntrip::status::error;
+                }
+                if (follow_output()) {
+                    return VrsTunnel::Ntrip::status::error;
+                }
+            }
+            else if (fd == out_fd) {
+                if (output_ready()) {
+                    return VrsTunnel::Ntrip::status::error;
+                }
+            }
+            else if (out_watched && !serial) {
+                continue;   // socket event reported before it was removed
+            }
+            else if (forward() || follow_output()) {
+                return VrsTunnel::Ntrip::status::error;
+            }
         }
     }
 }
@@ -170,6 +440,12 @@ int main(int argc, const char* argv[])
     double latitude{noGeo}, longitude{noGeo};
     std::string username{}, password{}, mount{}, address{}, yesno{};
     int port{0};
+    int timeout{0};
+    int retry_ceiling{0};
+    std::string serial_path{};
+    VrsTunnel::Ntrip::serial_settings serial_settings{};
+    VrsTunnel::Ntrip::message_filter filter{};
+    int epoch_wait{0};
 
     try
     {
@@ -182,6 +458,33 @@ int main(int argc, const char* argv[])
         cli.retrieve({"g", "-get"}, yesno);
         cli.retrieve({"la", "-latitude"}, latitude);
         cli.retrieve({"lo", "-longitude"}, longitude);
+        cli.retrieve({"to", "-timeout"}, timeout);
+        cli.retrieve({"rc", "-retry-ceiling"}, retry_ceiling);
+        cli.retrieve({"s", "-serial"}, serial_path);
+        cli.retrieve({"b", "-baud"}, serial_settings.baud);
+        std::string flow_name{};
+        if (cli.retrieve({"fc", "-flow"}, flow_name)
+                && !VrsTunnel::Ntrip::serial_sink::parse(flow_name, serial_settings.flow)) {
+            return print_usage();
+        }
+        std::string messages{};
+        if (cli.retrieve({"mf", "-messages"}, messages)
+                && !VrsTunnel::Ntrip::message_filter::parse(messages, filter)) {
+            return print_usage();
+        }
+        serial_settings.filter = filter;
+        cli.retrieve({"ew", "-epoch-wait"}, epoch_wait);
+        if (epoch_wait < 0) {
+            return print_usage();
+        }
+        std::string engine_name{};
+        if (cli.retrieve({"io", "-io"}, engine_name)) {
+            VrsTunnel::Ntrip::io_engine engine{};
+            if (!VrsTunnel::Ntrip::io_backend::parse(engine_name, engine)) {
+                return print_usage();
+            }
+            VrsTunnel::Ntrip::io_backend::set_default(engine);
+        }
     }
     catch (const std::bad_variant_access& err)
     {
@@ -211,11 +514,28 @@ int main(int argc, const char* argv[])
     login.password = password;
     login.position.Latitude = latitude;
     login.position.Longitude = longitude;
+    if (timeout > 0) {
+        login.timeouts.connect = login.timeouts.send = login.timeouts.response = std::chrono::milliseconds(timeout);
+    }
+    VrsTunnel::Ntrip::backoff_settings backoff{};
+    if (retry_ceiling > 0) {
+        backoff.ceiling = std::chrono::seconds(retry_ceiling);
+    }
+    VrsTunnel::Ntrip::reconnect_policy policy{backoff};
+    VrsTunnel::Ntrip::serial_sink serial{};
+    if (serial_path.size() > 0 && serial.open(serial_path, serial_settings) != VrsTunnel::Ntrip::io_status::Success) {
+        std::cerr << "ntclient: could not open serial port " << serial_path << "." << std::endl;
+        return 1;
+    }
     for (;;) {
-        output_correction(login);
-        constexpr int retry_period = 30;
-        std::cerr << "ntclient: retrying in " << retry_period << " seconds..." << std::endl;
-        sleep(retry_period);
+        auto delay = policy.next_delay(output_correction(login, policy,
+            serial.get_fd() >= 0 ? &serial : nullptr, filter, std::chrono::milliseconds(epoch_wait)));
+        if (serial.get_fd() >= 0 && serial.stats().dropped_frames > 0) {
+            std::cerr << "ntclient: " << serial.stats().dropped_frames
+                << " frames dropped, serial link is too slow." << std::endl;
+        }
+        std::cerr << "ntclient: retrying in " << delay.count() << " ms..." << std::endl;
+        std::this_thread::sleep_for(delay);
     }
     return 0;
 }
\ No newline at end of file
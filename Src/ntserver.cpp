@@ -1,10 +1,55 @@
 #include <iostream>
 #include <vector>
+#include <array>
+#include <cerrno>
 
 #include "cli.hpp"
 #include "ntrip_server.hpp"
+#include "reconnect_policy.hpp"
+#include "rtcm3_framer.hpp"
+#include "stream_profile.hpp"
 
-void send_correction(VrsTunnel::Ntrip::ntrip_login& login);
+/**
+ * Description of the correction collected while it is sent
+ */
+struct station_stream
+{
+    VrsTunnel::Ntrip::rtcm3_framer framer{};
+    VrsTunnel::Ntrip::stream_profile profile{};
+
+    void add(const char* data, std::size_t size)
+    {
+        framer.feed(data, size);
+        VrsTunnel::Ntrip::rtcm3_frame frame{};
+        while (framer.next(frame) == VrsTunnel::Ntrip::io_status::Success) {
+            profile.add(frame);
+        }
+    }
+};
+
+VrsTunnel::Ntrip::status send_correction(VrsTunnel::Ntrip::ntrip_login& login,
+    VrsTunnel::Ntrip::reconnect_policy& policy, station_stream& stream);
+
+/**
+ * Reads the correction until its reference point arrives, the bytes are not sent
+ * @return false on end of input
+ */
+bool wait_position(station_stream& stream)
+{
+    std::cerr << "ntserver: waiting for reference point (RTCM 1005/1006)..." << std::endl;
+    std::array<char, 4096> buffer{};
+    while (!stream.profile.has_position()) {
+        ssize_t n = ::read(STDIN_FILENO, buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        stream.add(buffer.data(), n);
+    }
+    return true;
+}
 
 int print_usage() 
 {
@@ -13,14 +58,18 @@ int print_usage()
     std::cerr << "Examples:" << std::endl;
     std::cerr << "    ntserver -a rtk.ua -p 2101 -m mymount -u myname -pw myword -la 30 -lo -50" << std::endl;
     std::cerr << "    ntserver --address rtk.ua --port 2101 --mount CMR --user myname --password myword --latitude 30.32 --longitude -52.65" << std::endl;
+    std::cerr << "    ntserver -a rtk.ua -p 2101 -m mymount -u myname -pw myword < /dev/ttyUSB0" << std::endl;
     std::cerr << "Parameters:" << std::endl;
     std::cerr << "    -a,  --address SERVER         NTRIP Caster address" << std::endl;
     std::cerr << "    -p,  --port PORT              NTRIP Caster port" << std::endl;
     std::cerr << "    -m,  --mount MOUNTPOINT       NTRIP mount point" << std::endl;
     std::cerr << "    -u,  --user USERNAME          NTRIP user name" << std::endl;
     std::cerr << "    -pw, --password PASSWORD      NTRIP password" << std::endl;
-    std::cerr << "    -la, --latitude LATITUDE      GNSS base station reference latitude" << std::endl;
-    std::cerr << "    -lo, --longitude LONGITUDE    GNSS base station reference longitude" << std::endl;
+    std::cerr << "    -la, --latitude LATITUDE      GNSS base station reference latitude, RTCM 1005/1006 by default" << std::endl;
+    std::cerr << "    -lo, --longitude LONGITUDE    GNSS base station reference longitude, RTCM 1005/1006 by default" << std::endl;
+    std::cerr << "    -io, --io (aio/epoll/uring)   write engine, epoll by default" << std::endl;
+    std::cerr << "    -to, --timeout MILLISECONDS   connect, request and response deadline, 5000 by default" << std::endl;
+    std::cerr << "    -rc, --retry-ceiling SECONDS  longest delay between reconnects, 60 by default" << std::endl;
     return 1;
 }
 
@@ -33,6 +82,8 @@ int main(int argc, const char* argv[])
     double latitude{noGeo}, longitude{noGeo};
     std::string username{}, password{}, mount{}, address{};
     int port{0};
+    int timeout{0};
+    int retry_ceiling{0};
     try
     {
         VrsTunnel::cli cli(argc, argv);
@@ -43,6 +94,16 @@ int main(int argc, const char* argv[])
         cli.retrieve({"pw", "-password"}, password);
         cli.retrieve({"la", "-latitude"}, latitude);
         cli.retrieve({"lo", "-longitude"}, longitude);
+        cli.retrieve({"to", "-timeout"}, timeout);
+        cli.retrieve({"rc", "-retry-ceiling"}, retry_ceiling);
+        std::string engine_name{};
+        if (cli.retrieve({"io", "-io"}, engine_name)) {
+            VrsTunnel::Ntrip::io_engine engine{};
+            if (!VrsTunnel::Ntrip::io_backend::parse(engine_name, engine)) {
+                return print_usage();
+            }
+            VrsTunnel::Ntrip::io_backend::set_default(engine);
+        }
     }
     catch (std::bad_variant_access& err)
     {
@@ -54,11 +115,17 @@ int main(int argc, const char* argv[])
         return print_usage();
     }
 
-    if (latitude == noGeo || longitude == noGeo || port == 0
+    if ((latitude == noGeo) != (longitude == noGeo) || port == 0
             || address.size() == 0 || mount.size() == 0
             || username.size() == 0 || password.size() == 0) {
         return print_usage();
     }
+    // the reference point comes from the correction if it is not given
+    station_stream stream{};
+    if (latitude == noGeo && !wait_position(stream)) {
+        std::cerr << "ntserver: correction ended without reference point." << std::endl;
+        return 1;
+    }
 
     VrsTunnel::Ntrip::ntrip_login login{};
     login.address = address;
@@ -66,33 +133,54 @@ int main(int argc, const char* argv[])
     login.mountpoint = mount;
     login.username = username;
     login.password = password;
-    login.position.Latitude = latitude;
-    login.position.Longitude = longitude;
+    if (latitude != noGeo) {
+        login.position.Latitude = latitude;
+        login.position.Longitude = longitude;
+    }
+    if (timeout > 0) {
+        login.timeouts.connect = login.timeouts.send = login.timeouts.response = std::chrono::milliseconds(timeout);
+    }
+    VrsTunnel::Ntrip::backoff_settings backoff{};
+    if (retry_ceiling > 0) {
+        backoff.ceiling = std::chrono::seconds(retry_ceiling);
+    }
+    VrsTunnel::Ntrip::reconnect_policy policy{backoff};
     for (;;) {
-        send_correction(login);
-        constexpr int retry_period = 30;
-        std::cerr << "ntserver: retrying in " << retry_period << " seconds..." << std::endl;
-        sleep(retry_period);
+        auto delay = policy.next_delay(send_correction(login, policy, stream));
+        std::cerr << "ntserver: retrying in " << delay.count() << " ms..." << std::endl;
+        std::this_thread::sleep_for(delay);
     }
 
     return 0;
 }
 
-void send_correction(VrsTunnel::Ntrip::ntrip_login& login)
+VrsTunnel::Ntrip::status send_correction(VrsTunnel::Ntrip::ntrip_login& login,
+    VrsTunnel::Ntrip::reconnect_policy& policy, station_stream& stream)
 {
+    // STR line of a stream not seen yet has the operator supplied position only
+    login.str = stream.profile.str(login.mountpoint, login.position);
+    if (stream.profile.has_position()) {
+        auto pos = stream.profile.position();
+        std::cerr << "ntserver: reference point " << pos.Latitude << " " << pos.Longitude
+            << " from station " << stream.profile.station().station_id << "." << std::endl;
+    }
     VrsTunnel::Ntrip::ntrip_server ns{};
     auto res = ns.connect(login);
     if (res == VrsTunnel::Ntrip::status::authfailure) {
         std::cerr << "ntserver: authentication failure." << std::endl;
-        return;
+        return res;
     }
     else if (res == VrsTunnel::Ntrip::status::error) {
         std::cerr << "ntserver: connection error." << std::endl;
-        return;
+        return res;
     }
     else if (res == VrsTunnel::Ntrip::status::nomount) {
         std::cerr << "ntserver: mount point not found." << std::endl;
-        return;
+        return res;
+    }
+    policy.connected();
+    if (policy.stats().reconnects > 0) {
+        std::cerr << "ntserver: reconnected after " << policy.stats().last_outage.count() << " ms." << std::endl;
     }
 
     for (;;) {
@@ -103,17 +191,18 @@ void send_correction(VrsTunnel::Ntrip::ntrip_login& login)
         if (ir != 0) {
             std::cerr << "ntserver: read correction error." << std::endl;
             ns.disconnect();
-            return;
+            return VrsTunnel::Ntrip::status::error;
         }
         if (n_bytes_avail > 0) {
             data = std::make_unique<char[]>(n_bytes_avail);
             n_read = ::read(STDIN_FILENO, data.get(), n_bytes_avail);
             if (n_read > 0) {
+                stream.add(data.get(), n_read);
                 auto send_stat = ns.send_begin(data.get(), n_read);
                 if (send_stat != VrsTunnel::Ntrip::status::ready) {
                     std::cerr << "ntserver: send correction error." << std::endl;
                     ns.disconnect();
-                    return;
+                    return VrsTunnel::Ntrip::status::error;
                 }
             }
         }
@@ -128,13 +217,13 @@ void send_correction(VrsTunnel::Ntrip::ntrip_login& login)
         if (ns.get_status() != VrsTunnel::Ntrip::status::ready) {
             std::cerr << "ntserver: send correction timeout." << std::endl;
             ns.disconnect();
-            return;
+            return VrsTunnel::Ntrip::status::error;
         }
         if (n_read > 0) {
             if (n_read != ns.send_end()) { // not all the data have been transmitted
                 std::cerr << "ntserver: deliver correction error." << std::endl;
                 ns.disconnect();
-                return;
+                return VrsTunnel::Ntrip::status::error;
             }
         }
     }
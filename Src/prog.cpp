@@ -1,6 +1,9 @@
 #include <iostream>
 #include <chrono>
+#include <csignal>
+#include <sys/resource.h>
 
+#include "cli.hpp"
 #include "login_encode.hpp"
 #include "base64_encoder.hpp"
 #include "location.hpp"
@@ -11,12 +14,119 @@
 #include "ntrip_server.hpp"
 #include "tcp_server.hpp"
 #include "accept_listener.hpp"
+#include "message_filter.hpp"
+#include "mount_registry.hpp"
 
+/**
+ * Parses mount point filters: MOUNT=SPEC[;MOUNT=SPEC...], SPEC as of message_filter::parse
+ * @return false if the list is malformed
+ */
+bool parse_mount_filters(std::string_view list,
+    std::vector<std::pair<std::string, std::shared_ptr<const VrsTunnel::Ntrip::message_filter>>>& filters)
+{
+    while (!list.empty()) {
+        std::string_view item = list.substr(0, list.find(';'));
+        list.remove_prefix(std::min(list.size(), item.size() + 1));
+        auto eq = item.find('=');
+        VrsTunnel::Ntrip::message_filter filter{};
+        if (eq == 0 || eq == std::string_view::npos
+                || !VrsTunnel::Ntrip::message_filter::parse(item.substr(eq + 1), filter)) {
+            return false;
+        }
+        filters.emplace_back(std::string{item.substr(0, eq)},
+            std::make_shared<const VrsTunnel::Ntrip::message_filter>(filter));
+    }
+    return true;
+}
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+/**
+ * Prints epoch metrics of the base stations of every shard
+ */
+void print_metrics(const std::vector<std::unique_ptr<VrsTunnel::Ntrip::accept_listener>>& listeners)
+{
+    for (const auto& listener : listeners) {
+        for (const auto& [mount, m] : listener->station_metrics()) {
+            std::cerr << "prog: " << mount << " epochs " << m.epochs << " satellites " << m.satellites
+                << " signals " << m.signals << " interval " << m.interval_ms << " ms jitter "
+                << m.jitter_us << " us gaps " << m.gaps << std::endl;
+        }
+    }
+}
+
+
+int main(int argc, const char* argv[]) {
+    int port{8023};
+    int threads{1};
+    int metrics_period{0};
+    int epoch_wait{0};
+    std::vector<std::pair<std::string, std::shared_ptr<const VrsTunnel::Ntrip::message_filter>>> filters{};
+    try
+    {
+        VrsTunnel::cli cli(argc, argv);
+        cli.retrieve({"p", "-port"}, port);
+        cli.retrieve({"t", "-threads"}, threads);
+        if (threads < 1 || threads > static_cast<int>(VrsTunnel::Ntrip::mount_registry::max_shards)) {
+            throw std::runtime_error("wrong number of threads");
+        }
+        cli.retrieve({"ms", "-metrics"}, metrics_period);
+        if (metrics_period < 0) {
+            throw std::runtime_error("wrong metrics period");
+        }
+        cli.retrieve({"ew", "-epoch-wait"}, epoch_wait);
+        if (epoch_wait < 0) {
+            throw std::runtime_error("wrong epoch wait");
+        }
+        std::string filter_list{};
+        if (cli.retrieve({"mf", "-mount-filter"}, filter_list) && !parse_mount_filters(filter_list, filters)) {
+            throw std::runtime_error("wrong mount point filter");
+        }
+    }
+    catch (const std::exception& err)
+    {
+        std::cerr << "prog: " << err.what() << std::endl;
+        std::cerr << "Usage: prog [-p PORT] [-t THREADS] [-mf MOUNT=1005,1074-1077;MOUNT2=!1019] [-ms SECONDS] [-ew MILLISECONDS]" << std::endl;
+        return 1;
+    }
+
+    // every rover connection needs a descriptor
+    struct rlimit lim{};
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    sigset_t stop_signals{};
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr); // inherited by reactor threads
+
+    // shards share the mount points, a rover may be accepted by another shard than its base station
+    auto mounts = std::make_shared<VrsTunnel::Ntrip::mount_registry>(threads);
+    std::vector<std::unique_ptr<VrsTunnel::Ntrip::accept_listener>> listeners{};
+    for (int shard = 0; shard < threads; ++shard) {
+        auto& listener = listeners.emplace_back(std::make_unique<VrsTunnel::Ntrip::accept_listener>(mounts, shard));
+        listener->set_epoch_wait(std::chrono::milliseconds(epoch_wait));
+        for (const auto& [mount, filter] : filters) {
+            listener->set_filter(mount, filter);
+        }
+    }
     VrsTunnel::Ntrip::tcp_server ts{};
-    VrsTunnel::Ntrip::accept_listener al;
-    [[maybe_unused]] bool r = ts.start(8023, al);
-    sleep(1);
+    bool started = threads == 1 ? ts.start(port, *listeners.front()) : ts.start(port, listeners);
+    if (!started) {
+        std::cerr << "prog: TCP port is not available." << std::endl;
+        return 1;
+    }
+    if (metrics_period > 0) {
+        // station quality every period until a stop signal
+        timespec period{metrics_period, 0};
+        while (sigtimedwait(&stop_signals, nullptr, &period) < 0) {
+            print_metrics(listeners);
+        }
+    }
+    else {
+        int sig = 0;
+        sigwait(&stop_signals, &sig);
+    }
     ts.stop();
-}
\ No newline at end of file
+}